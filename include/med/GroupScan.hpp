@@ -0,0 +1,51 @@
+#ifndef GROUP_SCAN_HPP
+#define GROUP_SCAN_HPP
+
+#include <string>
+#include <vector>
+
+#include "med/MedTypes.hpp"
+
+using namespace std;
+
+const size_t GROUP_DEFAULT_SPAN = 64;
+
+struct GroupMember {
+  string scanType;
+  vector<Byte> value;
+};
+
+// Anchor address (the first member), and the offset of every member from the anchor
+struct GroupMatch {
+  Address anchor;
+  vector<long> offsets;
+};
+
+/**
+ * Group scan finds the values which are near to each other, such as HP, MP and level of a struct.
+ * "100, int16:50, float32:1.5, span:64" finds int32 100 (the anchor), with int16 50 and float32 1.5
+ * within 64 bytes before or after it. Members without type are int32.
+ * The values are matched at the addresses aligned to their size.
+ */
+class GroupScan {
+public:
+  explicit GroupScan(const string& s);
+
+  vector<GroupMember>& getMembers();
+  size_t getSpan();
+  const string& getAnchorType();
+
+  /**
+   * Scan the buffer, which is the memory from "bufferStart", in one pass.
+   * The anchors within [from, to) with all the members in the window are appended to "matches".
+   */
+  void scan(const Byte* buf, size_t length, Address bufferStart,
+            Address from, Address to, vector<GroupMatch>& matches);
+
+private:
+  vector<GroupMember> members;
+  size_t span;
+  size_t step; // Smallest alignment of the members
+};
+
+#endif
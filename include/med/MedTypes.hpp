@@ -35,6 +35,7 @@ const string SCAN_TYPE_FLOAT_32 = "float32";
 const string SCAN_TYPE_FLOAT_64 = "float64";
 const string SCAN_TYPE_STRING = "string";
 const string SCAN_TYPE_CUSTOM = "custom";
+const string SCAN_TYPE_GROUP = "group"; // Group scan only, not a value type
 const string SCAN_TYPE_PTR_32 = "ptr32";
 const string SCAN_TYPE_PTR_64 = "ptr64";
 const string SCAN_TYPE_UNKNOWN = "unknown";
@@ -58,7 +59,13 @@ namespace ScanParser {
     Ge,
     Le,
     Within,
-    SnapshotSave
+    SnapshotSave,
+    Approx,
+    Truncated,
+    IncreasedBy,
+    DecreasedBy,
+    ChangedByPercent,
+    In
   };
 };
 
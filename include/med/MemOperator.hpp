@@ -46,6 +46,34 @@ bool memCompare(const void* ptr, size_t size, Operands& operands, const ScanPars
  */
 bool memWithin(const void* src, const void* low, const void* up, size_t size);
 
+/**
+ * Compare the float32 (size 4) or float64 (size 8) value whether it is within the interval [low, up]
+ */
+bool memApprox(const void* src, size_t size, double low, double up);
+
+/**
+ * Approximate float scan over the buffer, checking the values every "step" bytes.
+ * The offsets of the matched values are appended to "offsets".
+ */
+void memApproxScan(const Byte* buf, size_t length, size_t size, size_t step,
+                   double low, double up, vector<size_t>& offsets);
+
+/**
+ * Compare the values at the offsets of the buffer against the operand, without branching,
+ * so that the compiler can vectorize it. Only Eq and Neq of size 1, 2, 4 and 8, and In are supported.
+ * Return false if not supported, then "matched" is not touched.
+ */
+bool memGatherCompare(const Byte* buf, const vector<size_t>& offsets, size_t size,
+                      Operands& operands, const ScanParser::OpType& op, vector<uint8_t>& matched);
+
+/**
+ * Compare the change from the old value to the new value with typed arithmetic,
+ * for the operators IncreasedBy, DecreasedBy and ChangedByPercent.
+ * The operands are the interval of the change.
+ */
+bool memCompareDelta(const void* newPtr, const void* oldPtr, const ScanType& type,
+                     Operands& operands, const ScanParser::OpType& op);
+
 string memToString(Byte* memory, string scanType);
 
 Address addressRoundDown(Address addr);
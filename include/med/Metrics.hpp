@@ -0,0 +1,83 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <json/json.h>
+
+using namespace std;
+
+enum class Counter {
+  BytesRead,
+  Syscalls,
+  PtraceAttaches,
+  PagesFailed,
+  PagesSkipped,
+  Hits,
+  Comparisons,
+  Allocations,
+  Size // Number of counters
+};
+
+struct PhaseTime {
+  long long totalUs = 0;
+  size_t count = 0;
+};
+
+struct TraceEvent {
+  string name;
+  long long startUs;
+  long long durationUs;
+  size_t threadId;
+};
+
+// Process-wide counters and phase timers of the scan engine.
+// Counters are atomic, so the tasks should accumulate locally and add once per page or chunk.
+class Metrics {
+public:
+  static Metrics& getInstance();
+
+  void add(Counter counter, size_t value = 1);
+  size_t get(Counter counter);
+  static string getCounterName(Counter counter);
+
+  void addPhase(const string& phase, long long startUs, long long durationUs);
+  map<string, PhaseTime> getPhases();
+
+  // Trace events are only kept when tracing
+  void setTracing(bool tracing);
+  bool isTracing();
+  Json::Value getTrace();
+  void saveTrace(const string& filename);
+
+  long long getNowUs();
+  void reset();
+  string getSummary();
+
+private:
+  Metrics();
+  std::atomic<size_t> counters[(int)Counter::Size];
+  std::atomic<bool> tracing;
+  std::mutex mutex;
+  map<string, PhaseTime> phases;
+  vector<TraceEvent> events;
+  std::chrono::steady_clock::time_point epoch;
+};
+
+// Time the scope as a phase, e.g. MetricsTimer timer("scan");
+class MetricsTimer {
+public:
+  explicit MetricsTimer(const char* phase);
+  ~MetricsTimer();
+
+private:
+  const char* phase;
+  long long startUs;
+};
+
+#endif
@@ -1,9 +1,11 @@
 #ifndef OPERANDS_HPP
 #define OPERANDS_HPP
 
+#include <memory>
 #include <string>
 #include "med/MedTypes.hpp"
 #include "med/SizedBytes.hpp"
+#include "med/ValueSet.hpp"
 
 class Operands {
 public:
@@ -15,8 +17,22 @@ public:
   SizedBytes getSecondOperand();
 
   size_t getFirstSize();
+
+  /**
+   * Interval [low, high] stored as two doubles, used by the approximate float scan.
+   */
+  static Operands fromInterval(double low, double high);
+  double getLowerBound();
+  double getUpperBound();
+
+  /**
+   * Set of the values with the size, used by the "in" scan. The values are also kept as operands.
+   */
+  static Operands fromSet(std::vector<SizedBytes> values, size_t size);
+  ValueSet* getValueSet();
 private:
   std::vector<SizedBytes> data;
+  std::shared_ptr<ValueSet> valueSet;
 };
 
 #endif
@@ -16,7 +16,7 @@
 using namespace std;
 
 namespace ScanParser {
-  constexpr const char* OP_REGEX = "^(=|>(?=[^=])|<(?=[^=>])|>=|<=|!|<>|\\?|<|>)";
+  constexpr const char* OP_REGEX = "^(=|>(?=[^=])|<(?=[^=>])|>=|<=|!|<>|\\?|~~|~|\\+=|-=|%=|in(?=\\s*\\{)|<|>)";
   string getOp(const string &v);
   OpType stringToOpType(const string &s);
   OpType getOpType(const string &v);
@@ -27,6 +27,8 @@ namespace ScanParser {
 
   bool isValid(const string &v);
   bool isSnapshotOperator(const OpType& opType);
+  bool isApproxOperator(const OpType& opType);
+  bool isDeltaOperator(const OpType& opType);
 
   SizedBytes valueToBytes(const string& v, const string& t);
 
@@ -40,6 +42,23 @@ namespace ScanParser {
   Operands valueToOperands(const string& v, const string& t, OpType op = OpType::Eq);
   Operands getTwoOperands(const string& v, const string& t);
 
+  // Approximate float scan, "~ 100.5" matches the value rounded to the decimal
+  // places typed, "~~ 100.5" matches the truncated value,
+  // "~ 100.5 0.01" matches with absolute epsilon, "~ 100.5 1%" with relative epsilon.
+  Operands getApproxOperands(const string& v, const string& t, OpType op);
+  int getDecimalPlaces(const string& v);
+
+  // Change against the remembered value, "+= 25" increased by 25, "-= 10 20" decreased
+  // by between 10 and 20, "%= 10 20" changed (either direction) by between 10% and 20%.
+  Operands getDeltaOperands(const string& v);
+
+  // Any of the values, "in {1, 2, 3}", tested against the whole set in one pass
+  Operands getSetOperands(const string& v, const string& t);
+
+  // Size of the memory to compare. Interval operands are stored as double,
+  // so the size is based on the scan type instead of the operand.
+  size_t getValueSize(Operands& operands, const string& t, OpType op);
+
   ScanCommand getScanCommand(const string& v);
 };
 
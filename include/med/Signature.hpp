@@ -0,0 +1,37 @@
+#ifndef SIGNATURE_HPP
+#define SIGNATURE_HPP
+
+#include <string>
+#include <vector>
+
+#include "med/MedTypes.hpp"
+
+using namespace std;
+
+const size_t SIGNATURE_ALIGN = 8;      // Custom scan matches the addresses aligned to 8 only
+const size_t SIGNATURE_MIN_FIXED = 8;  // Fixed bytes before the first uniqueness test
+const size_t SIGNATURE_MAX_SIZE = 256;
+
+/**
+ * Byte pattern around an address, which is unique in the process, so that the address can be found again
+ * after the game is updated or restarted. The pattern is in the custom scan syntax, such as "b:488b05, w:4, b:4885c0",
+ * and the address is at "offset" bytes from the start of the match.
+ */
+class Signature {
+public:
+  Signature();
+  Signature(const string& pattern, long offset);
+
+  // Pattern of the bytes, where the bytes with "wildcards" set can be anything
+  static Signature fromBytes(const Byte* bytes, const vector<bool>& wildcards, long offset);
+
+  const string& getPattern();
+  long getOffset();
+  bool isEmpty();
+
+private:
+  string pattern;
+  long offset;
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef STRIDE_DETECTOR_HPP
+#define STRIDE_DETECTOR_HPP
+
+#include <string>
+#include <vector>
+
+#include "med/MedTypes.hpp"
+
+using namespace std;
+
+const size_t STRIDE_DEFAULT_MAX = 1024;
+const size_t STRIDE_MAX_INSTANCES = 1024; // In each direction from the anchor
+const size_t STRIDE_WINDOW_RECORDS = 4;   // Records on each side used to find the stride
+
+// Stride of the array and the addresses of the same field in every element, sorted, including the anchor.
+// Stride is 0 if no repeating layout is found.
+struct StrideMatch {
+  size_t stride;
+  vector<Address> addresses;
+};
+
+/**
+ * Finds the array of structs around a known value, such as the HP of one entity, and the same field of the other entities.
+ * The stride is the shift with the highest byte autocorrelation around the anchor, in multiples of the type size.
+ * From the anchor, the elements are followed in both directions while the value is plausible
+ * and the rest of the element looks like the anchor element.
+ */
+class StrideDetector {
+public:
+  explicit StrideDetector(const string& scanType, size_t maxStride = STRIDE_DEFAULT_MAX);
+
+  const string& getScanType();
+  size_t getMaxStride();
+  // Bytes to read on each side of the anchor
+  size_t getExtent();
+
+  // Find the stride around the anchor at "anchorOffset" of the buffer, 0 if none.
+  size_t findStride(const Byte* buf, size_t length, size_t anchorOffset);
+
+  // Buffer is the memory from "bufferStart", which contains the anchor
+  StrideMatch detect(const Byte* buf, size_t length, Address bufferStart, Address anchor);
+
+private:
+  bool isPlausible(const Byte* value, const Byte* anchorValue);
+  bool isSimilar(const Byte* buf, size_t length, size_t anchorOffset, size_t offset, size_t stride);
+
+  string scanType;
+  size_t size;
+  size_t maxStride;
+};
+
+#endif
@@ -13,9 +13,10 @@ public:
   enum Command {
     Noop,
     Str,
-    Wildcard
+    Wildcard,
+    Bytes
   };
-  static constexpr const char* CMD_REGEX = "^(s|w):";
+  static constexpr const char* CMD_REGEX = "^(s|w|b):";
   static constexpr const char* CMD_STRING = "'(.+?)'";
 
   explicit SubCommand(const string &s);
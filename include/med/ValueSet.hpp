@@ -0,0 +1,36 @@
+#ifndef VALUE_SET_HPP
+#define VALUE_SET_HPP
+
+#include <vector>
+
+#include "med/MedTypes.hpp"
+#include "med/SizedBytes.hpp"
+
+/**
+ * Set of values of the same size (1, 2, 4 or 8 bytes), for the "in {a, b, c}" scan.
+ * A loaded value is tested against the whole set at once:
+ * a bitset for 1 and 2 bytes values, a linear compare for small sets, which the
+ * compiler vectorizes as broadcast compare, and an open addressing hash table for large sets.
+ */
+class ValueSet {
+public:
+  ValueSet(const vector<SizedBytes>& values, size_t size);
+
+  bool contains(const void* ptr) const;
+  size_t getSize() const;
+  size_t count() const;
+
+private:
+  bool containsValue(uint64_t value) const;
+  void insert(uint64_t value);
+  size_t hash(uint64_t value) const;
+
+  size_t size;
+  vector<uint64_t> values; // Distinct values
+  vector<uint64_t> bits;   // Bitset of all the values, for 1 and 2 bytes
+  vector<uint64_t> table;  // Hash table for large sets
+  vector<uint8_t> used;
+  int shift;
+};
+
+#endif
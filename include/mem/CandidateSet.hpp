@@ -0,0 +1,155 @@
+#ifndef CANDIDATE_SET_HPP
+#define CANDIDATE_SET_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "med/MedTypes.hpp"
+#include "med/Metrics.hpp"
+#include "mem/Mem.hpp"
+#include "mem/MemIO.hpp"
+#include "mem/ScanProgress.hpp"
+
+using namespace std;
+
+const size_t CANDIDATE_LIST_MAX = 100000; // Beyond it, the scanner keeps the candidates in the set
+
+/**
+ * Candidates of an unknown value scan, by page, so that millions of them do not become Pem.
+ * A dense page is a bitmap of the offsets, with the copy of the page for the values. A sparse page is the
+ * sorted offsets as varint deltas, with the value of every candidate. Each page takes the smaller form
+ * whenever it is added or filtered, so the set turns sparse as the filters narrow it.
+ * The values are the ones read by the last filter, for the change operators.
+ */
+class CandidateSet {
+public:
+  CandidateSet();
+
+  void reset(size_t valueSize);
+  void clear();
+  bool empty();
+  size_t size();
+  size_t getValueSize();
+  size_t getPageCount();
+  size_t getDensePageCount();
+  size_t getMemoryUsage();
+
+  // "offsets" are sorted, within the page size from "addr", and "data" is the memory at "addr"
+  void addPage(Address addr, const vector<uint16_t>& offsets, const Byte* data);
+
+  // Keep the candidates for which match(newValue, oldValue) is true, with the values read by "memio".
+  // The kept values are "newValueSize" bytes, which is also the bytes compared. Return the number kept.
+  template<typename F>
+  size_t filter(MemIO* memio, size_t newValueSize, ScanProgress& progress, F match);
+
+  // At most "max" candidates as Pem, with the value remembered
+  vector<MemPtr> toList(MemIO* memio, const string& scanType, size_t max = SIZE_MAX);
+
+private:
+  struct Page {
+    Address addr;
+    uint32_t count;
+    uint16_t first;
+    uint16_t last;
+    bool dense;
+    vector<uint64_t> bitmap; // Dense, bit of every offset
+    vector<uint8_t> deltas;  // Sparse, varint of the differences between the offsets
+    vector<Byte> values;     // The page when dense, the value of every candidate when sparse
+  };
+
+  void makePage(Page& page, Address addr, const vector<uint16_t>& offsets, const Byte* data);
+  // fn(offset, index) in the order of the offsets
+  template<typename F>
+  static void forEachOffset(const Page& page, F fn);
+
+  vector<Page> pages;
+  size_t count;
+  size_t valueSize;
+  size_t pageSize;
+};
+
+template<typename F>
+void CandidateSet::forEachOffset(const Page& page, F fn) {
+  if (page.dense) {
+    size_t index = 0;
+    for (size_t w = 0; w < page.bitmap.size(); w++) {
+      uint64_t word = page.bitmap[w];
+      while (word) {
+        fn(w * 64 + __builtin_ctzll(word), index++);
+        word &= word - 1;
+      }
+    }
+    return;
+  }
+
+  size_t offset = 0;
+  size_t index = 0;
+  const uint8_t* ptr = page.deltas.data();
+  const uint8_t* end = ptr + page.deltas.size();
+  while (ptr < end) {
+    size_t delta = 0;
+    int shift = 0;
+    do {
+      delta |= (size_t)(*ptr & 0x7f) << shift;
+      shift += 7;
+    } while (*ptr++ & 0x80);
+    offset += delta;
+    fn(offset, index++);
+  }
+}
+
+template<typename F>
+size_t CandidateSet::filter(MemIO* memio, size_t newValueSize, ScanProgress& progress, F match) {
+  Metrics& metrics = Metrics::getInstance();
+  vector<Byte> buffer(pageSize);
+  vector<uint16_t> offsets;
+  vector<Page> kept;
+  size_t comparisons = 0;
+  size_t oldValueSize = valueSize;
+  valueSize = newValueSize;
+  count = 0;
+  for (auto& page : pages) {
+    if (progress.isCancelled()) {
+      // Cancelled filter keeps the pages which are not checked
+      if (oldValueSize != newValueSize) break;
+      count += page.count;
+      kept.push_back(std::move(page));
+      continue;
+    }
+    progress.addBytesScanned(pageSize);
+
+    // Sparse page only reads the span of its candidates
+    size_t low = page.dense ? 0 : page.first;
+    size_t high = page.dense ? pageSize : min(pageSize, (size_t)page.last + newValueSize);
+    if (!memio->read(page.addr + low, buffer.data() + low, high - low)) {
+      metrics.add(Counter::PagesFailed);
+      continue;
+    }
+
+    offsets.clear();
+    const Byte* values = page.values.data();
+    bool dense = page.dense;
+    size_t size = oldValueSize;
+    forEachOffset(page, [&](size_t offset, size_t index) {
+        if (offset + newValueSize > high) return;
+        comparisons++;
+        const Byte* oldValue = dense ? values + offset : values + index * size;
+        if (match(buffer.data() + offset, oldValue)) {
+          offsets.push_back(offset);
+        }
+      });
+    if (offsets.empty()) continue;
+
+    kept.emplace_back();
+    makePage(kept.back(), page.addr, offsets, buffer.data());
+    count += offsets.size();
+    progress.addHits(offsets.size());
+  }
+  pages.swap(kept);
+  metrics.add(Counter::Comparisons, comparisons);
+  metrics.add(Counter::Hits, count);
+  return count;
+}
+
+#endif
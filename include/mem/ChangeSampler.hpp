@@ -0,0 +1,65 @@
+#ifndef CHANGE_SAMPLER_HPP
+#define CHANGE_SAMPLER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "med/MedTypes.hpp"
+#include "mem/MemIO.hpp"
+#include "mem/MemList.hpp"
+#include "mem/ScanProgress.hpp"
+
+using namespace std;
+
+const double SAMPLE_DEFAULT_SECONDS = 5;
+const double SAMPLE_DEFAULT_RATE = 30; // Samples per second
+const uint16_t SAMPLE_CHANGES_MAX = UINT16_MAX;
+
+/**
+ * Read the scan results repeatedly, and count how many times each value changes, with its minimum and maximum.
+ * The values are found by how they behave, "#>= 20" keeps the ones which changed at least 20 times,
+ * "#= 0" the ones which never changed.
+ * The candidates nearby are read together, in a single batch of every sample.
+ */
+class ChangeSampler {
+public:
+  ChangeSampler();
+  // Candidates to sample, by the scan type
+  void reset(MemList& list, const string& scanType);
+  void clear();
+  // Read every candidate for the seconds, at the rate per second. Stop when the progress is cancelled.
+  void sample(MemIO* memio, double seconds, double rate, ScanProgress& progress);
+
+  size_t size();
+  size_t getSamples();
+  string getScanType();
+  // The list which is sampled, shared with the scans
+  MemList& getList();
+  // By the index of the list. The count stops at SAMPLE_CHANGES_MAX.
+  uint16_t getChanges(size_t index);
+  string getMin(size_t index);
+  string getMax(size_t index);
+
+  // The candidates of which the change count matches the filter, "#" followed by the operator and the count,
+  // "#<> 5 10" for between. Throw if the filter is not valid.
+  vector<MemPtr> filter(const string& value);
+  static bool isSampleFilter(const string& value);
+
+private:
+  void update(const Byte* values, size_t index);
+  bool isLess(const Byte* a, const Byte* b);
+
+  MemList list;
+  string scanType;
+  size_t valueSize;
+  size_t samples;
+  vector<size_t> order; // Indices of the list, sorted by address
+  vector<uint16_t> changes;
+  vector<bool> seen;
+  vector<Byte> lastValues; // Value of every candidate, by the index of the list
+  vector<Byte> minValues;
+  vector<Byte> maxValues;
+};
+
+#endif
@@ -1,3 +1,7 @@
+#ifndef MAPS_HPP
+#define MAPS_HPP
+
+#include <string>
 #include <vector>
 #include <utility>
 
@@ -10,9 +14,17 @@ public:
   Maps();
   AddressPairs& getMaps();
   bool hasPair(const AddressPair& pair);
-  void push(const AddressPair& pair);
+  void push(const AddressPair& pair, const string& name = "");
   size_t size();
 
+  // Pathname of the map, empty for anonymous map
+  string& getName(int index);
+  // Anonymous memory, such as heap and stack, which is not backed by file
+  bool isAnonymous(int index);
+
 private:
   AddressPairs maps;
+  vector<string> names;
 };
+
+#endif
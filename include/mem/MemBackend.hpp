@@ -0,0 +1,119 @@
+#ifndef MEM_BACKEND_HPP
+#define MEM_BACKEND_HPP
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "med/MedTypes.hpp"
+#include "mem/MemDump.hpp"
+
+using namespace std;
+
+const char MEM_BACKEND_SELF[] = "self";
+const char MEM_BACKEND_PROC_MEM[] = "procmem";
+const char MEM_BACKEND_VM[] = "vm";
+const char MEM_BACKEND_PTRACE[] = "ptrace";
+const char MEM_BACKEND_DUMP[] = "dump";
+
+const size_t MEM_BACKEND_PROBE_READS = 16;
+
+// One read or write of a batch. "success" is set by the backend.
+struct MemRequest {
+  Address addr;
+  Byte* buf;
+  size_t size;
+  bool success;
+};
+
+/**
+ * Access to the memory of a process, or of the dump.
+ * Read and write are thread-safe. The batch is for the backends which save the syscalls, by process_vm_readv,
+ * or the attaches of ptrace; the others read the requests one by one.
+ */
+class MemBackend {
+public:
+  virtual ~MemBackend();
+  virtual string getName() = 0;
+  // False if any byte is not read or written
+  virtual bool read(Address addr, Byte* buf, size_t size) = 0;
+  virtual bool write(Address addr, const Byte* buf, size_t size) = 0;
+  // Number of the requests which succeed
+  virtual size_t readBatch(vector<MemRequest>& requests);
+  virtual size_t writeBatch(vector<MemRequest>& requests);
+
+  // Backend by name, throw if it cannot access the process
+  static shared_ptr<MemBackend> create(const string& name, pid_t pid);
+  // Fastest backend which reads the process with the current permissions, ptrace if none of them can
+  static shared_ptr<MemBackend> probe(pid_t pid);
+  // Names of the backends for a process
+  static vector<string> getNames();
+};
+
+// Memory of Med itself
+class SelfBackend : public MemBackend {
+public:
+  string getName() override;
+  bool read(Address addr, Byte* buf, size_t size) override;
+  bool write(Address addr, const Byte* buf, size_t size) override;
+};
+
+// pread and pwrite on /proc/pid/mem, without attaching
+class ProcMemBackend : public MemBackend {
+public:
+  explicit ProcMemBackend(pid_t pid);
+  ~ProcMemBackend() override;
+  string getName() override;
+  bool read(Address addr, Byte* buf, size_t size) override;
+  bool write(Address addr, const Byte* buf, size_t size) override;
+
+private:
+  int fd;
+};
+
+// process_vm_readv and process_vm_writev, a batch in a single syscall
+class VmBackend : public MemBackend {
+public:
+  explicit VmBackend(pid_t pid);
+  string getName() override;
+  bool read(Address addr, Byte* buf, size_t size) override;
+  bool write(Address addr, const Byte* buf, size_t size) override;
+  size_t readBatch(vector<MemRequest>& requests) override;
+  size_t writeBatch(vector<MemRequest>& requests) override;
+
+private:
+  size_t transfer(vector<MemRequest>& requests, bool isWrite);
+  pid_t pid;
+};
+
+// PTRACE_PEEKDATA and PTRACE_POKEDATA, a batch in a single attach. It writes the read-only pages as well.
+class PtraceBackend : public MemBackend {
+public:
+  explicit PtraceBackend(pid_t pid);
+  string getName() override;
+  bool read(Address addr, Byte* buf, size_t size) override;
+  bool write(Address addr, const Byte* buf, size_t size) override;
+  size_t readBatch(vector<MemRequest>& requests) override;
+  size_t writeBatch(vector<MemRequest>& requests) override;
+
+private:
+  bool peek(Address addr, Byte* buf, size_t size);
+  bool poke(Address addr, const Byte* buf, size_t size);
+  pid_t pid;
+  std::mutex mutex;
+};
+
+class DumpBackend : public MemBackend {
+public:
+  explicit DumpBackend(shared_ptr<MemDump> dump);
+  string getName() override;
+  bool read(Address addr, Byte* buf, size_t size) override;
+  bool write(Address addr, const Byte* buf, size_t size) override;
+  MemDump* getDump();
+
+private:
+  shared_ptr<MemDump> dump;
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef MEM_DUMP_HPP
+#define MEM_DUMP_HPP
+
+#include <string>
+#include <vector>
+
+#include "med/MedTypes.hpp"
+#include "mem/Maps.hpp"
+
+using namespace std;
+
+class MemIO;
+
+/**
+ * Memory of a process saved in a file, mapped with mmap, so that it is scanned offline.
+ * It is either an ELF core file, or the dump saved by Med (see save()).
+ * The writable regions stand for /proc/pid/maps. Writes change the private copy only.
+ */
+class MemDump {
+public:
+  explicit MemDump(const string& filename);
+  ~MemDump();
+  MemDump(const MemDump&) = delete;
+  MemDump& operator=(const MemDump&) = delete;
+
+  const string& getFilename();
+  Maps& getMaps();
+  // False if any byte is not in the dump
+  bool read(Address addr, Byte* buf, size_t size);
+  bool write(Address addr, const Byte* buf, size_t size);
+
+  // Save the maps of the process. The pages which cannot be read are saved as zero.
+  static void save(MemIO* memio, Maps& maps, const string& filename);
+
+private:
+  struct Region {
+    Address start;
+    Address end;
+    size_t offset; // In the file
+  };
+
+  void loadCore();
+  void loadDump();
+  Byte* find(Address addr, size_t size);
+
+  string filename;
+  Maps maps;
+  vector<Region> regions; // Sorted by address
+  Byte* data;
+  size_t size;
+};
+
+#endif
@@ -6,9 +6,14 @@
 
 #include <json/json.h>
 
+#include "mem/ChangeSampler.hpp"
 #include "mem/MemScanner.hpp"
 #include "mem/MemList.hpp"
 #include "mem/NamedScans.hpp"
+#include "mem/ScanJob.hpp"
+#include "mem/ValueRecorder.hpp"
+#include "mem/Watchpoint.hpp"
+#include "med/Metrics.hpp"
 #include "med/Process.hpp"
 
 const int LOCK_REFRESH_RATE = 800;
@@ -20,13 +25,56 @@ public:
   ~MemEd();
   void setPid(pid_t pid);
   pid_t getPid();
+  // Work on the memory dump or core file instead of a process, until another process is selected
+  void openDump(const string& filename);
+  // Save the memory of the process within the scan ranges, which can be opened by openDump()
+  void saveDump(const string& filename);
   vector<MemPtr> scan(const string& value, const string& scanType, bool fastScan = false, const string& lastDigit = "");
   vector<MemPtr> filter(const string& value, const string& scanType, bool fastScan = false);
+  // Non-blocking scan and filter. Only one job can run at a time.
+  ScanJobPtr scanAsync(const string& value, const string& scanType, bool fastScan = false, const string& lastDigit = "");
+  ScanJobPtr filterAsync(const string& value, const string& scanType, bool fastScan = false);
+  // Count the changes of the scans for the seconds, at the rate per second, for the "#" filters, see ChangeSampler
+  void sample(double seconds = SAMPLE_DEFAULT_SECONDS, double rate = SAMPLE_DEFAULT_RATE);
+  ScanJobPtr sampleAsync(double seconds = SAMPLE_DEFAULT_SECONDS, double rate = SAMPLE_DEFAULT_RATE);
+  ChangeSampler& getSampler();
+  // Collect the instructions which write [address, address + size) for the seconds, see Watchpoint
+  vector<WatchHit> watchWrites(Address address, size_t size, double seconds = WATCH_DEFAULT_SECONDS);
+  ScanJobPtr watchWritesAsync(Address address, size_t size, double seconds = WATCH_DEFAULT_SECONDS);
+  vector<WatchHit>& getWatchHits();
+  ScanJobPtr getScanJob();
+  // Anchors and member offsets of the last group scan, see GroupScan
+  vector<GroupMatch> getGroupMatches();
   NamedScans& getNamedScans();
+  // Switch to the named scan, or remove it, which the scan job cannot do meanwhile
+  void setActiveScanName(const string& name);
+  bool removeNamedScan(const string& name);
+  // Not locked, the caller locks getScanListMutex() while a job may publish the scans
   MemList getScans();
+  // Number of the scan results, more than the scans when the candidates are kept by the scanner, see CandidateSet
+  size_t getScanCount();
+  // Not locked, like getScans()
   void clearScans();
+  // Back to the previous or the next scan result of the active named scan, without reading the memory.
+  // Return false if there is none.
+  bool undoScan();
+  bool redoScan();
   MemList* getStore();
   void addToStoreByIndex(int index);
+  // Add the same field of the other elements of the array of structs around the stored address
+  StrideMatch addStrideToStore(int index, size_t maxStride = STRIDE_DEFAULT_MAX);
+  // Generate the signature of the stored address, which is saved with it
+  Signature makeSignature(int index);
+  // Move the stored addresses to the unique match of their signatures. Return the number moved.
+  int resolveSignatures();
+  // Save every pointer of the process, with the target address of this run, see PointerMap
+  void savePointerMap(Address target, const string& filename);
+  // Pointer paths to the target, which are valid in all the saved pointer maps
+  vector<PointerPath> findPointerPaths(const vector<string>& filenames, size_t maxDepth, size_t maxOffset);
+  // Record the values of the stored addresses by their indices, until stopRecording(), see ValueRecorder
+  void startRecording(const vector<int>& indices, double rate = RECORDER_DEFAULT_RATE);
+  void stopRecording();
+  ValueRecorder* getRecorder();
   void addNewAddress();
   MemPtr readMemory(Address addr, size_t size);
   void setValueByAddress(Address addr, const string& value, const string& scanType);
@@ -52,9 +100,27 @@ public:
 
   void setScopeStart(Address addr);
   void setScopeEnd(Address addr);
+  // Restrict the scans to the intervals and modules, such as "7f001000-7f002000 libgame.so [heap] anon"
+  void setScanRanges(const string& spec);
+  string getScanRanges();
 
   std::mutex& getScanListMutex();
 
+  // Progress of the running scan or filter, can be polled from another thread
+  ScanProgress& getScanProgress();
+  // Stop the running scan or filter, which returns the results found so far
+  void cancelScan();
+
+  // Counters and timers of the last scan or filter
+  Metrics& getMetrics();
+  // Save Chrome trace JSON to the file after every scan and filter. Empty to disable.
+  void setTraceFile(const string& filename);
+  // Skip untouched and zero pages during the scan, when the value cannot be zero
+  void setSkipZeroPages(bool value);
+  // Backend probed when the process is selected, and replaced by name, see MemBackend
+  string getMemBackend();
+  void setMemBackend(const string& name);
+
   void resumeProcess();
   void pauseProcess();
   bool getIsProcessPaused();
@@ -63,16 +129,38 @@ public:
 
 private:
   void initialize();
+  vector<MemPtr> scanWithoutReset(const string& value, const string& scanType, bool fastScan, const string& lastDigit);
+  vector<MemPtr> filterWithoutReset(const string& value, const string& scanType, bool fastScan);
+  vector<MemPtr> scanGroup(const string& value);
+  vector<MemPtr> sampleWithoutReset(double seconds, double rate);
+  vector<MemPtr> watchWithoutReset(Address address, size_t size, double seconds);
+  ScanJobPtr startScanJob(ScanJob::Task task);
+  // Publish to the named scan which was active when the job started
+  void publishScans(const vector<MemPtr>& mems, const string& scanType, const string& name);
+  string getActiveScanName();
+  // Throw while the scan job runs, so that what it reads is not replaced
+  void checkScanJobDone();
+  bool moveInHistory(bool backward);
+  // The candidates of the scanner are of the active scan list
+  bool hasOwnCandidates();
+  void resetScanState();
   pid_t pid;
   MemScanner* scanner;
+  ValueRecorder* recorder;
   NamedScans namedScans;
+  MemList candidateScans; // Shares the list which the candidates of the scanner belong to
   MemList* store;
   std::mutex storeMutex;
   std::thread* lockValueThread;
+  ScanJobPtr scanJob;
+  vector<GroupMatch> groupMatches;
+  ChangeSampler sampler;
+  vector<WatchHit> watchHits;
   bool canResumeProcess;
   bool isProcessPaused;
 
   string notes;
+  string traceFile;
 };
 
 #endif
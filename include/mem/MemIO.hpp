@@ -1,24 +1,50 @@
 #ifndef MEM_IO_H
 #define MEM_IO_H
 
+#include <memory>
 #include <mutex>
+#include <string>
+#include <vector>
 #include "med/MedTypes.hpp"
 #include "mem/Mem.hpp"
+#include "mem/Maps.hpp"
+#include "mem/MemBackend.hpp"
+#include "mem/MemDump.hpp"
 
+/**
+ * Reads and writes the memory of the process, or the dump, through the backend.
+ * The backend is probed when the process is selected, see MemBackend::probe().
+ * The backend is replaced under the mutex, and every operation works on its own reference to it,
+ * so that the scan, refresh and lock threads can read while the process is selected again.
+ */
 class MemIO {
 public:
   MemIO();
+  // Selecting a process closes the dump
   void setPid(pid_t pid);
   pid_t getPid();
+  // Read and write the memory dump instead of the process, null to close it
+  void setDump(std::shared_ptr<MemDump> dump);
+  std::shared_ptr<MemDump> getDump();
+  // Replace the probed backend, see MemBackend::create()
+  void setBackend(const string& name);
+  std::shared_ptr<MemBackend> getBackend();
+  // Maps of the process or the dump
+  Maps getMaps();
+
+  // Throw if the memory is not readable
   MemPtr read(Address addr, size_t size);
+  // Read into the buffer. Return false if the memory is not readable.
+  bool read(Address addr, Byte* buf, size_t size);
+  size_t readBatch(vector<MemRequest>& requests);
+  // Write by the backend, or by ptrace if the backend cannot, such as to the read-only pages. Throw if both fail.
   void write(Address addr, MemPtr mem, size_t size = 0);
 
 private:
-  MemPtr readProcess(Address addr, size_t size);
-  MemPtr readDirect(Address addr, size_t size);
-  void writeProcess(Address addr, MemPtr mem, size_t size);
-  void writeDirect(Address addr, MemPtr mem, size_t size);
   pid_t pid;
+  std::shared_ptr<MemDump> dump;
+  std::shared_ptr<MemBackend> backend;
+  std::shared_ptr<MemBackend> fallback; // Ptrace writer of the process, null for the dump and self
   std::mutex mutex;
 };
 
@@ -1,19 +1,22 @@
 #ifndef MEM_LIST_HPP
 #define MEM_LIST_HPP
 
+#include <memory>
 #include <vector>
 #include "mem/Mem.hpp"
 
 using namespace std;
 
-// List that will use methods from PemPtr and SemPtr
+// List that will use methods from PemPtr and SemPtr.
+// The copies share the vector until one of them adds, removes or reorders the elements (copy-on-write).
+// The elements themselves are always shared.
 class MemList {
 public:
   MemList();
   explicit MemList(vector<MemPtr> list);
   size_t size();
   void setList(const vector<MemPtr>& list);
-  vector<MemPtr>& getList();
+  const vector<MemPtr>& getList();
   string getAddressAsString(int index);
   Address getAddress(int index);
   string getValue(int index, const string& scanType);
@@ -39,8 +42,19 @@ public:
   static vector<MemPtr> sortByAddress(vector<MemPtr>& list);
   static vector<MemPtr> sortByDescription(vector<MemPtr>& list);
 
+  // Set operations by address, in a single merge of the lists sorted by address.
+  // The element of "a" is taken when both have the address. The result is sorted by address.
+  static MemList intersect(MemList& a, MemList& b);
+  static MemList unite(MemList& a, MemList& b);
+  static MemList subtract(MemList& a, MemList& b);
+
 private:
-  vector<MemPtr> list;
+  // Own the vector before changing it
+  vector<MemPtr>& detach();
+  // The vector itself if it is sorted, else a sorted copy
+  static shared_ptr<const vector<MemPtr>> sortedByAddress(MemList& list);
+
+  shared_ptr<vector<MemPtr>> list;
 };
 
 #endif
@@ -1,6 +1,7 @@
 #ifndef SCANNER_HPP
 #define SCANNER_HPP
 
+#include <functional>
 #include <mutex>
 #include <vector>
 #include <string>
@@ -11,11 +12,35 @@
 #include "med/Operands.hpp"
 #include "med/MedCommon.hpp"
 #include "med/ScanCommand.hpp"
+#include "med/GroupScan.hpp"
+#include "med/Signature.hpp"
+#include "med/StrideDetector.hpp"
+#include "mem/CandidateSet.hpp"
 #include "mem/Mem.hpp"
 #include "mem/MemIO.hpp"
+#include "mem/PointerMap.hpp"
+#include "mem/ScanProgress.hpp"
+#include "mem/ScanRanges.hpp"
 
 using namespace std;
 
+class Pem;
+
+// Candidates sorted by address, which lie on the same or adjacent pages, are filtered with a single read
+struct FilterBucket {
+  size_t begin; // Index range of the sorted candidates
+  size_t end;
+  Address start; // Memory range to read
+  size_t size;
+};
+
+// Set the matched flags of the candidates of a bucket.
+// The value of candidate i is at values + offsets[i].
+typedef std::function<void(const Byte* values,
+                           const vector<size_t>& offsets,
+                           const vector<Pem*>& pems,
+                           vector<uint8_t>& matched)> BucketMatcher;
+
 class MemScanner {
 public:
   MemScanner();
@@ -23,6 +48,10 @@ public:
   ~MemScanner();
   void setPid(pid_t pid);
   pid_t getPid();
+  // Scan the memory dump or core file instead of a process, see MemDump. setPid() closes it.
+  void openDump(const string& filename);
+  // Save the scanned memory as a dump
+  void saveDump(const string& filename);
   MemIO* getMemIO();
   vector<MemPtr> scan(Operands& operands,
                       int size,
@@ -31,6 +60,16 @@ public:
                       bool fastScan = false,
                       int lastDigit = -1);
   vector<MemPtr> scan(ScanCommand &scanCommand);
+  // Find the values which are near to each other, see GroupScan. Sorted by the anchor address.
+  vector<GroupMatch> scanGroup(GroupScan& group);
+  // Find the array of structs around the address, see StrideDetector
+  StrideMatch detectStride(StrideDetector& detector, Address anchor);
+  // Collect every pointer of the scanned memory into the map, with the target address of this run
+  void scanPointers(PointerMap& pointerMap, Address target);
+  // Shortest pattern around the value, which is unique in the scanned memory, see Signature
+  Signature makeSignature(Address addr, size_t valueSize);
+  // Addresses of the value found by the signature, sorted
+  vector<Address> resolveSignature(Signature& signature);
   vector<MemPtr> filter(const vector<MemPtr>& list,
                         Operands& operands,
                         int size,
@@ -41,11 +80,23 @@ public:
                                const string& scanType,
                                const ScanParser::OpType& op,
                                bool fastScan = false);
+  vector<MemPtr> filterUnknown(const vector<MemPtr>& list,
+                               Operands& operands,
+                               const string& scanType,
+                               const ScanParser::OpType& op,
+                               bool fastScan = false);
   vector<MemPtr> filterUnknownWithList(const vector<MemPtr>& list,
+                                       Operands& operands,
                                        const string& scanType,
                                        const ScanParser::OpType& op);
   vector<MemPtr>& saveSnapshot(const vector<MemPtr>& baseList);
-  vector<MemPtr> filterSnapshot(const string& scanType, const ScanParser::OpType& op, bool fastScan = false);
+  // The snapshot filter keeps the candidates in the set. While the set is not empty, the filters narrow the set,
+  // instead of the list, and return at most CANDIDATE_LIST_MAX of them.
+  // The pages which are not soft-dirty are not read, which relies on saveSnapshot() clearing the bits.
+  vector<MemPtr> filterSnapshot(Operands& operands,
+                                const string& scanType,
+                                const ScanParser::OpType& op,
+                                bool fastScan = false);
 
   vector<MemPtr> scanInner(Operands& operands,
                            int size,
@@ -64,30 +115,58 @@ public:
   vector<MemPtr> filterUnknownInner(const vector<MemPtr>& list,
                                     const string& scanType,
                                     const ScanParser::OpType& op);
+  vector<MemPtr> filterUnknownInner(const vector<MemPtr>& list,
+                                    Operands& operands,
+                                    const string& scanType,
+                                    const ScanParser::OpType& op);
 
   AddressPair* getScope();
   void setScopeStart(Address addr);
   void setScopeEnd(Address addr);
+  // Scans and snapshots are restricted to the ranges, together with the scope
+  void setScanRanges(const ScanRanges& ranges);
+  ScanRanges& getScanRanges();
+
+  // Number of the candidates of the last filter, which can be more than the list returned
+  size_t getCandidateCount();
+  CandidateSet& getCandidates();
+  void clearCandidates();
 
   std::mutex& getListMutex();
+  ScanProgress& getProgress();
+  bool isSoftDirtyTracking();
+  // Skip the pages which are all zero, when the value cannot match zero
+  void setSkipZeroPages(bool value);
+  bool getSkipZeroPages();
+
+  // Group the sorted addresses of the values with the size into buckets
+  static vector<FilterBucket> makeFilterBuckets(const vector<Address>& addresses, size_t size);
 
 private:
   void initialize();
   Maps getInterestedMaps(Maps& maps, const vector<MemPtr>& list);
-  void compareBlocks(vector<MemPtr>& list,
+  void compareBlocks(vector<uint16_t>& offsets,
                      MemPtr& oldBlock,
                      MemPtr& newBlock,
+                     Operands& operands,
                      const string& scanType,
                      const ScanParser::OpType& op,
                      bool fastScan = false);
+  // Every offset of the block which compareBlocks() would compare
+  void keepBlock(vector<uint16_t>& offsets, MemPtr& block, const string& scanType, bool fastScan = false);
+  vector<MemPtr> filterCandidates(Operands& operands,
+                                  const string& scanType,
+                                  const ScanParser::OpType& op);
+  // The candidates as the list, the set is cleared unless it is larger than the list
+  vector<MemPtr> takeCandidates(const string& scanType);
 
-  vector<MemPtr> scanByScope(Operands& operands,
+  vector<MemPtr> scanByRanges(Operands& operands,
                              int size,
                              const string& scanType,
                              const ScanParser::OpType& op,
                              bool fastScan = false,
                              int lastDigit = -1);
-  vector<MemPtr> scanByScope(ScanCommand &scanCommand);
+  vector<MemPtr> scanByRanges(ScanCommand &scanCommand);
 
   vector<MemPtr> scanByMaps(Operands& operands,
                             int size,
@@ -97,81 +176,83 @@ private:
                             int lastDigit = -1);
   vector<MemPtr> scanByMaps(ScanCommand &scanCommand);
 
-  static void scanMap(MemIO* memio,
+  // Scan the maps in parallel, large maps are split across the workers
+  vector<MemPtr> scanMaps(Maps& maps,
+                          Operands& operands,
+                          int size,
+                          const string& scanType,
+                          const ScanParser::OpType& op,
+                          bool fastScan = false,
+                          int lastDigit = -1);
+  vector<MemPtr> scanMaps(Maps& maps, ScanCommand &scanCommand);
+  Maps getRangeMaps();
+
+  vector<MemPtr>& saveSnapshotByRanges();
+  vector<MemPtr>& saveSnapshotByList(const vector<MemPtr>& baseList);
+
+  static void saveSnapshotMap(MemIO* memio,
+                              vector<MemPtr>& snapshot,
+                              Maps& maps,
+                              int mapIndex,
+                              ScanProgress& progress);
+
+  // Scan the page, and return the number of hits. The hits are passed to the progress as well.
+  static int scanPage(MemIO* memio,
                       std::mutex& mutex,
                       vector<MemPtr>& list,
-                      Maps& maps,
-                      int mapIndex,
-                      int fd,
-                      std::mutex& fdMutex,
+                      ScanProgress& progress,
+                      Byte* page,
+                      Address start,
                       Operands& operands,
                       int size,
                       const string& scanType,
                       const ScanParser::OpType& op,
                       bool fastScan = false,
                       int lastDigit = -1);
-  static void scanMap(MemIO* memio,
+  static int scanPage(MemIO* memio,
                       std::mutex& mutex,
                       vector<MemPtr>& list,
-                      Maps& maps,
-                      int mapIndex,
-                      int fd,
-                      std::mutex& fdMutex,
+                      ScanProgress& progress,
+                      Byte* page,
+                      Address start,
                       ScanCommand &scanCommand);
-
-  vector<MemPtr>& saveSnapshotByScope();
-  vector<MemPtr>& saveSnapshotByList(const vector<MemPtr>& baseList);
-
-  static void saveSnapshotMap(MemIO* memio,
-                              vector<MemPtr>& snapshot,
-                              Maps& maps,
-                              int mapIndex);
-  static void scanPage(MemIO* memio,
-                       std::mutex& mutex,
-                       vector<MemPtr>& list,
-                       Byte* page,
-                       Address start,
-                       Operands& operands,
-                       int size,
-                       const string& scanType,
-                       const ScanParser::OpType& op,
-                       bool fastScan = false,
-                       int lastDigit = -1);
-  static void scanPage(MemIO* memio,
-                       std::mutex& mutex,
-                       vector<MemPtr>& list,
-                       Byte* page,
-                       Address start,
-                       ScanCommand &scanCommand);
-
-  static void filterByChunk(std::mutex& mutex,
-                            const vector<MemPtr>& list,
-                            vector<MemPtr>& newList,
-                            int listIndex,
+  static int scanPageApprox(MemIO* memio,
+                            std::mutex& mutex,
+                            vector<MemPtr>& list,
+                            ScanProgress& progress,
+                            Byte* page,
+                            Address start,
                             Operands& operands,
                             int size,
                             const string& scanType,
+                            bool fastScan = false,
+                            int lastDigit = -1);
+
+  // Filter the candidates in address order, page by page. The result is sorted by address.
+  vector<MemPtr> filterByBuckets(const vector<MemPtr>& list,
+                                 size_t size,
+                                 const string& scanType,
+                                 const BucketMatcher& matcher);
+  static bool compareChange(Byte* newValue,
+                            Byte* oldValue,
+                            int size,
+                            Operands& operands,
+                            const string& scanType,
                             const ScanParser::OpType& op);
-  static void filterByChunk(std::mutex& mutex,
-                            const vector<MemPtr>& list,
-                            vector<MemPtr>& newList,
-                            int listIndex,
-                            ScanCommand &scanCommand);
-  static void filterUnknownByChunk(std::mutex& mutex,
-                                   const vector<MemPtr>& list,
-                                   vector<MemPtr>& newList,
-                                   int listIndex,
-                                   const string& scanType,
-                                   const ScanParser::OpType& op);
-
-  bool hasScope();
+
+  bool hasScanRanges();
 
   pid_t pid;
   ThreadManager* threadManager;
   MemIO* memio;
   vector<MemPtr> snapshot;
+  bool softDirtyTracking; // Pages are soft-dirty tracked since the snapshot
+  CandidateSet candidates;
+  bool skipZeroPages;
   AddressPair* scope;
+  ScanRanges ranges;
   std::mutex listMutex;
+  ScanProgress progress;
 };
 
 #endif
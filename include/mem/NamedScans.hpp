@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 #include "mem/MemList.hpp"
+#include "mem/ScanHistory.hpp"
 
 using namespace std;
 
@@ -14,10 +15,20 @@ public:
 
   NamedScans();
   MemList* addNewScan(string name);
+  // "a & b", "a | b" or "a - b" of the named scans a and b, by address, is added as the scan named by the expression
+  MemList* addCombinedScan(string expression);
+  static bool isCombinedScan(string expression);
   MemList* getMemList();
   MemList* getMemList(string name);
+  // Replace the active list, which is added to its history
   void setMemPtrs(vector<MemPtr> list, string scanType);
+  // Replace the list of the named scan, false if there is no such scan. See ScanHistory::push() for capped.
+  bool setMemPtrs(string name, vector<MemPtr> list, string scanType, bool capped = false);
   bool remove(string name);
+  // Previous or next result of the active named scan, false if there is none
+  bool undo();
+  bool redo();
+  ScanHistory& getHistory();
 
   void setActiveName(string name);
   string getActiveName();
@@ -30,6 +41,7 @@ private:
   map<string, MemList> data;
   string activeName;
   map<string, string> scanTypes;
+  map<string, ScanHistory> histories;
 };
 
 #endif
@@ -0,0 +1,39 @@
+#ifndef PAGE_MAP_HPP
+#define PAGE_MAP_HPP
+
+#include <cstdint>
+#include <vector>
+#include <sys/types.h>
+
+#include "med/MedTypes.hpp"
+
+using namespace std;
+
+// Reader of /proc/pid/pagemap, one 64-bit entry per page.
+// pid 0 refers to the current process.
+class PageMap {
+public:
+  explicit PageMap(pid_t pid);
+  ~PageMap();
+
+  bool isAvailable();
+  // Read the entries of the pages covering [addr, addr + size)
+  bool read(Address addr, size_t size, vector<uint64_t>& entries);
+  // True if any page covering [addr, addr + size) is soft-dirty. True if cannot be read.
+  bool isSoftDirty(Address addr, size_t size);
+
+  static bool isPresent(uint64_t entry) { return entry & (1ULL << 63); }
+  static bool isSwapped(uint64_t entry) { return entry & (1ULL << 62); }
+  static bool isSoftDirty(uint64_t entry) { return entry & (1ULL << 55); }
+
+  // Write "4" to /proc/pid/clear_refs, so that the following writes mark the pages soft-dirty
+  static bool clearSoftDirty(pid_t pid);
+  // Some kernels accept clear_refs without tracking soft-dirty, so probe it on the current process
+  static bool isSoftDirtySupported();
+
+private:
+  static bool probeSoftDirty();
+  int fd;
+};
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef POINTER_MAP_HPP
+#define POINTER_MAP_HPP
+
+#include <string>
+#include <vector>
+
+#include "med/MedTypes.hpp"
+#include "mem/Maps.hpp"
+
+using namespace std;
+
+const size_t POINTER_MAX_NODES = 100000; // Per level of the path search
+const size_t POINTER_MAX_PATHS = 10000;
+
+// Pointer-sized value at "source", which points into a mapped region
+struct PointerEntry {
+  Address source;
+  Address value;
+};
+
+/**
+ * Path from a module to the target, as [[[module + offset] + offsets[0]] + offsets[1]] ...
+ * Module is the file name of a file-backed map, and its base is the start of its first map.
+ */
+struct PointerPath {
+  string module;
+  Address offset;
+  vector<long> offsets;
+
+  bool operator==(const PointerPath& other) const;
+  bool operator<(const PointerPath& other) const;
+  string toString() const;
+};
+
+/**
+ * Every pointer of a process, with its maps and the target address of the run.
+ * The pointers are sorted by source, with an index sorted by value, so that the pointers to an address are found
+ * by binary search. It is saved to a file and loaded with mmap, so that the maps of several runs are searched
+ * without rescanning, and the paths to the target are intersected between the runs.
+ */
+class PointerMap {
+public:
+  PointerMap();
+  ~PointerMap();
+  PointerMap(const PointerMap&) = delete;
+  PointerMap& operator=(const PointerMap&) = delete;
+
+  // Take the pointers sorted by source
+  void set(Maps& maps, vector<PointerEntry>& entries, Address target);
+  void save(const string& filename);
+  void load(const string& filename);
+
+  Address getTarget();
+  size_t size();
+  Maps& getMaps();
+
+  // Value of the pointer at the address. False if the address does not hold a pointer.
+  bool readPointer(Address addr, Address& value);
+  // Pointers with the value within [low, high]
+  vector<PointerEntry> findPointersTo(Address low, Address high);
+  bool getModuleBase(const string& module, Address& base);
+
+  // Paths to the target with at most "maxDepth" dereferences, and offsets within [0, maxOffset]
+  vector<PointerPath> findPaths(size_t maxDepth, size_t maxOffset, size_t maxResults = POINTER_MAX_PATHS);
+  // Address reached by the path, false if it is broken
+  bool resolve(const PointerPath& path, Address& addr);
+
+  // Paths found in the first map, which lead to the target in all the maps
+  static vector<PointerPath> intersect(const vector<PointerMap*>& maps, size_t maxDepth, size_t maxOffset);
+
+private:
+  void unmap();
+  // Index of the file-backed map containing the address, -1 if none
+  int findStaticMap(Address addr);
+  string getModuleName(int index);
+
+  Maps maps;
+  Address target;
+  size_t count;
+  const PointerEntry* entries;
+  const uint32_t* byValue;
+
+  // Storage of "entries" and "byValue", when set in memory
+  vector<PointerEntry> ownEntries;
+  vector<uint32_t> ownByValue;
+  // Mapping of the file, when loaded
+  void* mapped;
+  size_t mappedSize;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef SCAN_HISTORY_HPP
+#define SCAN_HISTORY_HPP
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include "med/MedTypes.hpp"
+#include "mem/MemList.hpp"
+
+using namespace std;
+
+const size_t SCAN_HISTORY_MAX = 32;
+
+/**
+ * Results of the scans and filters of a named scan, for undo and redo.
+ * The result of a scan is kept as the base. The result of a filter, which is a subset of the previous one by address,
+ * is kept as the bitmap of the base elements it has, and shares the base with the previous one.
+ * The bitmap is indexed by the position in the base. A base which is not sorted by address, like a scan result
+ * of many addresses, keeps the positions in address order, as the filter results are sorted by address.
+ * The values which the filter result remembers are kept with the bitmap, as the filters compare the next values
+ * with them. Restoring a filter result makes the elements at the kept addresses of the base, with those values,
+ * without reading the memory.
+ */
+class ScanHistory {
+public:
+  ScanHistory();
+  // Add the result after the current one, dropping the ones which are undone.
+  // The list is capped if the scanner kept more results than it has, see CANDIDATE_LIST_MAX.
+  void push(MemList& list, const string& scanType, bool capped = false);
+  void clear();
+  bool canUndo();
+  bool canRedo();
+  // Whether the previous or the next result is capped, restoring it would lose the results beyond the list
+  bool isCapped(bool backward);
+  // Move to the previous or the next result, false if there is none
+  bool undo(MemList& list, string& scanType);
+  bool redo(MemList& list, string& scanType);
+  size_t size();
+  // Bytes of the bitmaps and the values, the bases are shared with the lists
+  size_t getMemoryUsage();
+
+private:
+  struct Entry {
+    MemList base;
+    vector<uint64_t> kept; // Bit of every element of the base, empty for the base itself
+    shared_ptr<vector<size_t>> order; // Positions of the base by address, null if the base is sorted
+    vector<Byte> values; // Remembered value of every kept element, empty if they remember none
+    size_t valueSize;
+    size_t count;
+    string scanType;
+    bool capped;
+  };
+
+  // Position in the base of the element at the index in address order
+  static size_t basePosition(Entry& entry, size_t index);
+
+  // Bitmap of the list over the base of the entry, false if the list is not a subset of the entry
+  bool makeKept(Entry& entry, MemList& list, vector<uint64_t>& kept);
+  void saveValues(MemList& list, Entry& entry);
+  void restore(Entry& entry, MemList& list, string& scanType);
+
+  deque<Entry> entries;
+  size_t current; // Index of the current entry, valid when not empty
+};
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef SCAN_JOB_HPP
+#define SCAN_JOB_HPP
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mem/Mem.hpp"
+#include "mem/ScanProgress.hpp"
+
+using namespace std;
+
+const size_t SCAN_JOB_BATCH_SIZE = 800;
+
+enum class ScanJobStatus { Running, Done, Cancelled, Failed };
+
+// Handle of a scan or filter running in background.
+// Callbacks are called from the job thread. If a callback is set after the job finished,
+// it is called immediately on the caller thread.
+// The results are passed in batches while the scan finds them, from the scanner threads, one batch
+// at a time. Without a batch callback, they are queued until the polling side takes them.
+class ScanJob {
+public:
+  typedef std::function<vector<MemPtr>()> Task;
+  typedef std::function<void(const vector<MemPtr>&)> BatchCallback;
+  typedef std::function<void(ScanJob&)> CompleteCallback;
+
+  ScanJob(ScanProgress& progress, Task task);
+  ~ScanJob();
+
+  void start();
+  void wait();
+  void cancel();
+
+  ScanJobStatus getStatus();
+  bool isDone();
+  ScanProgress& getProgress();
+  string getError();
+  vector<MemPtr> getResults();
+  // The results found since the last call, if there is no batch callback
+  vector<MemPtr> takeFound();
+
+  void setOnBatch(BatchCallback callback, size_t batchSize = SCAN_JOB_BATCH_SIZE);
+  void setOnComplete(CompleteCallback callback);
+
+private:
+  void run();
+  // Called by the scanner threads, while the task runs
+  void addFound(const vector<MemPtr>& found);
+  // Pass the full batches found to the callback, or all of them if the task is over
+  void flushFound(bool all);
+  void deliverBatches(BatchCallback& callback, size_t batchSize);
+
+  ScanProgress& progress;
+  Task task;
+  std::thread* thread;
+  std::mutex mutex;
+  std::mutex batchMutex; // The batches are delivered one at a time
+  ScanJobStatus status;
+  string error;
+  vector<MemPtr> results;
+  vector<MemPtr> found;
+  size_t foundCount;
+
+  BatchCallback onBatch;
+  size_t batchSize;
+  CompleteCallback onComplete;
+};
+
+typedef std::shared_ptr<ScanJob> ScanJobPtr;
+
+#endif
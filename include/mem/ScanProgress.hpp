@@ -0,0 +1,62 @@
+#ifndef SCAN_PROGRESS_HPP
+#define SCAN_PROGRESS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "mem/Mem.hpp"
+
+// Progress and cancellation token shared by the scanner tasks.
+// The tasks update the counters, while the UI polls them from another thread.
+class ScanProgress {
+public:
+  typedef std::function<void(const std::vector<MemPtr>&)> FoundCallback;
+
+  ScanProgress();
+
+  // Clear the counters and the cancellation, before a new scan or filter
+  void reset();
+  // A cancellation requested before start() is kept
+  void start(size_t bytesTotal);
+  // Start the task which runs for the seconds, like a watch. Its fraction is the elapsed time.
+  void startTimed(double seconds);
+  void finish();
+  bool isRunning();
+
+  void cancel();
+  bool isCancelled();
+
+  void addBytesScanned(size_t bytes);
+  void addPagesSkipped(size_t pages = 1);
+  void addHits(size_t hits = 1);
+  // The results found so far are passed to the callback, if any, while the scan runs
+  void addFound(const std::vector<MemPtr>& found);
+  void setOnFound(FoundCallback callback);
+
+  size_t getBytesTotal();
+  size_t getBytesScanned();
+  size_t getPagesSkipped();
+  size_t getHits();
+
+  double getFraction();
+  double getElapsedSeconds();
+  double getEtaSeconds(); // Negative if cannot be estimated yet
+
+private:
+  std::atomic<size_t> bytesTotal;
+  std::atomic<size_t> bytesScanned;
+  std::atomic<size_t> pagesSkipped;
+  std::atomic<size_t> hits;
+  std::atomic<bool> cancelled;
+  std::atomic<bool> running;
+  std::atomic<int64_t> startTime; // Ticks of the steady clock, read by the UI thread
+  std::atomic<double> duration; // Seconds of the timed task, 0 for a scan
+  std::mutex foundMutex;
+  FoundCallback onFound;
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef SCAN_RANGES_HPP
+#define SCAN_RANGES_HPP
+
+#include <string>
+#include <vector>
+
+#include "med/MedTypes.hpp"
+#include "mem/Maps.hpp"
+
+/**
+ * Set of address intervals and module names which restrict the scan.
+ * Modules are matched by the map pathname or its file name, such as "libgame.so" or "[heap]".
+ * "anon" matches the anonymous maps.
+ */
+class ScanRanges {
+public:
+  ScanRanges();
+
+  // Parse the ranges separated by space or comma, such as "7f001000-7f002000 libgame.so [heap] anon"
+  static ScanRanges parse(const string& spec);
+
+  void addInterval(Address start, Address end);
+  void addModule(const string& name);
+  void clear();
+  bool isEmpty();
+
+  AddressPairs& getIntervals();
+  vector<string>& getModules();
+
+  // Parts of the maps covered by the ranges, sorted and merged
+  Maps apply(Maps& maps);
+  string toString();
+
+private:
+  bool matchModule(Maps& maps, int index);
+  AddressPairs intervals;
+  vector<string> modules;
+};
+
+#endif
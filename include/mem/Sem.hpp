@@ -1,5 +1,6 @@
 #include "mem/Pem.hpp"
 #include "mem/MemIO.hpp"
+#include "med/Signature.hpp"
 
 // This is Sem (Saved/stored process mEMory). Derived from Pem
 class Sem : public Pem {
@@ -17,6 +18,10 @@ public:
   string& getLockedValue();
   void lockValue();
 
+  // Pattern to find the address again, empty if not generated
+  Signature& getSignature();
+  void setSignature(const Signature& signature);
+
   static std::shared_ptr<Sem> clone(shared_ptr<Sem> semPtr);
   static std::shared_ptr<Sem> convertToSemPtr(PemPtr);
 
@@ -24,6 +29,7 @@ private:
   bool locked;
   string description;
   string lockedValue;
+  Signature signature;
 };
 
 typedef std::shared_ptr<Sem> SemPtr;
@@ -0,0 +1,85 @@
+#ifndef VALUE_RECORDER_HPP
+#define VALUE_RECORDER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "med/MedTypes.hpp"
+#include "mem/MemIO.hpp"
+
+using namespace std;
+
+const double RECORDER_RATE_MAX = 1000; // Samples per second
+const double RECORDER_DEFAULT_RATE = 100;
+const size_t RECORDER_TRACKS_MAX = 64; // One bit of the failed mask for each
+const size_t RECORDER_CAPACITY = 1 << 16; // Samples kept, the oldest are overwritten
+const char RECORDER_MAGIC[8] = { 'M', 'E', 'D', 'R', 'E', 'C', '1', 0 };
+
+// Stored address to record, with the type of its value
+struct RecorderTrack {
+  Address address;
+  string scanType;
+  string description;
+};
+
+struct RecorderSample {
+  int64_t timeUs; // Since the recording started
+  uint64_t failed; // Bit of every track which is not read
+  vector<double> values;
+};
+
+/**
+ * Record the values of the stored addresses at up to 1 kHz, on its own thread, to plot and export them.
+ * Every sample reads all the tracks in one batch. The samples are in a ring, which the recording thread writes
+ * and the others read without locking; a sample overwritten while it is read is dropped by the reader.
+ */
+class ValueRecorder {
+public:
+  explicit ValueRecorder(MemIO* memio, size_t capacity = RECORDER_CAPACITY);
+  ~ValueRecorder();
+
+  // Throw if it is recording, or the type of a track cannot be recorded
+  void setTracks(const vector<RecorderTrack>& tracks);
+  vector<RecorderTrack>& getTracks();
+  // Clear the samples and record at the rate per second
+  void start(double rate = RECORDER_DEFAULT_RATE);
+  void stop();
+  bool isRunning();
+  double getRate();
+  // Number of the samples recorded since the start, including the overwritten ones
+  size_t getRecorded();
+  // The latest samples, at most "max", oldest first
+  vector<RecorderSample> getSamples(size_t max = SIZE_MAX);
+
+  // Save after stop(). A row of every sample, the time in milliseconds and the value of every track,
+  // empty if it is not read.
+  void saveCsv(const string& filename);
+  // The magic, the tracks, then the samples as the time, the failed mask and the raw value of every track
+  void saveBinary(const string& filename);
+
+  static double toDouble(uint64_t raw, ScanType type);
+
+private:
+  void run();
+  void record(vector<MemRequest>& requests, vector<uint64_t>& raws, int64_t timeUs);
+
+  MemIO* memio;
+  size_t capacity;
+  vector<RecorderTrack> tracks;
+  vector<ScanType> types;
+  std::unique_ptr<std::atomic<int64_t>[]> times;
+  std::unique_ptr<std::atomic<uint64_t>[]> failures;
+  std::unique_ptr<std::atomic<uint64_t>[]> values; // Track values of every slot, side by side
+  std::atomic<size_t> head; // Samples written, the next slot is head % capacity
+  std::atomic<bool> running;
+  std::thread* thread;
+  double rate;
+  chrono::steady_clock::time_point startTime;
+};
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef WATCHPOINT_HPP
+#define WATCHPOINT_HPP
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+#include "med/MedTypes.hpp"
+#include "mem/ScanProgress.hpp"
+
+using namespace std;
+
+const size_t WATCH_SLOTS = 4; // Debug registers DR0 to DR3
+const double WATCH_DEFAULT_SECONDS = 5;
+const int WATCH_POLL_US = 100; // Sleep when no thread is stopped
+
+// Aligned range of 1, 2, 4 or 8 bytes, watched by one debug register
+struct WatchRange {
+  Address address;
+  size_t size;
+};
+
+// Instruction which wrote the watched address
+struct WatchHit {
+  Address ip; // After the writing instruction, as the trap reports it
+  size_t count;
+  string module; // File name of the map, empty if it is not file-backed
+  Address offset; // From the base of the module
+
+  // "libgame.so+0x1f2a8", or the address if there is no module
+  string toString() const;
+};
+
+/**
+ * Find what writes to an address, with the x86 debug registers. Every thread of the process is attached,
+ * and the registers are set to trap on the writes, then the threads run. Only the thread which writes
+ * stops, for as long as its instruction pointer is counted, so the process keeps running at nearly full
+ * speed. The threads created meanwhile are watched too.
+ */
+class Watchpoint {
+public:
+  explicit Watchpoint(pid_t pid);
+
+  // Watch the writes of [address, address + size). Throw if it takes more than the free debug registers.
+  void add(Address address, size_t size);
+  vector<WatchRange>& getRanges();
+  // Collect the hits for the seconds, or until the progress is cancelled.
+  // The registers are cleared and the threads detached before return.
+  void watch(double seconds, ScanProgress& progress);
+  // The instructions which wrote, the most frequent first
+  vector<WatchHit> getHits();
+
+  // Value of DR7 which enables the write watch of the ranges
+  static uint64_t makeControl(const vector<WatchRange>& ranges);
+  static vector<pid_t> listThreads(pid_t pid);
+
+private:
+  struct Module {
+    Address start;
+    Address end;
+    Address base;
+    string name;
+  };
+
+  bool attach(pid_t tid);
+  void setRegisters(pid_t tid, uint64_t control);
+  // Count the hit, or take the thread created, or pass the signal to the process, then continue the thread
+  void handleStop(pid_t tid, int status, uint64_t control, ScanProgress& progress);
+  // Stop the thread, clear its registers and detach
+  void release(pid_t tid, ScanProgress& progress);
+  void loadModules();
+
+  pid_t pid;
+  vector<WatchRange> ranges;
+  set<pid_t> threads;
+  set<pid_t> starting; // Created, before the first stop
+  map<Address, size_t> counts; // By instruction pointer
+  vector<Module> modules;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef TIMELINE_HPP
+#define TIMELINE_HPP
+
+#include <vector>
+#include <QWidget>
+#include <QDoubleSpinBox>
+#include <QLabel>
+#include <QPushButton>
+#include <QTimer>
+
+#include "ui/Ui.hpp"
+#include "mem/MemEd.hpp"
+
+const int TIMELINE_REFRESH_MS = 100;
+const size_t TIMELINE_PLOT_SAMPLES = 4096; // Latest samples plotted
+
+// Plot of the recorded values, every track scaled to its own range
+class TimelinePlot : public QWidget {
+  Q_OBJECT
+
+public:
+  explicit TimelinePlot(ValueRecorder* recorder, QWidget* parent = NULL);
+
+protected:
+  void paintEvent(QPaintEvent* event);
+
+private:
+  ValueRecorder* recorder;
+};
+
+/**
+ * Window recording the values of the selected stored addresses, see ValueRecorder.
+ */
+class Timeline : public QWidget {
+  Q_OBJECT
+
+public:
+  explicit Timeline(MedUi* mainUi);
+
+  // Start recording the stored addresses by their rows
+  void record(const std::vector<int>& rows);
+
+private slots:
+  void onStartClicked();
+  void onStopClicked();
+  void onExportCsvClicked();
+  void onExportBinaryClicked();
+  void onTimerTimeout();
+
+private:
+  void exportRecording(bool binary);
+  void updateControls();
+
+  MemEd* med;
+  MedUi* mainUi;
+  std::vector<int> rows;
+
+  TimelinePlot* plot;
+  QDoubleSpinBox* rateSpin;
+  QPushButton* startButton;
+  QPushButton* stopButton;
+  QPushButton* csvButton;
+  QPushButton* binaryButton;
+  QLabel* statusLabel;
+  QTimer* timer;
+};
+
+#endif
@@ -58,6 +58,8 @@ public:
   void clearAll();
 
   void addScan(string scanType);
+  // Append the rows of the scans, without clearing
+  void appendScans(MemList& scans, string scanType);
 
   void refreshValues();
   void empty(); //including the med data
@@ -17,6 +17,9 @@
 #include <QStatusBar>
 #include <QPlainTextEdit>
 #include <QComboBox>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QTimer>
 
 #include "ui/TreeModel.hpp"
 #include "ui/StoreTreeModel.hpp"
@@ -24,12 +27,17 @@
 #include "mem/MemEd.hpp"
 
 const int REFRESH_RATE = 800;
+const int SCAN_PROGRESS_RATE = 200;
+const char SAMPLE_JOB_VALUE[] = "#"; // Value of the scan job which samples the changes
+const char WATCH_JOB_VALUE[] = "w"; // Value of the scan job which watches the writes
+const size_t WATCH_HITS_VISIBLE = 20;
 
 const QString MAIN_TITLE = "Med UI";
 
 enum UiState { Idle, Editing };
 
 class EncodingManager; // Forward declaration, because of recursive include
+class Timeline;
 
 class MedUi : public QObject {
   Q_OBJECT
@@ -45,6 +53,8 @@ public:
   QLineEdit* selectedProcessLine;
   QStatusBar* statusBar;
   QComboBox* scanTypeCombo;
+  QProgressBar* scanProgressBar;
+  QPushButton* cancelButton;
   QTreeView* scanTreeView;
   QTreeView* storeTreeView;
   QPlainTextEdit* notesArea;
@@ -80,6 +90,9 @@ private slots:
   void onProcessClicked();
   void onScanClicked();
   void onFilterClicked();
+  void onCancelClicked();
+  void onScanProgressTimeout();
+  void onScanJobFinished();
   void onPauseCheckboxClicked(bool checked);
 
   void onScanTreeViewClicked(const QModelIndex &index);
@@ -99,6 +112,8 @@ private slots:
 
   void onStoreNextClicked();
   void onStorePrevClicked();
+  void onStoreStrideClicked();
+  void onStoreSignatureClicked();
   void onStoreShiftClicked();
   void onStoreUnshiftClicked();
   void onStoreMoveClicked();
@@ -106,6 +121,7 @@ private slots:
   void onSaveAsTriggered();
   void onSaveTriggered();
   void onOpenTriggered();
+  void onOpenDumpTriggered();
   void onReloadTriggered();
   void onQuitTriggered();
   void onShowNotesTriggered(bool checked);
@@ -113,6 +129,9 @@ private slots:
   void onAutoRefreshTriggered(bool checked);
   void onRefreshTriggered();
   void onResumeProcessTriggered(bool checked);
+  void onSampleTriggered();
+  void onUndoScanTriggered();
+  void onRedoScanTriggered();
   void onFastScanTriggered(bool checked);
 
   void onNewAddressTriggered();
@@ -120,14 +139,18 @@ private slots:
   void onStoreClearTriggered();
 
   void onMemEditorTriggered();
+  void onTimelineTriggered();
+  void onFindWritesTriggered();
 
   void onScopeStartEdited();
   void onScopeEndEdited();
+  void onScanRangesEdited();
 
 private:
   void loadUiFiles();
   void loadProcessUi();
   void loadMemEditor();
+  void loadTimeline();
   void setupStatusBar();
   void setupScanTreeView();
   void setupStoreTreeView();
@@ -136,13 +159,27 @@ private:
 
   string getLastDigit();
 
+  void startScanJob(const string& scanValue, const string& scanType, bool isFilter);
+  void watchScanJob();
+  void moveInScanHistory(bool backward);
+  void showWatchHits();
+  void setScanControlsEnabled(bool enabled);
+
   QApplication* app;
   UiState scanState;
   UiState storeState;
   QWidget* memEditor;
+  Timeline* timeline;
 
   QString filename;
 
+  // Background scan or filter, its progress is polled by scanTimer
+  ScanJobPtr scanJob;
+  QTimer* scanTimer;
+  string scanJobValue;
+  string scanJobType;
+  bool scanJobPreview; // The table shows the results found so far, not the scans
+
   NamedScansController *namedScansController;
 };
 
@@ -0,0 +1,386 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <json/json.h>
+
+#include "med/MedException.hpp"
+#include "med/Metrics.hpp"
+#include "med/ScanCommand.hpp"
+#include "med/ScanParser.hpp"
+#include "mem/MemScanner.hpp"
+
+using namespace std;
+
+/**
+ * Benchmark of the scan engine against a synthetic child process.
+ * Arguments: [--heap-mb N] [--maps N] [--density D] [--mutation R] [--reads N] [--output FILE]
+ *            [--save-dump FILE] [--dump FILE] [--backend NAME]
+ * --save-dump saves the memory of the child as a dump. --dump runs against a saved dump instead of a child,
+ * which gives a deterministic benchmark, where the values are not mutated.
+ * --backend reads the child with the memory backend, instead of the probed one, see MemBackend.
+ */
+
+// "mark" in little endian, so that custom scan can search it as string
+const int32_t TARGET_VALUE = 0x6b72616d;
+const char* TARGET_COMMAND = "s:'mark'";
+
+struct BenchConfig {
+  size_t heapMb = 64;
+  int maps = 8;
+  double density = 0.001;   // Fraction of 8-byte slots holding the target value
+  double mutation = 0.1;    // Fraction of target values changed on each mutation
+  size_t reads = 10000;     // Number of MemIO reads for read benchmarks
+  string output;
+  string saveDump;
+  string dump;
+  string backend;           // Probed when empty
+};
+
+struct Child {
+  pid_t pid = 0; // 0 for the dump
+  int toChild;
+  int fromChild;
+  vector<pair<Address, size_t>> regions;
+};
+
+uint64_t xorshift(uint64_t& state) {
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return state;
+}
+
+void writeAll(int fd, const void* buf, size_t size) {
+  if (write(fd, buf, size) != (ssize_t)size) {
+    throw MedException("Benchmark: pipe write failed");
+  }
+}
+
+void readAll(int fd, void* buf, size_t size) {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t n = read(fd, (char*)buf + done, size - done);
+    if (n <= 0) throw MedException("Benchmark: pipe read failed");
+    done += n;
+  }
+}
+
+/**
+ * Child allocates the maps, fills them with random values and the target values,
+ * then mutates the target values on request.
+ */
+void runChild(const BenchConfig& config, int in, int out) {
+  size_t pageSize = getpagesize();
+  size_t mapSize = (config.heapMb * 1024 * 1024 / config.maps + pageSize - 1) / pageSize * pageSize;
+  uint64_t state = 0x9e3779b97f4a7c15ULL;
+
+  vector<int32_t*> targets;
+  vector<pair<Address, size_t>> regions;
+  for (int i = 0; i < config.maps; i++) {
+    void* ptr = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (ptr == MAP_FAILED) _exit(1);
+    regions.push_back(make_pair((Address)ptr, mapSize));
+
+    uint64_t* slots = (uint64_t*)ptr;
+    size_t count = mapSize / sizeof(uint64_t);
+    uint64_t threshold = (uint64_t)(config.density * (double)UINT64_MAX);
+    for (size_t j = 0; j < count; j++) {
+      if (xorshift(state) < threshold) {
+        slots[j] = 0;
+        int32_t* value = (int32_t*)&slots[j];
+        *value = TARGET_VALUE;
+        targets.push_back(value);
+        continue;
+      }
+      uint64_t random = xorshift(state);
+      if ((int32_t)random == TARGET_VALUE || (int32_t)(random >> 32) == TARGET_VALUE) random++;
+      slots[j] = random;
+    }
+  }
+
+  size_t count = regions.size();
+  writeAll(out, &count, sizeof(count));
+  writeAll(out, regions.data(), sizeof(regions[0]) * count);
+
+  char command;
+  while (read(in, &command, 1) == 1 && command != 'q') {
+    if (command == 'm') {
+      uint64_t threshold = (uint64_t)(config.mutation * (double)UINT64_MAX);
+      for (auto target : targets) {
+        if (xorshift(state) < threshold) (*target)++;
+      }
+      writeAll(out, "k", 1);
+    }
+  }
+  _exit(0);
+}
+
+Child spawnChild(const BenchConfig& config) {
+  int toChild[2], fromChild[2];
+  if (pipe(toChild) == -1 || pipe(fromChild) == -1) {
+    throw MedException("Benchmark: failed to create pipe");
+  }
+
+  pid_t pid = fork();
+  if (pid == -1) {
+    throw MedException("Benchmark: failed to fork");
+  }
+  if (pid == 0) {
+    close(toChild[1]);
+    close(fromChild[0]);
+    runChild(config, toChild[0], fromChild[1]);
+  }
+  close(toChild[0]);
+  close(fromChild[1]);
+
+  Child child;
+  child.pid = pid;
+  child.toChild = toChild[1];
+  child.fromChild = fromChild[0];
+
+  size_t count;
+  readAll(child.fromChild, &count, sizeof(count));
+  child.regions.resize(count);
+  readAll(child.fromChild, child.regions.data(), sizeof(child.regions[0]) * count);
+  return child;
+}
+
+void mutateChild(Child& child) {
+  if (!child.pid) return;
+  char ack;
+  writeAll(child.toChild, "m", 1);
+  readAll(child.fromChild, &ack, 1);
+}
+
+void stopChild(Child& child) {
+  writeAll(child.toChild, "q", 1);
+  close(child.toChild);
+  close(child.fromChild);
+  waitpid(child.pid, NULL, 0);
+}
+
+template<typename F>
+double timeIt(F fn) {
+  Metrics::getInstance().reset();
+  auto start = chrono::steady_clock::now();
+  fn();
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+Json::Value makeResult(const string& name, double seconds, size_t bytes, size_t candidates, size_t hits) {
+  Json::Value result;
+  result["name"] = name;
+  result["seconds"] = seconds;
+  result["bytes"] = (Json::UInt64)bytes;
+  result["candidates"] = (Json::UInt64)candidates;
+  result["hits"] = (Json::UInt64)hits;
+  result["gbPerSecond"] = seconds > 0 ? bytes / seconds / 1e9 : 0;
+  result["candidatesPerSecond"] = seconds > 0 ? candidates / seconds : 0;
+
+  Metrics& metrics = Metrics::getInstance();
+  for (int i = 0; i < (int)Counter::Size; i++) {
+    result["metrics"][Metrics::getCounterName((Counter)i)] = (Json::UInt64)metrics.get((Counter)i);
+  }
+  return result;
+}
+
+BenchConfig parseArgs(int argc, char** argv) {
+  BenchConfig config;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    string key = argv[i];
+    string value = argv[i + 1];
+    if (key == "--heap-mb") config.heapMb = stoul(value);
+    else if (key == "--maps") config.maps = max(1, stoi(value));
+    else if (key == "--density") config.density = stod(value);
+    else if (key == "--mutation") config.mutation = stod(value);
+    else if (key == "--reads") config.reads = stoul(value);
+    else if (key == "--output") config.output = value;
+    else if (key == "--save-dump") config.saveDump = value;
+    else if (key == "--dump") config.dump = value;
+    else if (key == "--backend") config.backend = value;
+    else throw MedException("Benchmark: unknown argument " + key);
+  }
+  return config;
+}
+
+void appendReadBenchmarks(Json::Value& results, const BenchConfig& config, Child& child, MemIO* memio,
+                          vector<MemPtr>& list, const string& suffix) {
+  // Value by value
+  size_t reads = min(config.reads, list.size());
+  double seconds = timeIt([&]() {
+    for (size_t i = 0; i < reads; i++) {
+      memio->read(list[i]->getAddress(), 4);
+    }
+  });
+  results.append(makeResult("memioSingleRead" + suffix, seconds, reads * 4, reads, reads));
+
+  // The same values in a single batch
+  vector<Byte> buffer(reads * 4);
+  vector<MemRequest> requests(reads);
+  for (size_t i = 0; i < reads; i++) {
+    requests[i] = MemRequest{ list[i]->getAddress(), buffer.data() + i * 4, 4, false };
+  }
+  size_t succeeded = 0;
+  seconds = timeIt([&]() {
+    succeeded = memio->readBatch(requests);
+  });
+  results.append(makeResult("memioBatchRead" + suffix, seconds, reads * 4, reads, succeeded));
+
+  // Page by page
+  size_t pageSize = getpagesize();
+  size_t pages = 0;
+  seconds = timeIt([&]() {
+    for (auto& region : child.regions) {
+      for (size_t offset = 0; offset < region.second && pages < config.reads; offset += pageSize) {
+        memio->read(region.first + offset, pageSize);
+        pages++;
+      }
+    }
+  });
+  results.append(makeResult("memioPageRead" + suffix, seconds, pages * pageSize, pages * pageSize / 4, pages));
+}
+
+Json::Value runBenchmarks(const BenchConfig& config, Child& child, string& backend) {
+  Json::Value results(Json::arrayValue);
+  MemScanner scanner(child.pid);
+  if (config.backend.size()) {
+    scanner.getMemIO()->setBackend(config.backend);
+  }
+  if (config.dump.size()) {
+    scanner.openDump(config.dump);
+    Maps maps = scanner.getMemIO()->getMaps();
+    for (auto& pair : maps.getMaps()) {
+      child.regions.push_back(make_pair(std::get<0>(pair), (size_t)(std::get<1>(pair) - std::get<0>(pair))));
+    }
+  }
+  else if (config.saveDump.size()) {
+    Maps maps;
+    for (auto& region : child.regions) {
+      maps.push(AddressPair(region.first, region.first + region.second));
+    }
+    MemDump::save(scanner.getMemIO(), maps, config.saveDump);
+  }
+  ScanProgress& progress = scanner.getProgress();
+
+  auto buffer = ScanParser::valueToBytes(to_string(TARGET_VALUE), SCAN_TYPE_INT_32);
+  Operands operands(std::vector<SizedBytes>{ buffer });
+  vector<MemPtr> list, filtered;
+
+  double seconds = timeIt([&]() {
+    list = scanner.scan(operands, 4, SCAN_TYPE_INT_32, ScanParser::OpType::Eq);
+  });
+  results.append(makeResult("scanByMaps", seconds, progress.getBytesTotal(), progress.getBytesTotal() / 4, list.size()));
+
+  mutateChild(child);
+  seconds = timeIt([&]() {
+    filtered = scanner.filter(list, operands, 4, SCAN_TYPE_INT_32, ScanParser::OpType::Eq);
+  });
+  results.append(makeResult("filter", seconds, list.size() * 4, list.size(), filtered.size()));
+
+  mutateChild(child);
+  seconds = timeIt([&]() {
+    filtered = scanner.filterUnknown(list, SCAN_TYPE_INT_32, ScanParser::OpType::Gt);
+  });
+  results.append(makeResult("filterUnknown", seconds, list.size() * 4, list.size(), filtered.size()));
+
+  seconds = timeIt([&]() {
+    scanner.saveSnapshot(list);
+  });
+  size_t snapshotBytes = progress.getBytesTotal();
+  results.append(makeResult("saveSnapshot", seconds, snapshotBytes, 0, 0));
+
+  mutateChild(child);
+  seconds = timeIt([&]() {
+    filtered = scanner.filterUnknown(list, SCAN_TYPE_INT_32, ScanParser::OpType::Gt);
+  });
+  results.append(makeResult("filterSnapshot", seconds, snapshotBytes, snapshotBytes / 4, filtered.size()));
+
+  ScanCommand scanCommand(TARGET_COMMAND);
+  seconds = timeIt([&]() {
+    filtered = scanner.scan(scanCommand);
+  });
+  results.append(makeResult("scanCommand", seconds, progress.getBytesTotal(), progress.getBytesTotal() / 8, filtered.size()));
+
+  // MemIO reads with the probed backend, then with every backend, so that they can be compared
+  MemIO* memio = scanner.getMemIO();
+  backend = memio->getBackend()->getName();
+  appendReadBenchmarks(results, config, child, memio, list, "");
+  if (child.pid && config.backend.empty()) {
+    for (auto& name : MemBackend::getNames()) {
+      try {
+        memio->setBackend(name);
+      } catch (MedException& ex) {
+        cerr << ex.getMessage() << endl;
+        continue;
+      }
+      appendReadBenchmarks(results, config, child, memio, list, ":" + name);
+    }
+  }
+
+  return results;
+}
+
+int main(int argc, char** argv) {
+  BenchConfig config;
+  try {
+    config = parseArgs(argc, argv);
+  } catch (exception& ex) {
+    cerr << "Invalid argument: " << ex.what() << endl;
+    return -1;
+  } catch (MedException& ex) {
+    cerr << ex.getMessage() << endl;
+    return -1;
+  }
+
+  Json::Value root;
+  root["config"]["heapMb"] = (Json::UInt64)config.heapMb;
+  root["config"]["maps"] = config.maps;
+  root["config"]["density"] = config.density;
+  root["config"]["mutation"] = config.mutation;
+  root["config"]["reads"] = (Json::UInt64)config.reads;
+  root["config"]["dump"] = config.dump;
+
+  Child child;
+  string backend;
+  try {
+    if (config.dump.size()) {
+      root["results"] = runBenchmarks(config, child, backend);
+    } else {
+      child = spawnChild(config);
+      root["results"] = runBenchmarks(config, child, backend);
+      stopChild(child);
+    }
+  } catch (MedException& ex) {
+    cerr << ex.getMessage() << endl;
+    if (child.pid > 0) kill(child.pid, SIGKILL);
+    return -1;
+  }
+  root["config"]["backend"] = backend;
+
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "  ";
+  string json = Json::writeString(builder, root);
+  if (config.output.size()) {
+    ofstream ofs(config.output);
+    if (ofs.fail()) {
+      cerr << "Fail to open file " << config.output << endl;
+      return -1;
+    }
+    ofs << json << endl;
+  }
+  else {
+    cout << json << endl;
+  }
+  return 0;
+}
@@ -10,6 +10,7 @@
 #include <unistd.h>
 #include <signal.h>
 
+#include "med/MedException.hpp"
 #include "mem/StringUtil.hpp"
 #include "mem/MemScanner.hpp"
 #include "mem/MemEd.hpp"
@@ -17,6 +18,16 @@
 #define COMMAND_SCAN 1
 #define COMMAND_FILTER 2
 #define COMMAND_LIST 3
+#define COMMAND_METRICS 4
+#define COMMAND_RANGES 5
+#define COMMAND_GROUP 6
+#define COMMAND_POINTER 7
+#define COMMAND_DUMP 8
+#define COMMAND_BACKEND 9
+#define COMMAND_UNDO 10
+#define COMMAND_REDO 11
+#define COMMAND_SAMPLE 12
+#define COMMAND_WATCH 13
 
 using namespace std;
 
@@ -28,6 +39,16 @@ MemEd* memed;
 int interpretCommand(const string& command) {
   if (command == "s") return COMMAND_SCAN;
   else if (command == "f") return COMMAND_FILTER;
+  else if (command == "m") return COMMAND_METRICS;
+  else if (command == "r") return COMMAND_RANGES;
+  else if (command == "g") return COMMAND_GROUP;
+  else if (command == "p") return COMMAND_POINTER;
+  else if (command == "d") return COMMAND_DUMP;
+  else if (command == "b") return COMMAND_BACKEND;
+  else if (command == "u") return COMMAND_UNDO;
+  else if (command == "U") return COMMAND_REDO;
+  else if (command == "c") return COMMAND_SAMPLE;
+  else if (command == "w") return COMMAND_WATCH;
   return COMMAND_LIST;
 }
 
@@ -37,16 +58,149 @@ void scan(const string& value) {
 }
 
 void filter(const string& value) {
-  vector<MemPtr> mems = memed->filter(value, "int32");
-  printf("Filtered %zu\n", mems.size());
+  memed->filter(value, "int32");
+  printf("Filtered %zu\n", memed->getScanCount());
+}
+
+void showMetrics() {
+  cout << memed->getMetrics().getSummary() << endl;
+}
+
+void setRanges(const string& ranges) {
+  try {
+    memed->setScanRanges(ranges);
+    cout << "Scan ranges: " << memed->getScanRanges() << endl;
+  } catch (MedException& ex) {
+    cerr << ex.getMessage() << endl;
+  }
+}
+
+void scanGroup(const string& value) {
+  try {
+    memed->scan(value, SCAN_TYPE_GROUP);
+  } catch (MedException& ex) {
+    cerr << ex.getMessage() << endl;
+    return;
+  }
+  auto matches = memed->getGroupMatches();
+  for (auto& match : matches) {
+    cout << intToHex(match.anchor);
+    for (size_t i = 1; i < match.offsets.size(); i++) {
+      cout << "\t" << showpos << match.offsets[i] << noshowpos;
+    }
+    cout << endl;
+  }
+  printf("Groups %zu\n", matches.size());
+}
+
+// "p save <target> <file>" saves the pointer map of this run,
+// "p find <depth> <offset> <file>..." prints the paths valid in all the runs
+void pointerMap(const vector<string>& args) {
+  try {
+    if (args.size() == 4 && args[1] == "save") {
+      memed->savePointerMap(hexToInt(args[2]), args[3]);
+      cout << "Saved " << args[3] << endl;
+      return;
+    }
+    if (args.size() >= 5 && args[1] == "find") {
+      vector<string> filenames(args.begin() + 4, args.end());
+      auto paths = memed->findPointerPaths(filenames, stoul(args[2]), stoul(args[3], nullptr, 0));
+      for (auto& path : paths) {
+        cout << path.toString() << endl;
+      }
+      printf("Paths %zu\n", paths.size());
+      return;
+    }
+    cerr << "Usage: p save <target> <file> | p find <depth> <offset> <file>..." << endl;
+  } catch (MedException& ex) {
+    cerr << ex.getMessage() << endl;
+  } catch (exception& ex) {
+    cerr << ex.what() << endl;
+  }
+}
+
+void saveDump(const string& filename) {
+  try {
+    memed->saveDump(filename);
+    cout << "Saved " << filename << endl;
+  } catch (MedException& ex) {
+    cerr << ex.getMessage() << endl;
+  }
+}
+
+void memBackend(const vector<string>& args) {
+  try {
+    if (args.size() > 1) {
+      memed->setMemBackend(args[1]);
+    }
+    cout << "Memory access: " << memed->getMemBackend() << endl;
+  } catch (MedException& ex) {
+    cerr << ex.getMessage() << endl;
+  }
+}
+
+// "u" goes back to the result before the last filter, "U" forward again
+void moveInHistory(bool backward) {
+  try {
+    bool moved = backward ? memed->undoScan() : memed->redoScan();
+    if (!moved) {
+      cerr << (backward ? "Nothing to undo" : "Nothing to redo") << endl;
+      return;
+    }
+    printf("Scans %zu\n", memed->getScanCount());
+  } catch (MedException& ex) {
+    cerr << ex.getMessage() << endl;
+  }
+}
+
+// "c [seconds] [rate]" counts the changes of the scans, which are filtered by "f #>=20"
+void sample(const vector<string>& args) {
+  try {
+    double seconds = args.size() > 1 ? stod(args[1]) : SAMPLE_DEFAULT_SECONDS;
+    double rate = args.size() > 2 ? stod(args[2]) : SAMPLE_DEFAULT_RATE;
+    memed->sample(seconds, rate);
+    printf("Sampled %zu times\n", memed->getSampler().getSamples());
+  } catch (MedException& ex) {
+    cerr << ex.getMessage() << endl;
+  } catch (exception& ex) {
+    cerr << ex.what() << endl;
+  }
+}
+
+// "w <address> [seconds] [size]" prints the instructions which write the address, the most frequent first
+void watchWrites(const vector<string>& args) {
+  if (args.size() < 2) {
+    cerr << "Usage: w <address> [seconds] [size]" << endl;
+    return;
+  }
+  try {
+    double seconds = args.size() > 2 ? stod(args[2]) : WATCH_DEFAULT_SECONDS;
+    size_t size = args.size() > 3 ? stoul(args[3]) : 4;
+    auto hits = memed->watchWrites(hexToInt(args[1]), size, seconds);
+    for (auto& hit : hits) {
+      cout << hit.count << "\t" << hit.toString() << "\t" << intToHex(hit.ip) << endl;
+    }
+    printf("Writers %zu\n", hits.size());
+  } catch (MedException& ex) {
+    cerr << ex.getMessage() << endl;
+  } catch (exception& ex) {
+    cerr << ex.what() << endl;
+  }
 }
 
 void showList() {
   auto scans = memed->getScans();
+  // The change count and the range of the values, if the scans are sampled
+  ChangeSampler& sampler = memed->getSampler();
+  bool sampled = sampler.getSamples() && &sampler.getList().getList() == &scans.getList();
   for (size_t i = 0; i < scans.size(); i++) {
     cout << scans.getAddressAsString(i) << "\t";
     scans.dump(i, false);
-    cout << scans.getValue(i) << endl;
+    cout << scans.getValue(i);
+    if (sampled) {
+      cout << "\t" << sampler.getChanges(i) << " [" << sampler.getMin(i) << ", " << sampler.getMax(i) << "]";
+    }
+    cout << endl;
   }
 }
 
@@ -62,6 +216,35 @@ void interpretLine(string command) {
   else if (cmd == COMMAND_FILTER) {
     filter(splitted[1]);
   }
+  else if (cmd == COMMAND_METRICS) {
+    showMetrics();
+  }
+  else if (cmd == COMMAND_RANGES) {
+    size_t space = command.find(' ');
+    setRanges(space == string::npos ? "" : command.substr(space + 1));
+  }
+  else if (cmd == COMMAND_GROUP) {
+    size_t space = command.find(' ');
+    scanGroup(space == string::npos ? "" : command.substr(space + 1));
+  }
+  else if (cmd == COMMAND_POINTER) {
+    pointerMap(splitted);
+  }
+  else if (cmd == COMMAND_DUMP && splitted.size() > 1) {
+    saveDump(splitted[1]);
+  }
+  else if (cmd == COMMAND_BACKEND) {
+    memBackend(splitted);
+  }
+  else if (cmd == COMMAND_SAMPLE) {
+    sample(splitted);
+  }
+  else if (cmd == COMMAND_WATCH) {
+    watchWrites(splitted);
+  }
+  else if (cmd == COMMAND_UNDO || cmd == COMMAND_REDO) {
+    moveInHistory(cmd == COMMAND_UNDO);
+  }
   else {
     showList();
   }
@@ -81,13 +264,28 @@ void handler(int sig) {
 int main(int argc, char** argv) {
   if (argc < 2) {
     cerr << "Missing argument\n"
-      "Usage: med-cli [pid]" << endl;
+      "Usage: med-cli [pid | dump file] [trace file]" << endl;
     return -1;
   }
   signal(SIGSEGV, handler);
 
-  g_pid = stol(string(argv[1]));
-  memed = new MemEd(g_pid);
+  // Memory dump or core file is scanned offline
+  string target = argv[1];
+  if (target.find_first_not_of("0123456789") != string::npos) {
+    memed = new MemEd();
+    try {
+      memed->openDump(target);
+    } catch (MedException& ex) {
+      cerr << ex.getMessage() << endl;
+      return -1;
+    }
+  } else {
+    g_pid = stol(target);
+    memed = new MemEd(g_pid);
+  }
+  if (argc > 2) {
+    memed->setTraceFile(argv[2]);
+  }
 
   char shellPrompt[PROMPT_BUFFER];
   cout << "Med CLI" <<endl;
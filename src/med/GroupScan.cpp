@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <cstring>
+
+#include "med/GroupScan.hpp"
+#include "med/MedCommon.hpp"
+#include "med/MedException.hpp"
+#include "mem/StringUtil.hpp"
+
+using namespace std;
+
+GroupScan::GroupScan(const string& s) {
+  span = GROUP_DEFAULT_SPAN;
+  for (auto& item : StringUtil::split(s, ',')) {
+    string token = StringUtil::trim(item);
+    if (token.empty()) continue;
+
+    string scanType = SCAN_TYPE_INT_32;
+    string value = token;
+    size_t colon = token.find(':');
+    if (colon != string::npos) {
+      scanType = StringUtil::trim(token.substr(0, colon));
+      value = StringUtil::trim(token.substr(colon + 1));
+    }
+
+    if (scanType == "span") {
+      try {
+        span = stoul(value);
+      } catch (exception& ex) {
+        throw MedException("Invalid group span: " + value);
+      }
+      continue;
+    }
+
+    int size = scanTypeToSize(scanType);
+    if (size <= 0 || scanType == SCAN_TYPE_STRING) {
+      throw MedException("Group scan does not support type: " + scanType);
+    }
+    GroupMember member;
+    member.scanType = scanType;
+    member.value.resize(size);
+    stringToMemory(value, scanType, member.value.data());
+    members.push_back(member);
+  }
+
+  if (members.empty()) {
+    throw MedException("Group scan requires at least one value");
+  }
+  step = members[0].value.size();
+  for (auto& member : members) {
+    step = min(step, member.value.size());
+  }
+}
+
+vector<GroupMember>& GroupScan::getMembers() {
+  return members;
+}
+
+size_t GroupScan::getSpan() {
+  return span;
+}
+
+const string& GroupScan::getAnchorType() {
+  return members[0].scanType;
+}
+
+void GroupScan::scan(const Byte* buf, size_t length, Address bufferStart,
+                     Address from, Address to, vector<GroupMatch>& matches) {
+  // One pass over the buffer, collecting the positions of every member
+  vector<vector<Address>> positions(members.size());
+  Address alignedStart = (bufferStart + step - 1) / step * step;
+  for (Address addr = alignedStart; addr < bufferStart + length; addr += step) {
+    size_t offset = addr - bufferStart;
+    for (size_t m = 0; m < members.size(); m++) {
+      size_t size = members[m].value.size();
+      if (addr % size != 0 || offset + size > length) continue;
+      if (memcmp(buf + offset, members[m].value.data(), size) == 0) {
+        positions[m].push_back(addr);
+      }
+    }
+  }
+
+  for (auto anchor : positions[0]) {
+    if (anchor < from || anchor >= to) continue;
+
+    GroupMatch match;
+    match.anchor = anchor;
+    match.offsets.push_back(0);
+    vector<Address> used = { anchor };
+    for (size_t m = 1; m < members.size(); m++) {
+      // First position in the window which is not taken by another member
+      Address low = anchor >= span ? anchor - span : 0;
+      Address high = anchor + span;
+      auto it = lower_bound(positions[m].begin(), positions[m].end(), low);
+      for (; it != positions[m].end() && *it + members[m].value.size() <= high; ++it) {
+        if (find(used.begin(), used.end(), *it) == used.end()) break;
+      }
+      if (it == positions[m].end() || *it + members[m].value.size() > high) break;
+
+      used.push_back(*it);
+      match.offsets.push_back((long)(*it - anchor));
+    }
+    if (match.offsets.size() == members.size()) {
+      matches.push_back(match);
+    }
+  }
+}
@@ -180,7 +180,11 @@ Maps getMaps(pid_t pid) {
 
   //Get the region from /proc/pid/maps
   char filename[128];
-  sprintf(filename,"/proc/%d/maps",pid);
+  if (pid) {
+    sprintf(filename, "/proc/%d/maps", pid);
+  } else {
+    sprintf(filename, "/proc/self/maps");
+  }
   FILE* file;
   file = fopen(filename,"r");
   if(!file) {
@@ -201,6 +205,7 @@ Maps getMaps(pid_t pid) {
   while (fgets(line, 255, file)) {
     //parse line
     //the empty pathname has to be scan also
+    fname[0] = '\0';
     if (sscanf(line, "%lx-%lx %c%c%c%c %8s %5s %u %127s",
               &start, &end,
               &rd, &wr, useless, &sp,
@@ -210,7 +215,7 @@ Maps getMaps(pid_t pid) {
 
     if (rd == 'r' && wr == 'w' && ((end - start) > 0)) {
       AddressPair pair(start, end);
-      maps.push(pair);
+      maps.push(pair, fname);
     }
   }
 
@@ -3,6 +3,9 @@
 #include <cinttypes>
 #include <string>
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
 
 #include <sys/ptrace.h> //ptrace()
 #include <sys/prctl.h> //prctl()
@@ -155,6 +158,12 @@ bool memCompare(const void* ptr1, size_t size1, const void* ptr2, size_t size2,
 }
 
 bool memCompare(const void* ptr, size_t size, Operands& operands, const ScanParser::OpType& op) {
+  if (ScanParser::isApproxOperator(op)) {
+    return memApprox(ptr, size, operands.getLowerBound(), operands.getUpperBound());
+  }
+  if (op == ScanParser::In) {
+    return operands.getValueSet()->contains(ptr);
+  }
   SizedBytes firstOperand = operands.getFirstOperand();
   if (op != ScanParser::Within) {
     return memCompare(ptr, firstOperand.getBytes(), size, op);
@@ -167,6 +176,153 @@ bool memWithin(const void* src, const void* low, const void* high, size_t size)
   return memGe(src, low, size) && memLe(src, high, size);
 }
 
+bool memApprox(const void* src, size_t size, double low, double up) {
+  double value;
+  if (size == sizeof(float)) {
+    float f;
+    memcpy(&f, src, sizeof(float));
+    value = f;
+  } else if (size == sizeof(double)) {
+    memcpy(&value, src, sizeof(double));
+  } else {
+    throw MedException("Approximate compare only supports float32 and float64");
+  }
+  return value >= low && value <= up;
+}
+
+// Compare a block of 64 values without branching, so that the compiler can vectorize it,
+// then only the matched bits are visited.
+template<typename T>
+static void approxScan(const Byte* buf, size_t length, size_t step,
+                       double low, double up, vector<size_t>& offsets) {
+  const size_t BLOCK = 64;
+  size_t count = length >= sizeof(T) ? (length - sizeof(T)) / step + 1 : 0;
+
+  for (size_t base = 0; base < count; base += BLOCK) {
+    size_t n = std::min(BLOCK, count - base);
+    uint64_t mask = 0;
+    for (size_t i = 0; i < n; i++) {
+      T value;
+      memcpy(&value, buf + (base + i) * step, sizeof(T));
+      double v = value;
+      mask |= (uint64_t)(v >= low && v <= up) << i;
+    }
+    while (mask) {
+      int bit = __builtin_ctzll(mask);
+      offsets.push_back((base + bit) * step);
+      mask &= mask - 1;
+    }
+  }
+}
+
+void memApproxScan(const Byte* buf, size_t length, size_t size, size_t step,
+                   double low, double up, vector<size_t>& offsets) {
+  if (size == sizeof(float)) {
+    approxScan<float>(buf, length, step, low, up, offsets);
+  } else if (size == sizeof(double)) {
+    approxScan<double>(buf, length, step, low, up, offsets);
+  } else {
+    throw MedException("Approximate scan only supports float32 and float64");
+  }
+}
+
+template<typename T>
+static bool deltaWithin(const void* newPtr, const void* oldPtr,
+                        double low, double up, const ScanParser::OpType& op) {
+  T newValue, oldValue;
+  memcpy(&newValue, newPtr, sizeof(T));
+  memcpy(&oldValue, oldPtr, sizeof(T));
+
+  // Signed, so that a value crossing zero changes by the distance. The difference is taken
+  // as unsigned, which cannot overflow.
+  double diff;
+  if constexpr (std::is_integral<T>::value) {
+    typedef typename std::make_unsigned<T>::type U;
+    diff = newValue >= oldValue ? (double)(U)((U)newValue - (U)oldValue) : -(double)(U)((U)oldValue - (U)newValue);
+  } else {
+    diff = (double)newValue - (double)oldValue;
+  }
+
+  if (op == ScanParser::DecreasedBy) {
+    diff = -diff;
+  } else if (op == ScanParser::ChangedByPercent) {
+    if (oldValue == 0) return false;
+    diff = std::fabs(diff) * 100 / std::fabs((double)oldValue);
+  }
+  return diff >= low && diff <= up;
+}
+
+template<typename T>
+static void gatherEq(const Byte* buf, const vector<size_t>& offsets, const Byte* operand,
+                     bool equal, vector<uint8_t>& matched) {
+  T value;
+  memcpy(&value, operand, sizeof(T));
+  size_t n = offsets.size();
+  matched.resize(n);
+  for (size_t i = 0; i < n; i++) {
+    T v;
+    memcpy(&v, buf + offsets[i], sizeof(T));
+    matched[i] = (v == value) == equal;
+  }
+}
+
+bool memGatherCompare(const Byte* buf, const vector<size_t>& offsets, size_t size,
+                      Operands& operands, const ScanParser::OpType& op, vector<uint8_t>& matched) {
+  if (op == ScanParser::In) {
+    ValueSet* set = operands.getValueSet();
+    matched.resize(offsets.size());
+    for (size_t i = 0; i < offsets.size(); i++) {
+      matched[i] = set->contains(buf + offsets[i]);
+    }
+    return true;
+  }
+  if ((op != ScanParser::Eq && op != ScanParser::Neq) || operands.count() == 0) return false;
+
+  SizedBytes operand = operands.getFirstOperand();
+  if (operand.getSize() < size) return false;
+
+  bool equal = op == ScanParser::Eq;
+  switch (size) {
+  case 1:
+    gatherEq<uint8_t>(buf, offsets, operand.getBytes(), equal, matched);
+    return true;
+  case 2:
+    gatherEq<uint16_t>(buf, offsets, operand.getBytes(), equal, matched);
+    return true;
+  case 4:
+    gatherEq<uint32_t>(buf, offsets, operand.getBytes(), equal, matched);
+    return true;
+  case 8:
+    gatherEq<uint64_t>(buf, offsets, operand.getBytes(), equal, matched);
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool memCompareDelta(const void* newPtr, const void* oldPtr, const ScanType& type,
+                     Operands& operands, const ScanParser::OpType& op) {
+  double low = operands.getLowerBound();
+  double up = operands.getUpperBound();
+  switch (type) {
+  case Int8:
+    return deltaWithin<int8_t>(newPtr, oldPtr, low, up, op);
+  case Int16:
+    return deltaWithin<int16_t>(newPtr, oldPtr, low, up, op);
+  case Int32:
+  case Ptr32:
+    return deltaWithin<int32_t>(newPtr, oldPtr, low, up, op);
+  case Ptr64:
+    return deltaWithin<int64_t>(newPtr, oldPtr, low, up, op);
+  case Float32:
+    return deltaWithin<float>(newPtr, oldPtr, low, up, op);
+  case Float64:
+    return deltaWithin<double>(newPtr, oldPtr, low, up, op);
+  default:
+    throw MedException("Change filter does not support " + scanTypeToString(type));
+  }
+}
+
 string memToString(Byte* memory, string scanType) {
   char str[MAX_STRING_SIZE];
   switch (stringToScanType(scanType)) {
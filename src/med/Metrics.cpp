@@ -0,0 +1,148 @@
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+#include "med/Metrics.hpp"
+#include "med/MedException.hpp"
+
+using namespace std;
+
+Metrics& Metrics::getInstance() {
+  static Metrics metrics;
+  return metrics;
+}
+
+Metrics::Metrics() {
+  tracing = false;
+  reset();
+}
+
+void Metrics::add(Counter counter, size_t value) {
+  counters[(int)counter].fetch_add(value, memory_order_relaxed);
+}
+
+size_t Metrics::get(Counter counter) {
+  return counters[(int)counter].load(memory_order_relaxed);
+}
+
+string Metrics::getCounterName(Counter counter) {
+  switch (counter) {
+  case Counter::BytesRead: return "bytesRead";
+  case Counter::Syscalls: return "syscalls";
+  case Counter::PtraceAttaches: return "ptraceAttaches";
+  case Counter::PagesFailed: return "pagesFailed";
+  case Counter::PagesSkipped: return "pagesSkipped";
+  case Counter::Hits: return "hits";
+  case Counter::Comparisons: return "comparisons";
+  case Counter::Allocations: return "allocations";
+  default: return "";
+  }
+}
+
+void Metrics::addPhase(const string& phase, long long startUs, long long durationUs) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& time = phases[phase];
+  time.totalUs += durationUs;
+  time.count++;
+
+  if (tracing) {
+    size_t threadId = std::hash<std::thread::id>()(std::this_thread::get_id());
+    events.push_back(TraceEvent{ phase, startUs, durationUs, threadId });
+  }
+}
+
+map<string, PhaseTime> Metrics::getPhases() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return phases;
+}
+
+void Metrics::setTracing(bool tracing) {
+  this->tracing = tracing;
+}
+
+bool Metrics::isTracing() {
+  return tracing;
+}
+
+Json::Value Metrics::getTrace() {
+  // Chrome trace event format, viewable with chrome://tracing
+  Json::Value root;
+  Json::Value traceEvents(Json::arrayValue);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto& event : events) {
+    Json::Value item;
+    item["name"] = event.name;
+    item["ph"] = "X";
+    item["ts"] = (Json::Int64)event.startUs;
+    item["dur"] = (Json::Int64)event.durationUs;
+    item["pid"] = 1;
+    item["tid"] = (Json::UInt64)(event.threadId % 100000);
+    traceEvents.append(item);
+  }
+  root["traceEvents"] = traceEvents;
+
+  for (int i = 0; i < (int)Counter::Size; i++) {
+    root["otherData"][getCounterName((Counter)i)] = (Json::UInt64)counters[i].load();
+  }
+  return root;
+}
+
+void Metrics::saveTrace(const string& filename) {
+  Json::Value root = getTrace();
+
+  ofstream ofs;
+  ofs.open(filename);
+  if (ofs.fail()) {
+    throw MedException(string("Save trace: Fail to open file ") + filename);
+  }
+  ofs << root << endl;
+  ofs.close();
+}
+
+long long Metrics::getNowUs() {
+  return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - epoch).count();
+}
+
+void Metrics::reset() {
+  for (int i = 0; i < (int)Counter::Size; i++) {
+    counters[i] = 0;
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  phases.clear();
+  events.clear();
+  epoch = chrono::steady_clock::now();
+}
+
+string Metrics::getSummary() {
+  char buf[256];
+  snprintf(buf, sizeof(buf),
+           "read %.1f MB, %zu syscalls, %zu attaches, %zu pages failed, %zu pages skipped, %zu hits, %zu comparisons, %zu allocations",
+           get(Counter::BytesRead) / (1024.0 * 1024.0),
+           get(Counter::Syscalls),
+           get(Counter::PtraceAttaches),
+           get(Counter::PagesFailed),
+           get(Counter::PagesSkipped),
+           get(Counter::Hits),
+           get(Counter::Comparisons),
+           get(Counter::Allocations));
+  string summary = buf;
+
+  // Phases of the worker tasks are summed across the threads
+  for (auto& pair : getPhases()) {
+    snprintf(buf, sizeof(buf), "; %s %.1f ms", pair.first.c_str(), pair.second.totalUs / 1000.0);
+    summary += buf;
+  }
+  return summary;
+}
+
+MetricsTimer::MetricsTimer(const char* phase) {
+  this->phase = phase;
+  startUs = Metrics::getInstance().getNowUs();
+}
+
+MetricsTimer::~MetricsTimer() {
+  Metrics& metrics = Metrics::getInstance();
+  metrics.addPhase(phase, startUs, metrics.getNowUs() - startUs);
+}
@@ -1,4 +1,5 @@
 #include <vector>
+#include <cstring>
 #include "med/Operands.hpp"
 #include "med/MedException.hpp"
 
@@ -28,3 +29,36 @@ SizedBytes Operands::getSecondOperand() {
 size_t Operands::getFirstSize() {
   return data[0].getSize();
 }
+
+Operands Operands::fromInterval(double low, double high) {
+  vector<SizedBytes> list = {
+    SizedBytes((Byte*)&low, sizeof(double)),
+    SizedBytes((Byte*)&high, sizeof(double))
+  };
+  return Operands(list);
+}
+
+Operands Operands::fromSet(std::vector<SizedBytes> values, size_t size) {
+  Operands operands(values);
+  operands.valueSet = std::make_shared<ValueSet>(values, size);
+  return operands;
+}
+
+ValueSet* Operands::getValueSet() {
+  if (!valueSet) {
+    throw MedException("Operands are not a value set");
+  }
+  return valueSet.get();
+}
+
+double Operands::getLowerBound() {
+  double value;
+  memcpy(&value, getFirstOperand().getBytes(), sizeof(double));
+  return value;
+}
+
+double Operands::getUpperBound() {
+  double value;
+  memcpy(&value, getSecondOperand().getBytes(), sizeof(double));
+  return value;
+}
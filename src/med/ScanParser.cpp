@@ -1,5 +1,8 @@
 #include <string>
+#include <cstring>
+#include <cmath>
 #include <regex>
+#include <algorithm>
 #include <vector>
 #include <sstream>
 #include <iostream>
@@ -43,6 +46,18 @@ ScanParser::OpType ScanParser::stringToOpType(const string &s) {
     return ScanParser::Ge;
   else if (s == "<>")
     return ScanParser::Within;
+  else if (s == "~")
+    return ScanParser::Approx;
+  else if (s == "~~")
+    return ScanParser::Truncated;
+  else if (s == "+=")
+    return ScanParser::IncreasedBy;
+  else if (s == "-=")
+    return ScanParser::DecreasedBy;
+  else if (s == "%=")
+    return ScanParser::ChangedByPercent;
+  else if (s == "in")
+    return ScanParser::In;
   return ScanParser::Eq;
 }
 
@@ -79,6 +94,13 @@ bool ScanParser::isValid(const string &v) {
   if (ScanParser::getOpType(v) == ScanParser::Within &&
       !ScanParser::isArray(v, ' '))
     return false;
+  if (ScanParser::getOpType(v) == ScanParser::In &&
+      ScanParser::getValue(v).find_first_not_of("{}, ") == string::npos)
+    return false;
+  if ((ScanParser::isApproxOperator(ScanParser::getOpType(v)) ||
+       ScanParser::isDeltaOperator(ScanParser::getOpType(v))) &&
+      !ScanParser::hasValues(v))
+    return false;
   return true;
 }
 
@@ -138,12 +160,26 @@ bool ScanParser::isSnapshotOperator(const OpType& opType) {
   return false;
 }
 
+bool ScanParser::isApproxOperator(const OpType& opType) {
+  return opType == Approx || opType == Truncated;
+}
+
+bool ScanParser::isDeltaOperator(const OpType& opType) {
+  return opType == IncreasedBy || opType == DecreasedBy || opType == ChangedByPercent;
+}
+
 Operands ScanParser::valueToOperands(const string& v, const string& t, OpType op) {
   SizedBytes bytes;
-  if (t == SCAN_TYPE_STRING) {
+  if (t == SCAN_TYPE_STRING && op != OpType::In) {
     bytes = stringToBytes(v);
+  } else if (isApproxOperator(op)) {
+    return getApproxOperands(v, t, op);
+  } else if (isDeltaOperator(op)) {
+    return getDeltaOperands(v);
   } else if (op == OpType::Within) {
     return getTwoOperands(v, t);
+  } else if (op == OpType::In) {
+    return getSetOperands(v, t);
   } else {
     bytes = numericToBytes(v, t);
   }
@@ -171,6 +207,118 @@ Operands ScanParser::getTwoOperands(const string& v, const string& t) {
   return Operands(list);
 }
 
+int ScanParser::getDecimalPlaces(const string& v) {
+  string value = StringUtil::trim(v);
+  size_t dot = value.find('.');
+  if (dot == string::npos) return 0;
+
+  int places = 0;
+  for (size_t i = dot + 1; i < value.size() && isdigit(value[i]); i++) {
+    places++;
+  }
+  return places;
+}
+
+Operands ScanParser::getApproxOperands(const string& v, const string& t, OpType op) {
+  if (t != SCAN_TYPE_FLOAT_32 && t != SCAN_TYPE_FLOAT_64) {
+    throw MedException("Approximate scan only supports float32 and float64");
+  }
+  vector<string> values = getValues(v, ' ');
+  if (values.size() == 0) {
+    throw MedException("Scan empty string");
+  }
+
+  double value;
+  try {
+    value = stod(values[0]);
+  } catch (exception& ex) {
+    throw MedException("Invalid float value: " + values[0]);
+  }
+
+  double low, high;
+  if (values.size() > 1) { // Epsilon, absolute or relative with "%"
+    string epsilonStr = values[1];
+    bool relative = epsilonStr.back() == '%';
+    if (relative) {
+      epsilonStr.pop_back();
+    }
+    double epsilon;
+    try {
+      epsilon = fabs(stod(epsilonStr));
+    } catch (exception& ex) {
+      throw MedException("Invalid epsilon: " + values[1]);
+    }
+    if (relative) {
+      epsilon = fabs(value) * epsilon / 100.0;
+    }
+    low = value - epsilon;
+    high = value + epsilon;
+  } else {
+    // Upper bound is exclusive, so step back one ulp to keep the interval closed
+    double unit = pow(10.0, -getDecimalPlaces(values[0]));
+    if (op == Truncated) {
+      low = value >= 0 ? value : nextafter(value - unit, value);
+      high = value >= 0 ? nextafter(value + unit, value) : value;
+    } else {
+      low = value - unit / 2;
+      high = nextafter(value + unit / 2, value);
+    }
+  }
+  return Operands::fromInterval(low, high);
+}
+
+Operands ScanParser::getDeltaOperands(const string& v) {
+  vector<string> values = getValues(v, ' ');
+  if (values.size() == 0) {
+    throw MedException("Scan empty string");
+  }
+
+  double bounds[2];
+  for (size_t i = 0; i < 2; i++) {
+    string value = values[std::min(i, values.size() - 1)];
+    try {
+      bounds[i] = stod(value);
+    } catch (exception& ex) {
+      throw MedException("Invalid delta value: " + value);
+    }
+  }
+  return Operands::fromInterval(std::min(bounds[0], bounds[1]), std::max(bounds[0], bounds[1]));
+}
+
+Operands ScanParser::getSetOperands(const string& v, const string& t) {
+  if (t == SCAN_TYPE_STRING || t == SCAN_TYPE_CUSTOM) {
+    throw MedException("Set scan does not support " + t);
+  }
+  string value = getValue(v);
+  if (value.size() < 2 || value.front() != '{' || value.back() != '}') {
+    throw MedException("Set should be in braces: " + value);
+  }
+  value = value.substr(1, value.size() - 2);
+  replace(value.begin(), value.end(), ',', ' ');
+
+  int length = scanTypeToSize(t);
+  vector<SizedBytes> list;
+  for (auto& item : StringUtil::split(value, ' ')) {
+    string str = StringUtil::trim(item);
+    if (str.empty()) continue;
+
+    BytePtr data(new Byte[length]);
+    stringToMemory(str, t, data.get());
+    list.push_back(SizedBytes(data, length));
+  }
+  if (list.empty()) {
+    throw MedException("Scan empty set");
+  }
+  return Operands::fromSet(list, length);
+}
+
+size_t ScanParser::getValueSize(Operands& operands, const string& t, OpType op) {
+  if (isApproxOperator(op) || isDeltaOperator(op) || op == In) {
+    return scanTypeToSize(t);
+  }
+  return operands.getFirstSize();
+}
+
 ScanCommand ScanParser::getScanCommand(const string& v) {
   return ScanCommand(v);
 }
@@ -0,0 +1,58 @@
+#include <cstdio>
+
+#include "med/Signature.hpp"
+
+using namespace std;
+
+Signature::Signature() {
+  offset = 0;
+}
+
+Signature::Signature(const string& pattern, long offset) {
+  this->pattern = pattern;
+  this->offset = offset;
+}
+
+Signature Signature::fromBytes(const Byte* bytes, const vector<bool>& wildcards, long offset) {
+  // The trailing wildcards do not change the match
+  size_t size = wildcards.size();
+  while (size > 0 && wildcards[size - 1]) {
+    size--;
+  }
+
+  string pattern;
+  size_t i = 0;
+  while (i < size) {
+    size_t j = i;
+    while (j < size && wildcards[j] == wildcards[i]) {
+      j++;
+    }
+    if (!pattern.empty()) {
+      pattern += ", ";
+    }
+    if (wildcards[i]) {
+      pattern += "w:" + to_string(j - i);
+    } else {
+      pattern += "b:";
+      for (size_t k = i; k < j; k++) {
+        char hex[3];
+        snprintf(hex, sizeof(hex), "%02x", bytes[k]);
+        pattern += hex;
+      }
+    }
+    i = j;
+  }
+  return Signature(pattern, offset);
+}
+
+const string& Signature::getPattern() {
+  return pattern;
+}
+
+long Signature::getOffset() {
+  return offset;
+}
+
+bool Signature::isEmpty() {
+  return pattern.empty();
+}
@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "med/StrideDetector.hpp"
+#include "med/MedCommon.hpp"
+#include "med/MedException.hpp"
+
+using namespace std;
+
+const double STRIDE_MIN_SCORE = 0.25;      // Repeating bytes of the best stride, among the non-zero bytes
+const double STRIDE_SUBMULTIPLE = 0.8;     // Smaller stride within this score of the best is preferred over its multiples
+const double STRIDE_MIN_SIMILARITY = 0.25; // Repeating bytes of an element compared to the anchor element
+const double STRIDE_VALUE_FACTOR = 16;
+const double STRIDE_VALUE_FLOOR = 256;
+const double STRIDE_POINTER_DISTANCE = 4294967296.0;
+
+namespace {
+  // Branch-free, so that the compiler vectorizes it
+  uint32_t countRepeats(const Byte* a, const Byte* b, size_t n) {
+    uint32_t count = 0;
+    for (size_t i = 0; i < n; i++) {
+      count += (a[i] == b[i]) & (a[i] != 0);
+    }
+    return count;
+  }
+
+  uint32_t countNonZero(const Byte* a, size_t n) {
+    uint32_t count = 0;
+    for (size_t i = 0; i < n; i++) {
+      count += a[i] != 0;
+    }
+    return count;
+  }
+
+  double toNumber(const Byte* value, const string& scanType) {
+    if (scanType == SCAN_TYPE_INT_8) {
+      int8_t v; memcpy(&v, value, sizeof(v)); return v;
+    } else if (scanType == SCAN_TYPE_INT_16) {
+      int16_t v; memcpy(&v, value, sizeof(v)); return v;
+    } else if (scanType == SCAN_TYPE_INT_32) {
+      int32_t v; memcpy(&v, value, sizeof(v)); return v;
+    } else if (scanType == SCAN_TYPE_FLOAT_32) {
+      float v; memcpy(&v, value, sizeof(v)); return v;
+    } else if (scanType == SCAN_TYPE_FLOAT_64) {
+      double v; memcpy(&v, value, sizeof(v)); return v;
+    } else if (scanType == SCAN_TYPE_PTR_32) {
+      uint32_t v; memcpy(&v, value, sizeof(v)); return v;
+    }
+    uint64_t v; memcpy(&v, value, sizeof(v)); return (double)v;
+  }
+}
+
+StrideDetector::StrideDetector(const string& scanType, size_t maxStride) {
+  int size = scanTypeToSize(scanType);
+  if (size <= 0 || scanType == SCAN_TYPE_STRING || scanType == SCAN_TYPE_CUSTOM || scanType == SCAN_TYPE_GROUP) {
+    throw MedException("Stride detection does not support type: " + scanType);
+  }
+  this->scanType = scanType;
+  this->size = size;
+  this->maxStride = max(maxStride, this->size);
+}
+
+const string& StrideDetector::getScanType() {
+  return scanType;
+}
+
+size_t StrideDetector::getMaxStride() {
+  return maxStride;
+}
+
+size_t StrideDetector::getExtent() {
+  return maxStride * STRIDE_MAX_INSTANCES;
+}
+
+size_t StrideDetector::findStride(const Byte* buf, size_t length, size_t anchorOffset) {
+  size_t window = maxStride * STRIDE_WINDOW_RECORDS;
+  size_t low = anchorOffset >= window ? anchorOffset - window : 0;
+  size_t high = min(length, anchorOffset + size + window);
+  const Byte* base = buf + low;
+  size_t n = high - low;
+
+  // Non-zero bytes before each position, so that the score of every shift is normalised by its own range
+  vector<uint32_t> nonZero(n + 1, 0);
+  for (size_t i = 0; i < n; i++) {
+    nonZero[i + 1] = nonZero[i] + (base[i] != 0);
+  }
+
+  vector<pair<size_t, double>> scores;
+  double best = 0;
+  for (size_t stride = size; stride <= maxStride && stride < n; stride += size) {
+    uint32_t total = nonZero[n - stride];
+    if (total == 0) continue;
+    double score = (double)countRepeats(base, base + stride, n - stride) / total;
+    scores.push_back(make_pair(stride, score));
+    best = max(best, score);
+  }
+  if (best < STRIDE_MIN_SCORE) return 0;
+
+  for (auto& score : scores) {
+    if (score.second >= best * STRIDE_SUBMULTIPLE) return score.first;
+  }
+  return 0;
+}
+
+bool StrideDetector::isPlausible(const Byte* value, const Byte* anchorValue) {
+  double v = toNumber(value, scanType);
+  double anchor = toNumber(anchorValue, scanType);
+  if (!std::isfinite(v)) return false;
+
+  if (scanType == SCAN_TYPE_PTR_32 || scanType == SCAN_TYPE_PTR_64) {
+    return v == 0 || fabs(v - anchor) <= STRIDE_POINTER_DISTANCE;
+  }
+  return fabs(v) <= max(fabs(anchor) * STRIDE_VALUE_FACTOR, STRIDE_VALUE_FLOOR);
+}
+
+bool StrideDetector::isSimilar(const Byte* buf, size_t length, size_t anchorOffset, size_t offset, size_t stride) {
+  // The element is taken as the stride centered on the value, as the start of the struct is unknown.
+  // The value itself differs between the elements, only the bytes around it are compared.
+  size_t half = (stride - size) / 2;
+  size_t before = min(half, min(anchorOffset, offset));
+  size_t after = min(stride - size - half, min(length - anchorOffset - size, length - offset - size));
+
+  uint32_t nonZero = countNonZero(buf + offset - before, before + size + after);
+  if (nonZero == 0) return false;
+
+  uint32_t total = countNonZero(buf + anchorOffset - before, before) +
+    countNonZero(buf + anchorOffset + size, after);
+  if (total == 0) return true;
+  uint32_t repeats = countRepeats(buf + anchorOffset - before, buf + offset - before, before) +
+    countRepeats(buf + anchorOffset + size, buf + offset + size, after);
+  return (double)repeats / total >= STRIDE_MIN_SIMILARITY;
+}
+
+StrideMatch StrideDetector::detect(const Byte* buf, size_t length, Address bufferStart, Address anchor) {
+  if (anchor < bufferStart || anchor + size > bufferStart + length) {
+    throw MedException("Stride anchor is out of the memory read");
+  }
+  StrideMatch match;
+  size_t anchorOffset = anchor - bufferStart;
+  match.stride = findStride(buf, length, anchorOffset);
+  match.addresses.push_back(anchor);
+  if (!match.stride) return match;
+
+  size_t stride = match.stride;
+  const Byte* anchorValue = buf + anchorOffset;
+  size_t offset = anchorOffset;
+  for (size_t i = 0; i < STRIDE_MAX_INSTANCES && offset >= stride; i++) {
+    offset -= stride;
+    if (!isPlausible(buf + offset, anchorValue) || !isSimilar(buf, length, anchorOffset, offset, stride)) break;
+    match.addresses.push_back(bufferStart + offset);
+  }
+  reverse(match.addresses.begin(), match.addresses.end());
+
+  offset = anchorOffset;
+  for (size_t i = 0; i < STRIDE_MAX_INSTANCES && offset + stride + size <= length; i++) {
+    offset += stride;
+    if (!isPlausible(buf + offset, anchorValue) || !isSimilar(buf, length, anchorOffset, offset, stride)) break;
+    match.addresses.push_back(bufferStart + offset);
+  }
+  return match;
+}
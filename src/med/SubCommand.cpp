@@ -1,8 +1,10 @@
+#include <cctype>
 #include <regex>
 
 #include "med/SubCommand.hpp"
 #include "med/ScanParser.hpp"
 #include "med/MemOperator.hpp"
+#include "med/MedException.hpp"
 #include "mem/StringUtil.hpp"
 
 string extractString(const string& s) {
@@ -29,6 +31,28 @@ int extractNumber(const string &s) {
   return 0;
 }
 
+// Hexadecimal bytes after "b:", such as "b:488b05"
+SizedBytes extractBytes(const string &s) {
+  string value = StringUtil::trim(s).substr(2);
+  string hex;
+  for (char c : value) {
+    if (isspace(c)) continue;
+    if (!isxdigit(c)) {
+      throw MedException("Invalid hexadecimal bytes: " + value);
+    }
+    hex += c;
+  }
+  if (hex.empty() || hex.size() % 2) {
+    throw MedException("Invalid hexadecimal bytes: " + value);
+  }
+
+  SizedBytes bytes = SizedBytes::create(hex.size() / 2);
+  for (size_t i = 0; i < bytes.getSize(); i++) {
+    bytes.getBytes()[i] = (Byte)stoi(hex.substr(i * 2, 2), nullptr, 16);
+  }
+  return bytes;
+}
+
 SubCommand::SubCommand(const string &s) {
   cmd = parseCmd(s);
   wildcardSteps = 0;
@@ -40,6 +64,8 @@ SubCommand::SubCommand(const string &s) {
     operands = ScanParser::valueToOperands(valueStr, SCAN_TYPE_STRING);
   } else if (cmd == Command::Wildcard) {
     wildcardSteps = extractNumber(s);
+  } else if (cmd == Command::Bytes) {
+    operands = Operands(vector<SizedBytes>{ extractBytes(s) });
   }
 }
 
@@ -67,6 +93,8 @@ SubCommand::Command SubCommand::parseCmd(const string& s) {
     return Command::Str;
   } else if (cmd == "w:") {
     return Command::Wildcard;
+  } else if (cmd == "b:") {
+    return Command::Bytes;
   }
   return Command::Noop;
 }
@@ -83,6 +111,7 @@ size_t SubCommand::getSize() {
   switch (cmd) {
   case Command::Noop:
   case Command::Str:
+  case Command::Bytes:
     return operands.getFirstSize();
   case Command::Wildcard:
     return wildcardSteps;
@@ -96,6 +125,7 @@ tuple<bool, int> SubCommand::match(Byte* address) {
   switch (cmd) {
   case Command::Noop:
   case Command::Str:
+  case Command::Bytes:
     matchResult = memCompare(address, size, operands, ScanParser::OpType::Eq);
     break;
   case Command::Wildcard:
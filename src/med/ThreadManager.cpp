@@ -19,6 +19,10 @@ void ThreadManager::setMaxThreads(int num) {
   maxThreads = num;
 }
 
+int ThreadManager::getMaxThreads() {
+  return maxThreads;
+}
+
 void ThreadManager::queueTask(TMTask* fn) {
   container.push_back(fn);
 }
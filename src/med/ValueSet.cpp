@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <cstring>
+
+#include "med/MedException.hpp"
+#include "med/ValueSet.hpp"
+
+using namespace std;
+
+const size_t SMALL_SET_SIZE = 16;
+const uint64_t HASH_MULTIPLIER = 0x9e3779b97f4a7c15ULL;
+
+ValueSet::ValueSet(const vector<SizedBytes>& operands, size_t size) {
+  if (size != 1 && size != 2 && size != 4 && size != 8) {
+    throw MedException("Value set only supports 1, 2, 4 and 8 bytes values");
+  }
+  this->size = size;
+  shift = 64;
+
+  for (auto bytes : operands) {
+    if (bytes.getSize() < size) {
+      throw MedException("Value set operand is smaller than the value size");
+    }
+    uint64_t value = 0;
+    memcpy(&value, bytes.getBytes(), size);
+    values.push_back(value);
+  }
+  sort(values.begin(), values.end());
+  values.erase(unique(values.begin(), values.end()), values.end());
+
+  if (size <= 2) {
+    bits.assign(((size_t)1 << (size * 8)) / 64, 0);
+    for (auto value : values) {
+      bits[value / 64] |= (uint64_t)1 << (value % 64);
+    }
+  }
+  else if (values.size() > SMALL_SET_SIZE) {
+    // Power of two table, at most half full
+    size_t capacity = 1;
+    while (capacity < values.size() * 2) {
+      capacity *= 2;
+      shift--;
+    }
+    table.assign(capacity, 0);
+    used.assign(capacity, 0);
+    for (auto value : values) {
+      insert(value);
+    }
+  }
+}
+
+size_t ValueSet::hash(uint64_t value) const {
+  return shift >= 64 ? 0 : (size_t)((value * HASH_MULTIPLIER) >> shift);
+}
+
+void ValueSet::insert(uint64_t value) {
+  size_t mask = table.size() - 1;
+  size_t i = hash(value);
+  while (used[i]) {
+    i = (i + 1) & mask;
+  }
+  table[i] = value;
+  used[i] = 1;
+}
+
+bool ValueSet::containsValue(uint64_t value) const {
+  if (bits.size()) {
+    return (bits[value / 64] >> (value % 64)) & 1;
+  }
+  if (table.empty()) {
+    bool found = false;
+    for (auto v : values) {
+      found |= v == value;
+    }
+    return found;
+  }
+
+  size_t mask = table.size() - 1;
+  for (size_t i = hash(value); used[i]; i = (i + 1) & mask) {
+    if (table[i] == value) return true;
+  }
+  return false;
+}
+
+bool ValueSet::contains(const void* ptr) const {
+  uint64_t value = 0;
+  memcpy(&value, ptr, size);
+  return containsValue(value);
+}
+
+size_t ValueSet::getSize() const {
+  return size;
+}
+
+size_t ValueSet::count() const {
+  return values.size();
+}
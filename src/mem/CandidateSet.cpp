@@ -0,0 +1,121 @@
+#include <cstring>
+#include <unistd.h>
+
+#include "mem/CandidateSet.hpp"
+#include "mem/Pem.hpp"
+
+using namespace std;
+
+CandidateSet::CandidateSet() {
+  count = 0;
+  valueSize = 0;
+  pageSize = getpagesize();
+}
+
+void CandidateSet::reset(size_t valueSize) {
+  clear();
+  this->valueSize = valueSize;
+}
+
+void CandidateSet::clear() {
+  vector<Page>().swap(pages);
+  count = 0;
+}
+
+bool CandidateSet::empty() {
+  return count == 0;
+}
+
+size_t CandidateSet::size() {
+  return count;
+}
+
+size_t CandidateSet::getValueSize() {
+  return valueSize;
+}
+
+size_t CandidateSet::getPageCount() {
+  return pages.size();
+}
+
+size_t CandidateSet::getDensePageCount() {
+  size_t dense = 0;
+  for (auto& page : pages) {
+    dense += page.dense;
+  }
+  return dense;
+}
+
+size_t CandidateSet::getMemoryUsage() {
+  size_t bytes = pages.capacity() * sizeof(Page);
+  for (auto& page : pages) {
+    bytes += page.bitmap.capacity() * sizeof(uint64_t) + page.deltas.capacity() + page.values.capacity();
+  }
+  return bytes;
+}
+
+void CandidateSet::addPage(Address addr, const vector<uint16_t>& offsets, const Byte* data) {
+  if (offsets.empty()) return;
+  pages.emplace_back();
+  makePage(pages.back(), addr, offsets, data);
+  count += offsets.size();
+}
+
+void CandidateSet::makePage(Page& page, Address addr, const vector<uint16_t>& offsets, const Byte* data) {
+  page.addr = addr;
+  page.count = offsets.size();
+  page.first = offsets.front();
+  page.last = offsets.back();
+
+  vector<uint8_t> deltas;
+  deltas.reserve(offsets.size());
+  size_t previous = 0;
+  for (auto offset : offsets) {
+    size_t delta = offset - previous;
+    previous = offset;
+    while (delta >= 0x80) {
+      deltas.push_back((uint8_t)(delta | 0x80));
+      delta >>= 7;
+    }
+    deltas.push_back((uint8_t)delta);
+  }
+
+  size_t sparseBytes = deltas.size() + offsets.size() * valueSize;
+  size_t denseBytes = pageSize / 8 + pageSize;
+  page.dense = denseBytes < sparseBytes;
+  if (page.dense) {
+    page.bitmap.assign((pageSize + 63) / 64, 0);
+    for (auto offset : offsets) {
+      page.bitmap[offset / 64] |= (uint64_t)1 << (offset % 64);
+    }
+    page.values.assign(data, data + pageSize);
+  } else {
+    deltas.shrink_to_fit();
+    page.deltas.swap(deltas);
+    page.values.resize(offsets.size() * valueSize);
+    for (size_t i = 0; i < offsets.size(); i++) {
+      memcpy(page.values.data() + i * valueSize, data + offsets[i], valueSize);
+    }
+  }
+}
+
+vector<MemPtr> CandidateSet::toList(MemIO* memio, const string& scanType, size_t max) {
+  vector<MemPtr> list;
+  list.reserve(std::min(max, count));
+  for (auto& page : pages) {
+    if (list.size() >= max) break;
+    const Byte* values = page.values.data();
+    bool dense = page.dense;
+    size_t size = valueSize;
+    forEachOffset(page, [&](size_t offset, size_t index) {
+        if (list.size() >= max) return;
+        const Byte* value = dense ? values + offset : values + index * size;
+        PemPtr pem = PemPtr(new Pem(page.addr + offset, size, memio));
+        memcpy(pem->getData(), value, size);
+        pem->setScanType(scanType);
+        pem->rememberValue((Byte*)value, size);
+        list.push_back(pem);
+      });
+  }
+  return list;
+}
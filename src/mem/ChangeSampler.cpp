@@ -0,0 +1,248 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "mem/ChangeSampler.hpp"
+#include "mem/MemScanner.hpp"
+#include "mem/Pem.hpp"
+#include "mem/StringUtil.hpp"
+#include "med/MedCommon.hpp"
+#include "med/MedException.hpp"
+#include "med/MemOperator.hpp"
+#include "med/Metrics.hpp"
+#include "med/ScanParser.hpp"
+
+using namespace std;
+
+template<typename T>
+static bool lessThan(const Byte* a, const Byte* b) {
+  T x, y;
+  memcpy(&x, a, sizeof(T));
+  memcpy(&y, b, sizeof(T));
+  return x < y;
+}
+
+ChangeSampler::ChangeSampler() {
+  valueSize = 0;
+  samples = 0;
+}
+
+void ChangeSampler::reset(MemList& list, const string& scanType) {
+  clear();
+  this->list = list;
+  this->scanType = scanType;
+  auto& mems = this->list.getList();
+  valueSize = mems.size() ? mems[0]->getSize() : 0;
+
+  order.resize(mems.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  auto byAddress = [&mems](size_t a, size_t b) {
+    return mems[a]->getAddress() < mems[b]->getAddress();
+  };
+  if (!is_sorted(order.begin(), order.end(), byAddress)) {
+    sort(order.begin(), order.end(), byAddress);
+  }
+
+  changes.assign(mems.size(), 0);
+  seen.assign(mems.size(), false);
+  lastValues.assign(mems.size() * valueSize, 0);
+  minValues.assign(mems.size() * valueSize, 0);
+  maxValues.assign(mems.size() * valueSize, 0);
+}
+
+void ChangeSampler::clear() {
+  list = MemList();
+  samples = 0;
+  vector<size_t>().swap(order);
+  vector<uint16_t>().swap(changes);
+  vector<bool>().swap(seen);
+  vector<Byte>().swap(lastValues);
+  vector<Byte>().swap(minValues);
+  vector<Byte>().swap(maxValues);
+}
+
+void ChangeSampler::sample(MemIO* memio, double seconds, double rate, ScanProgress& progress) {
+  MetricsTimer timer("sample");
+  if (rate <= 0 || seconds <= 0) {
+    throw MedException("Sample rate and duration must be positive");
+  }
+  auto& mems = list.getList();
+  vector<Address> addresses(order.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    addresses[i] = mems[order[i]]->getAddress();
+  }
+
+  // Every bucket is read into its own part of the buffer, all the buckets in one batch
+  vector<FilterBucket> buckets = MemScanner::makeFilterBuckets(addresses, valueSize);
+  vector<size_t> bufferOffsets(buckets.size());
+  size_t bufferSize = 0;
+  for (size_t i = 0; i < buckets.size(); i++) {
+    bufferOffsets[i] = bufferSize;
+    bufferSize += buckets[i].size;
+  }
+  vector<Byte> buffer(bufferSize);
+  vector<MemRequest> requests(buckets.size());
+
+  size_t total = max((size_t)1, (size_t)(seconds * rate));
+  auto interval = chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(1.0 / rate));
+  auto next = chrono::steady_clock::now();
+  progress.start(total * bufferSize);
+
+  for (size_t n = 0; n < total && !progress.isCancelled(); n++) {
+    for (size_t i = 0; i < buckets.size(); i++) {
+      requests[i] = MemRequest{ buckets[i].start, buffer.data() + bufferOffsets[i], buckets[i].size, false };
+    }
+    memio->readBatch(requests);
+
+    for (size_t i = 0; i < buckets.size(); i++) {
+      if (!requests[i].success) {
+        Metrics::getInstance().add(Counter::PagesFailed);
+        continue;
+      }
+      for (size_t k = buckets[i].begin; k < buckets[i].end; k++) {
+        update(buffer.data() + bufferOffsets[i] + (addresses[k] - buckets[i].start), order[k]);
+      }
+    }
+    samples++;
+    progress.addBytesScanned(bufferSize);
+
+    next += interval;
+    std::this_thread::sleep_until(next);
+  }
+  progress.finish();
+}
+
+void ChangeSampler::update(const Byte* value, size_t index) {
+  Byte* last = lastValues.data() + index * valueSize;
+  Byte* low = minValues.data() + index * valueSize;
+  Byte* high = maxValues.data() + index * valueSize;
+  if (!seen[index]) {
+    seen[index] = true;
+    memcpy(last, value, valueSize);
+    memcpy(low, value, valueSize);
+    memcpy(high, value, valueSize);
+    return;
+  }
+  if (!memcmp(last, value, valueSize)) return;
+
+  memcpy(last, value, valueSize);
+  if (changes[index] < SAMPLE_CHANGES_MAX) {
+    changes[index]++;
+  }
+  if (isLess(value, low)) {
+    memcpy(low, value, valueSize);
+  }
+  if (isLess(high, value)) {
+    memcpy(high, value, valueSize);
+  }
+}
+
+bool ChangeSampler::isLess(const Byte* a, const Byte* b) {
+  switch (stringToScanType(scanType)) {
+  case Int8:
+    return lessThan<uint8_t>(a, b);
+  case Int16:
+    return lessThan<uint16_t>(a, b);
+  case Int32:
+  case Ptr32:
+    return lessThan<uint32_t>(a, b);
+  case Ptr64:
+    return lessThan<uint64_t>(a, b);
+  case Float32:
+    return lessThan<float>(a, b);
+  case Float64:
+    return lessThan<double>(a, b);
+  default:
+    return memcmp(a, b, valueSize) < 0;
+  }
+}
+
+size_t ChangeSampler::size() {
+  return list.size();
+}
+
+size_t ChangeSampler::getSamples() {
+  return samples;
+}
+
+string ChangeSampler::getScanType() {
+  return scanType;
+}
+
+MemList& ChangeSampler::getList() {
+  return list;
+}
+
+uint16_t ChangeSampler::getChanges(size_t index) {
+  return changes[index];
+}
+
+string ChangeSampler::getMin(size_t index) {
+  if (!seen[index]) return "";
+  return memToString(minValues.data() + index * valueSize, scanType);
+}
+
+string ChangeSampler::getMax(size_t index) {
+  if (!seen[index]) return "";
+  return memToString(maxValues.data() + index * valueSize, scanType);
+}
+
+bool ChangeSampler::isSampleFilter(const string& value) {
+  string trimmed = StringUtil::trim(value);
+  return trimmed.size() && trimmed[0] == '#';
+}
+
+vector<MemPtr> ChangeSampler::filter(const string& value) {
+  if (!isSampleFilter(value)) {
+    throw MedException("Change count filter starts with #");
+  }
+  string expression = StringUtil::trim(value).substr(1);
+  ScanParser::OpType op = ScanParser::getOpType(expression);
+  vector<string> values = ScanParser::getValues(expression, ' ');
+  size_t operands = op == ScanParser::Within ? 2 : 1;
+  if (values.size() != operands) {
+    throw MedException("Invalid change count filter: " + value);
+  }
+  if (op != ScanParser::Eq && op != ScanParser::Neq && op != ScanParser::Lt && op != ScanParser::Gt &&
+      op != ScanParser::Le && op != ScanParser::Ge && op != ScanParser::Within) {
+    throw MedException("Change count filter supports =, !, <, >, <=, >= and <>");
+  }
+  size_t low, high;
+  try {
+    low = stoul(values[0]);
+    high = operands == 2 ? stoul(values[1]) : low;
+  } catch (exception& ex) {
+    throw MedException("Invalid change count filter: " + value);
+  }
+
+  auto& mems = list.getList();
+  vector<MemPtr> result;
+  for (size_t i = 0; i < mems.size(); i++) {
+    if (!seen[i]) continue;
+    size_t count = changes[i];
+    bool matched;
+    switch (op) {
+    case ScanParser::Neq: matched = count != low; break;
+    case ScanParser::Lt: matched = count < low; break;
+    case ScanParser::Gt: matched = count > low; break;
+    case ScanParser::Le: matched = count <= low; break;
+    case ScanParser::Ge: matched = count >= low; break;
+    case ScanParser::Within: matched = count >= low && count <= high; break;
+    default: matched = count == low; break;
+    }
+    if (!matched) continue;
+
+    // The last value sampled is remembered, for the change filters after it
+    PemPtr pem = static_pointer_cast<Pem>(mems[i]);
+    PemPtr newPem = PemPtr(new Pem(pem->getAddress(), valueSize, pem->getMemIO()));
+    memcpy(newPem->getData(), lastValues.data() + i * valueSize, valueSize);
+    newPem->setScanType(pem->getScanType());
+    newPem->rememberValue(lastValues.data() + i * valueSize, valueSize);
+    result.push_back(newPem);
+  }
+  Metrics::getInstance().add(Counter::Hits, result.size());
+  return result;
+}
@@ -16,10 +16,23 @@ bool Maps::hasPair(const AddressPair& pair) {
   return it != maps.end();
 }
 
-void Maps::push(const AddressPair& pair) {
+void Maps::push(const AddressPair& pair, const string& name) {
   maps.push_back(pair);
+  names.push_back(name);
 }
 
 size_t Maps::size() {
   return maps.size();
 }
+
+string& Maps::getName(int index) {
+  return names[index];
+}
+
+bool Maps::isAnonymous(int index) {
+  auto& name = names[index];
+  return name.empty() ||
+    name == "[heap]" ||
+    name.compare(0, 6, "[stack") == 0 ||
+    name.compare(0, 6, "[anon:") == 0;
+}
@@ -0,0 +1,341 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/ptrace.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "mem/MemBackend.hpp"
+#include "med/MedCommon.hpp"
+#include "med/MedException.hpp"
+#include "med/Metrics.hpp"
+
+using namespace std;
+
+const size_t MEM_BACKEND_IOV_MAX = 1024; // UIO_MAXIOV of Linux
+
+MemBackend::~MemBackend() {}
+
+size_t MemBackend::readBatch(vector<MemRequest>& requests) {
+  size_t count = 0;
+  for (auto& request : requests) {
+    request.success = read(request.addr, request.buf, request.size);
+    count += request.success;
+  }
+  return count;
+}
+
+size_t MemBackend::writeBatch(vector<MemRequest>& requests) {
+  size_t count = 0;
+  for (auto& request : requests) {
+    request.success = write(request.addr, request.buf, request.size);
+    count += request.success;
+  }
+  return count;
+}
+
+shared_ptr<MemBackend> MemBackend::create(const string& name, pid_t pid) {
+  if (name == MEM_BACKEND_SELF) {
+    return make_shared<SelfBackend>();
+  }
+  if (!pid) {
+    throw MedException("Memory backend needs a process: " + name);
+  }
+  if (name == MEM_BACKEND_PROC_MEM) {
+    return make_shared<ProcMemBackend>(pid);
+  } else if (name == MEM_BACKEND_VM) {
+    return make_shared<VmBackend>(pid);
+  } else if (name == MEM_BACKEND_PTRACE) {
+    return make_shared<PtraceBackend>(pid);
+  }
+  throw MedException("Unknown memory backend: " + name);
+}
+
+vector<string> MemBackend::getNames() {
+  return { MEM_BACKEND_VM, MEM_BACKEND_PROC_MEM, MEM_BACKEND_PTRACE };
+}
+
+shared_ptr<MemBackend> MemBackend::probe(pid_t pid) {
+  if (!pid) {
+    return make_shared<SelfBackend>();
+  }
+
+  // The first map is read by every backend, and the fastest one is taken
+  Maps maps = getMaps(pid);
+  if (maps.size() == 0) {
+    return make_shared<PtraceBackend>(pid);
+  }
+  Address addr = std::get<0>(maps.getMaps()[0]);
+  size_t size = min((size_t)getpagesize(), (size_t)(std::get<1>(maps.getMaps()[0]) - addr));
+  vector<Byte> buffer(size);
+
+  shared_ptr<MemBackend> fastest;
+  double fastestTime = 0;
+  for (auto& name : getNames()) {
+    shared_ptr<MemBackend> backend;
+    try {
+      backend = create(name, pid);
+    } catch (MedException& ex) {
+      continue;
+    }
+    if (!backend->read(addr, buffer.data(), size)) continue;
+
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < MEM_BACKEND_PROBE_READS; i++) {
+      backend->read(addr, buffer.data(), size);
+    }
+    double time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (!fastest || time < fastestTime) {
+      fastest = backend;
+      fastestTime = time;
+    }
+  }
+  if (!fastest) {
+    return make_shared<PtraceBackend>(pid);
+  }
+  return fastest;
+}
+
+string SelfBackend::getName() {
+  return MEM_BACKEND_SELF;
+}
+
+bool SelfBackend::read(Address addr, Byte* buf, size_t size) {
+  memcpy(buf, (Byte*)addr, size);
+  return true;
+}
+
+bool SelfBackend::write(Address addr, const Byte* buf, size_t size) {
+  memcpy((Byte*)addr, buf, size);
+  return true;
+}
+
+ProcMemBackend::ProcMemBackend(pid_t pid) {
+  string filename = "/proc/" + to_string(pid) + "/mem";
+  fd = open(filename.c_str(), O_RDWR);
+  if (fd == -1) {
+    fd = open(filename.c_str(), O_RDONLY);
+  }
+  if (fd == -1) {
+    throw MedException("Open failed: " + filename + ", " + strerror(errno));
+  }
+}
+
+ProcMemBackend::~ProcMemBackend() {
+  close(fd);
+}
+
+string ProcMemBackend::getName() {
+  return MEM_BACKEND_PROC_MEM;
+}
+
+bool ProcMemBackend::read(Address addr, Byte* buf, size_t size) {
+  Metrics& metrics = Metrics::getInstance();
+  metrics.add(Counter::Syscalls);
+  if (pread(fd, buf, size, addr) != (ssize_t)size) {
+    return false;
+  }
+  metrics.add(Counter::BytesRead, size);
+  return true;
+}
+
+bool ProcMemBackend::write(Address addr, const Byte* buf, size_t size) {
+  Metrics::getInstance().add(Counter::Syscalls);
+  return pwrite(fd, buf, size, addr) == (ssize_t)size;
+}
+
+VmBackend::VmBackend(pid_t pid) {
+  this->pid = pid;
+}
+
+string VmBackend::getName() {
+  return MEM_BACKEND_VM;
+}
+
+bool VmBackend::read(Address addr, Byte* buf, size_t size) {
+  iovec local = { buf, size };
+  iovec remote = { (void*)addr, size };
+  Metrics& metrics = Metrics::getInstance();
+  metrics.add(Counter::Syscalls);
+  if (process_vm_readv(pid, &local, 1, &remote, 1, 0) != (ssize_t)size) {
+    return false;
+  }
+  metrics.add(Counter::BytesRead, size);
+  return true;
+}
+
+bool VmBackend::write(Address addr, const Byte* buf, size_t size) {
+  iovec local = { (void*)buf, size };
+  iovec remote = { (void*)addr, size };
+  Metrics::getInstance().add(Counter::Syscalls);
+  return process_vm_writev(pid, &local, 1, &remote, 1, 0) == (ssize_t)size;
+}
+
+size_t VmBackend::readBatch(vector<MemRequest>& requests) {
+  return transfer(requests, false);
+}
+
+size_t VmBackend::writeBatch(vector<MemRequest>& requests) {
+  return transfer(requests, true);
+}
+
+size_t VmBackend::transfer(vector<MemRequest>& requests, bool isWrite) {
+  Metrics& metrics = Metrics::getInstance();
+  vector<iovec> local, remote;
+  size_t succeeded = 0;
+  size_t i = 0;
+  while (i < requests.size()) {
+    size_t count = min(requests.size() - i, MEM_BACKEND_IOV_MAX);
+    local.resize(count);
+    remote.resize(count);
+    for (size_t k = 0; k < count; k++) {
+      local[k] = { requests[i + k].buf, requests[i + k].size };
+      remote[k] = { (void*)requests[i + k].addr, requests[i + k].size };
+    }
+    metrics.add(Counter::Syscalls);
+    ssize_t n = isWrite ?
+      process_vm_writev(pid, local.data(), count, remote.data(), count, 0) :
+      process_vm_readv(pid, local.data(), count, remote.data(), count, 0);
+    size_t bytes = n > 0 ? n : 0;
+    if (!isWrite) {
+      metrics.add(Counter::BytesRead, bytes);
+    }
+
+    // The transfer stops at the first request which fails, it is retried alone to find out
+    size_t k = 0;
+    for (; k < count && bytes >= requests[i + k].size; k++) {
+      bytes -= requests[i + k].size;
+      requests[i + k].success = true;
+      succeeded++;
+    }
+    if (k < count) {
+      MemRequest& request = requests[i + k];
+      request.success = isWrite ? write(request.addr, request.buf, request.size) :
+        read(request.addr, request.buf, request.size);
+      succeeded += request.success;
+      k++;
+    }
+    i += k;
+  }
+  return succeeded;
+}
+
+PtraceBackend::PtraceBackend(pid_t pid) {
+  this->pid = pid;
+}
+
+string PtraceBackend::getName() {
+  return MEM_BACKEND_PTRACE;
+}
+
+bool PtraceBackend::peek(Address addr, Byte* buf, size_t size) {
+  Metrics& metrics = Metrics::getInstance();
+  // The last word overlaps the previous one, so that nothing beyond the size is read
+  for (size_t i = 0; i < size; i += sizeof(long)) {
+    size_t offset = (i + sizeof(long) <= size || size < sizeof(long)) ? i : size - sizeof(long);
+    errno = 0;
+    long word = ptrace(PTRACE_PEEKDATA, pid, (Byte*)(addr + offset), NULL);
+    metrics.add(Counter::Syscalls);
+    if (errno) {
+      return false;
+    }
+    memcpy(buf + offset, &word, min(sizeof(long), size - offset));
+  }
+  metrics.add(Counter::BytesRead, size);
+  return true;
+}
+
+bool PtraceBackend::poke(Address addr, const Byte* buf, size_t size) {
+  Metrics& metrics = Metrics::getInstance();
+  for (size_t i = 0; i < size; i += sizeof(long)) {
+    size_t offset = (i + sizeof(long) <= size || size < sizeof(long)) ? i : size - sizeof(long);
+    long word;
+    if (size - offset < sizeof(long)) {
+      // Peek first, so that the bytes after the value are kept
+      errno = 0;
+      word = ptrace(PTRACE_PEEKDATA, pid, (Byte*)(addr + offset), NULL);
+      metrics.add(Counter::Syscalls);
+      if (errno) {
+        return false;
+      }
+    }
+    memcpy(&word, buf + offset, min(sizeof(long), size - offset));
+    metrics.add(Counter::Syscalls);
+    if (ptrace(PTRACE_POKEDATA, pid, (Byte*)(addr + offset), word) == -1L) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool PtraceBackend::read(Address addr, Byte* buf, size_t size) {
+  vector<MemRequest> requests = { MemRequest{ addr, buf, size, false } };
+  return readBatch(requests) == 1;
+}
+
+bool PtraceBackend::write(Address addr, const Byte* buf, size_t size) {
+  vector<MemRequest> requests = { MemRequest{ addr, (Byte*)buf, size, false } };
+  return writeBatch(requests) == 1;
+}
+
+size_t PtraceBackend::readBatch(vector<MemRequest>& requests) {
+  std::lock_guard<std::mutex> lock(mutex);
+  Metrics& metrics = Metrics::getInstance();
+  metrics.add(Counter::PtraceAttaches);
+  metrics.add(Counter::Syscalls, 3); // ptrace, waitpid and detach
+  try {
+    pidAttach(pid);
+  } catch (MedException& ex) {
+    return 0;
+  }
+  size_t count = 0;
+  for (auto& request : requests) {
+    request.success = peek(request.addr, request.buf, request.size);
+    count += request.success;
+  }
+  pidDetach(pid);
+  return count;
+}
+
+size_t PtraceBackend::writeBatch(vector<MemRequest>& requests) {
+  std::lock_guard<std::mutex> lock(mutex);
+  Metrics& metrics = Metrics::getInstance();
+  metrics.add(Counter::PtraceAttaches);
+  metrics.add(Counter::Syscalls, 3);
+  try {
+    pidAttach(pid);
+  } catch (MedException& ex) {
+    return 0;
+  }
+  size_t count = 0;
+  for (auto& request : requests) {
+    request.success = poke(request.addr, request.buf, request.size);
+    count += request.success;
+  }
+  pidDetach(pid);
+  return count;
+}
+
+DumpBackend::DumpBackend(shared_ptr<MemDump> dump) {
+  this->dump = dump;
+}
+
+string DumpBackend::getName() {
+  return MEM_BACKEND_DUMP;
+}
+
+bool DumpBackend::read(Address addr, Byte* buf, size_t size) {
+  if (!dump->read(addr, buf, size)) return false;
+  Metrics::getInstance().add(Counter::BytesRead, size);
+  return true;
+}
+
+bool DumpBackend::write(Address addr, const Byte* buf, size_t size) {
+  return dump->write(addr, buf, size);
+}
+
+MemDump* DumpBackend::getDump() {
+  return dump.get();
+}
@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <cstring>
+#include <elf.h>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mem/MemDump.hpp"
+#include "mem/MemIO.hpp"
+#include "med/MedException.hpp"
+
+using namespace std;
+
+// Dump layout, all 64-bit little-endian:
+// magic, region count, regions (start, end, file offset, name length, name padded to 8 bytes),
+// then the bytes of every region at its file offset, aligned to the page.
+const char MEM_DUMP_MAGIC[8] = { 'M', 'E', 'D', 'D', 'U', 'M', 'P', '1' };
+const size_t MEM_DUMP_CHUNK = 1024 * 1024;
+
+namespace {
+  size_t padded(size_t size, size_t align) {
+    return (size + align - 1) / align * align;
+  }
+
+  struct NamedRange {
+    Address start;
+    Address end;
+    string name;
+  };
+}
+
+MemDump::MemDump(const string& filename) {
+  this->filename = filename;
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd == -1) {
+    throw MedException("Open dump: Fail to open file " + filename);
+  }
+  struct stat st;
+  if (fstat(fd, &st) == -1 || st.st_size < (off_t)sizeof(MEM_DUMP_MAGIC)) {
+    close(fd);
+    throw MedException("Open dump: Invalid file " + filename);
+  }
+  size = st.st_size;
+  // Private and writable, so that the values can be edited without changing the file
+  void* mapped = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    throw MedException("Open dump: Fail to map file " + filename);
+  }
+  data = (Byte*)mapped;
+
+  try {
+    if (memcmp(data, ELFMAG, SELFMAG) == 0) {
+      loadCore();
+    } else if (memcmp(data, MEM_DUMP_MAGIC, sizeof(MEM_DUMP_MAGIC)) == 0) {
+      loadDump();
+    } else {
+      throw MedException("Open dump: Neither core file nor Med dump " + filename);
+    }
+  } catch (MedException&) {
+    munmap(data, size);
+    throw;
+  }
+  sort(regions.begin(), regions.end(), [](const Region& a, const Region& b) {
+      return a.start < b.start;
+    });
+}
+
+MemDump::~MemDump() {
+  munmap(data, size);
+}
+
+void MemDump::loadCore() {
+  if (size < sizeof(Elf64_Ehdr)) {
+    throw MedException("Open dump: Truncated core file " + filename);
+  }
+  Elf64_Ehdr* header = (Elf64_Ehdr*)data;
+  if (header->e_ident[EI_CLASS] != ELFCLASS64 || header->e_type != ET_CORE) {
+    throw MedException("Open dump: Only 64-bit core file is supported " + filename);
+  }
+  if (header->e_phoff > size || (size - header->e_phoff) / sizeof(Elf64_Phdr) < header->e_phnum) {
+    throw MedException("Open dump: Truncated core file " + filename);
+  }
+  Elf64_Phdr* segments = (Elf64_Phdr*)(data + header->e_phoff);
+
+  // Names of the file-backed mappings, from the NT_FILE note
+  vector<NamedRange> files;
+  for (int i = 0; i < header->e_phnum; i++) {
+    Elf64_Phdr& segment = segments[i];
+    if (segment.p_type != PT_NOTE || segment.p_offset + segment.p_filesz > size) continue;
+    Byte* note = data + segment.p_offset;
+    Byte* noteEnd = note + segment.p_filesz;
+    while (note + sizeof(Elf64_Nhdr) <= noteEnd) {
+      Elf64_Nhdr* nhdr = (Elf64_Nhdr*)note;
+      Byte* desc = note + sizeof(Elf64_Nhdr) + padded(nhdr->n_namesz, 4);
+      Byte* next = desc + padded(nhdr->n_descsz, 4);
+      if (next > noteEnd) break;
+
+      if (nhdr->n_type == NT_FILE && nhdr->n_descsz >= 2 * sizeof(uint64_t)) {
+        uint64_t* words = (uint64_t*)desc;
+        uint64_t count = words[0];
+        const char* name = (const char*)(words + 2 + count * 3);
+        const char* descEnd = (const char*)desc + nhdr->n_descsz;
+        for (uint64_t k = 0; k < count && name < descEnd; k++) {
+          size_t length = strnlen(name, descEnd - name);
+          files.push_back(NamedRange{ words[2 + k * 3], words[3 + k * 3], string(name, length) });
+          name += length + 1;
+        }
+      }
+      note = next;
+    }
+  }
+
+  vector<NamedRange> writable;
+  for (int i = 0; i < header->e_phnum; i++) {
+    Elf64_Phdr& segment = segments[i];
+    // The segments which are not dumped have no bytes in the file
+    if (segment.p_type != PT_LOAD || segment.p_filesz == 0) continue;
+    if (segment.p_offset + segment.p_filesz > size) {
+      throw MedException("Open dump: Truncated core file " + filename);
+    }
+    Address start = segment.p_vaddr;
+    Address end = start + segment.p_filesz;
+    regions.push_back(Region{ start, end, (size_t)segment.p_offset });
+
+    if ((segment.p_flags & PF_R) && (segment.p_flags & PF_W)) {
+      string name;
+      for (auto& file : files) {
+        if (start >= file.start && start < file.end) {
+          name = file.name;
+          break;
+        }
+      }
+      writable.push_back(NamedRange{ start, end, name });
+    }
+  }
+  sort(writable.begin(), writable.end(), [](const NamedRange& a, const NamedRange& b) {
+      return a.start < b.start;
+    });
+  for (auto& range : writable) {
+    maps.push(AddressPair(range.start, range.end), range.name);
+  }
+}
+
+void MemDump::loadDump() {
+  Byte* ptr = data + sizeof(MEM_DUMP_MAGIC);
+  Byte* end = data + size;
+  auto read64 = [&ptr, end, this]() {
+    if (ptr + sizeof(uint64_t) > end) {
+      throw MedException("Open dump: Truncated file " + filename);
+    }
+    uint64_t value;
+    memcpy(&value, ptr, sizeof(value));
+    ptr += sizeof(value);
+    return value;
+  };
+
+  uint64_t count = read64();
+  for (uint64_t i = 0; i < count; i++) {
+    Address start = read64();
+    Address regionEnd = read64();
+    uint64_t offset = read64();
+    uint64_t nameLength = read64();
+    if (padded(nameLength, 8) > (size_t)(end - ptr) || regionEnd < start ||
+        offset > size || regionEnd - start > size - offset) {
+      throw MedException("Open dump: Truncated file " + filename);
+    }
+    maps.push(AddressPair(start, regionEnd), string((const char*)ptr, nameLength));
+    regions.push_back(Region{ start, regionEnd, (size_t)offset });
+    ptr += padded(nameLength, 8);
+  }
+}
+
+const string& MemDump::getFilename() {
+  return filename;
+}
+
+Maps& MemDump::getMaps() {
+  return maps;
+}
+
+Byte* MemDump::find(Address addr, size_t size) {
+  auto it = upper_bound(regions.begin(), regions.end(), addr, [](Address a, const Region& region) {
+      return a < region.start;
+    });
+  if (it == regions.begin()) return NULL;
+  --it;
+  if (addr + size > it->end || addr + size < addr) return NULL;
+  return data + it->offset + (addr - it->start);
+}
+
+bool MemDump::read(Address addr, Byte* buf, size_t size) {
+  Byte* ptr = find(addr, size);
+  if (!ptr) return false;
+  memcpy(buf, ptr, size);
+  return true;
+}
+
+bool MemDump::write(Address addr, const Byte* buf, size_t size) {
+  Byte* ptr = find(addr, size);
+  if (!ptr) return false;
+  memcpy(ptr, buf, size);
+  return true;
+}
+
+void MemDump::save(MemIO* memio, Maps& maps, const string& filename) {
+  ofstream ofs(filename, ios::binary);
+  if (ofs.fail()) {
+    throw MedException("Save dump: Fail to open file " + filename);
+  }
+  auto write64 = [&ofs](uint64_t value) {
+    ofs.write((const char*)&value, sizeof(value));
+  };
+
+  size_t pageSize = getpagesize();
+  size_t headerSize = sizeof(MEM_DUMP_MAGIC) + sizeof(uint64_t);
+  for (size_t i = 0; i < maps.size(); i++) {
+    headerSize += 4 * sizeof(uint64_t) + padded(maps.getName(i).size(), 8);
+  }
+
+  ofs.write(MEM_DUMP_MAGIC, sizeof(MEM_DUMP_MAGIC));
+  write64(maps.size());
+  size_t offset = padded(headerSize, pageSize);
+  for (size_t i = 0; i < maps.size(); i++) {
+    auto& pair = maps.getMaps()[i];
+    string name = maps.getName(i);
+    write64(std::get<0>(pair));
+    write64(std::get<1>(pair));
+    write64(offset);
+    write64(name.size());
+    name.resize(padded(name.size(), 8), '\0');
+    ofs.write(name.data(), name.size());
+    offset += padded(std::get<1>(pair) - std::get<0>(pair), pageSize);
+  }
+
+  vector<Byte> buffer(MEM_DUMP_CHUNK);
+  vector<Byte> zero(pageSize, 0);
+  ofs.write((const char*)zero.data(), padded(headerSize, pageSize) - headerSize);
+  for (size_t i = 0; i < maps.size(); i++) {
+    auto& pair = maps.getMaps()[i];
+    for (Address addr = std::get<0>(pair); addr < std::get<1>(pair); addr += MEM_DUMP_CHUNK) {
+      size_t length = min(MEM_DUMP_CHUNK, (size_t)(std::get<1>(pair) - addr));
+      if (!memio->read(addr, buffer.data(), length)) {
+        // Page by page, so that only the unreadable pages are zero
+        for (size_t k = 0; k < length; k += pageSize) {
+          size_t pageLength = min(pageSize, length - k);
+          if (!memio->read(addr + k, buffer.data() + k, pageLength)) {
+            memset(buffer.data() + k, 0, pageLength);
+          }
+        }
+      }
+      ofs.write((const char*)buffer.data(), length);
+    }
+    size_t length = std::get<1>(pair) - std::get<0>(pair);
+    ofs.write((const char*)zero.data(), padded(length, pageSize) - length);
+  }
+
+  if (ofs.fail()) {
+    throw MedException("Save dump: Fail to write file " + filename);
+  }
+}
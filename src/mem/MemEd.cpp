@@ -1,5 +1,6 @@
 #include <iostream>
 #include <fstream>
+#include <memory>
 
 #include "mem/MemEd.hpp"
 #include "med/MedCommon.hpp"
@@ -19,6 +20,11 @@ MemEd::MemEd(pid_t pid) {
 }
 
 MemEd::~MemEd() {
+  if (scanJob) {
+    scanJob->cancel();
+    scanJob->wait();
+  }
+  delete recorder;
   delete scanner;
 
   delete store;
@@ -30,6 +36,7 @@ MemEd::~MemEd() {
 void MemEd::initialize() {
   pid = 0;
   scanner = new MemScanner();
+  recorder = new ValueRecorder(scanner->getMemIO());
 
   vector<MemPtr> emptyMems;
   store = new MemList(emptyMems);
@@ -40,6 +47,8 @@ void MemEd::initialize() {
 }
 
 void MemEd::setPid(pid_t pid) {
+  checkScanJobDone();
+  recorder->stop();
   this->pid = pid;
   scanner->setPid(pid);
 }
@@ -48,14 +57,176 @@ pid_t MemEd::getPid() {
   return pid;
 }
 
+void MemEd::openDump(const string& filename) {
+  checkScanJobDone();
+  recorder->stop();
+  scanner->openDump(filename);
+  pid = 0;
+  selectedProcess.pid = "0";
+  selectedProcess.cmdline = filename;
+  std::lock_guard<std::mutex> lock(getScanListMutex());
+  clearScans();
+}
+
+void MemEd::saveDump(const string& filename) {
+  scanner->saveDump(filename);
+}
+
 vector<MemPtr> MemEd::scan(const string& value, const string& scanType, bool fastScan, const string& lastDigit) {
+  resetScanState();
+  return scanWithoutReset(value, scanType, fastScan, lastDigit);
+}
+
+vector<MemPtr> MemEd::filter(const string& value, const string& scanType, bool fastScan) {
+  resetScanState();
+  return filterWithoutReset(value, scanType, fastScan);
+}
+
+ScanJobPtr MemEd::scanAsync(const string& value, const string& scanType, bool fastScan, const string& lastDigit) {
+  return startScanJob([this, value, scanType, fastScan, lastDigit]() {
+    return scanWithoutReset(value, scanType, fastScan, lastDigit);
+  });
+}
+
+ScanJobPtr MemEd::filterAsync(const string& value, const string& scanType, bool fastScan) {
+  return startScanJob([this, value, scanType, fastScan]() {
+    return filterWithoutReset(value, scanType, fastScan);
+  });
+}
+
+void MemEd::sample(double seconds, double rate) {
+  resetScanState();
+  sampleWithoutReset(seconds, rate);
+}
+
+ScanJobPtr MemEd::sampleAsync(double seconds, double rate) {
+  return startScanJob([this, seconds, rate]() {
+    return sampleWithoutReset(seconds, rate);
+  });
+}
+
+vector<MemPtr> MemEd::sampleWithoutReset(double seconds, double rate) {
+  MemList scans;
+  string scanType;
+  {
+    std::lock_guard<std::mutex> lock(getScanListMutex());
+    scans = getScans();
+    scanType = namedScans.getScanType();
+    // Only the listed part of the candidates would be sampled, the "#" filter would drop the rest
+    if (hasOwnCandidates() && scanner->getCandidateCount() > scans.size()) {
+      throw MedException("Too many addresses to sample, filter them first");
+    }
+  }
+  if (!scans.size()) {
+    throw MedException("No scans to sample");
+  }
+  sampler.reset(scans, scanType);
+  sampler.sample(scanner->getMemIO(), seconds, rate, scanner->getProgress());
+  return scans.getList();
+}
+
+ChangeSampler& MemEd::getSampler() {
+  return sampler;
+}
+
+vector<WatchHit> MemEd::watchWrites(Address address, size_t size, double seconds) {
+  resetScanState();
+  watchWithoutReset(address, size, seconds);
+  return watchHits;
+}
+
+ScanJobPtr MemEd::watchWritesAsync(Address address, size_t size, double seconds) {
+  return startScanJob([this, address, size, seconds]() {
+    return watchWithoutReset(address, size, seconds);
+  });
+}
+
+vector<MemPtr> MemEd::watchWithoutReset(Address address, size_t size, double seconds) {
+  pid_t pid = scanner->getMemIO()->getPid();
+  if (!pid) {
+    throw MedException("Select a process to watch");
+  }
+  watchHits.clear();
+  Watchpoint watchpoint(pid);
+  watchpoint.add(address, size);
+  watchpoint.watch(seconds, scanner->getProgress());
+  watchHits = watchpoint.getHits();
+  return vector<MemPtr>();
+}
+
+vector<WatchHit>& MemEd::getWatchHits() {
+  return watchHits;
+}
+
+ScanJobPtr MemEd::getScanJob() {
+  return scanJob;
+}
+
+ScanJobPtr MemEd::startScanJob(ScanJob::Task task) {
+  if (scanJob && !scanJob->isDone()) {
+    throw MedException("Scan is running");
+  }
+  if (scanJob) {
+    scanJob->wait();
+  }
+
+  // Reset before the job starts, so that cancelling right after submitting is not lost
+  resetScanState();
+  scanJob = ScanJobPtr(new ScanJob(scanner->getProgress(), task));
+  scanJob->start();
+  return scanJob;
+}
+
+void MemEd::publishScans(const vector<MemPtr>& mems, const string& scanType, const string& name) {
+  {
+    // Replace the whole list at once, so that the readers never see a partial list
+    std::lock_guard<std::mutex> lock(getScanListMutex());
+    bool capped = scanner->getCandidateCount() > mems.size();
+    bool published = namedScans.setMemPtrs(name, mems, scanType, capped);
+    // The candidates kept by the scanner belong to the list just published
+    candidateScans = published && scanner->getCandidateCount() ? *namedScans.getMemList(name) : MemList();
+  }
+
+  if (traceFile.size()) {
+    try {
+      getMetrics().saveTrace(traceFile);
+    } catch (MedException& ex) {
+      cerr << ex.getMessage() << endl;
+    }
+  }
+}
+
+string MemEd::getActiveScanName() {
+  std::lock_guard<std::mutex> lock(getScanListMutex());
+  return namedScans.getActiveName();
+}
+
+void MemEd::checkScanJobDone() {
+  if (scanJob && !scanJob->isDone()) {
+    throw MedException("Scan is running");
+  }
+}
+
+void MemEd::resetScanState() {
+  scanner->getProgress().reset();
+  getMetrics().reset();
+}
+
+vector<MemPtr> MemEd::scanWithoutReset(const string& value, const string& scanType, bool fastScan, const string& lastDigit) {
   if (!ScanParser::isValid(value)) {
     throw MedException("Invalid scan string");
   }
 
   ScanParser::OpType op = ScanParser::getOpType(value);
+  if (ScanParser::isDeltaOperator(op)) {
+    throw MedException("Change operators can only be used to filter");
+  }
 
   vector<MemPtr> mems;
+  if (scanType == SCAN_TYPE_GROUP) {
+    return scanGroup(value);
+  }
+  string name = getActiveScanName();
   if (op == ScanParser::OpType::SnapshotSave) {
     scanner->saveSnapshot(store->getList());
   } else if (scanType == SCAN_TYPE_CUSTOM) {
@@ -64,36 +235,95 @@ vector<MemPtr> MemEd::scan(const string& value, const string& scanType, bool fas
   }
   else {
     Operands operands = ScanParser::valueToOperands(value, scanType, op);
-    size_t size = operands.getFirstSize();
+    size_t size = ScanParser::getValueSize(operands, scanType, op);
 
     int lastDigitValue = hexStrToInt(lastDigit);
     mems = scanner->scan(operands, size, scanType, op, fastScan, lastDigitValue);
   }
-  namedScans.setMemPtrs(mems, scanType);
+  publishScans(mems, scanType, name);
   return mems;
 }
 
-vector<MemPtr> MemEd::filter(const string& value, const string& scanType, bool fastScan) {
+vector<MemPtr> MemEd::scanGroup(const string& value) {
+  GroupScan group(value);
+  string name = getActiveScanName();
+  auto matches = scanner->scanGroup(group);
+
+  // The anchors are the scan results, which can be filtered by the anchor type
+  vector<MemPtr> mems;
+  string anchorType = group.getAnchorType();
+  size_t size = scanTypeToSize(anchorType);
+  auto& anchorValue = group.getMembers()[0].value;
+  for (auto& match : matches) {
+    PemPtr pem = PemPtr(new Pem(match.anchor, size, scanner->getMemIO()));
+    pem->setScanType(anchorType);
+    pem->rememberValue((Byte*)anchorValue.data(), size);
+    mems.push_back(pem);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(getScanListMutex());
+    groupMatches = matches;
+  }
+  publishScans(mems, anchorType, name);
+  return mems;
+}
+
+vector<GroupMatch> MemEd::getGroupMatches() {
+  std::lock_guard<std::mutex> lock(getScanListMutex());
+  return groupMatches;
+}
+
+vector<MemPtr> MemEd::filterWithoutReset(const string& value, const string& scanType, bool fastScan) {
+  // The list is shared by the copy, so that it is not replaced while it is filtered
+  MemList scans;
+  string name;
+  bool ownCandidates;
+  {
+    std::lock_guard<std::mutex> lock(getScanListMutex());
+    scans = getScans();
+    name = namedScans.getActiveName();
+    ownCandidates = hasOwnCandidates();
+  }
+  if (ChangeSampler::isSampleFilter(value)) {
+    if (!sampler.getSamples() || &sampler.getList().getList() != &scans.getList()) {
+      throw MedException("Sample the scans before filtering by the change count");
+    }
+    vector<MemPtr> mems = sampler.filter(value);
+    // The candidate set is not sampled, the list is filtered instead
+    scanner->clearCandidates();
+    publishScans(mems, sampler.getScanType(), name);
+    return mems;
+  }
   if (!ScanParser::isValid(value)) {
     throw MedException("Invalid scan string");
   }
+  if (scanType == SCAN_TYPE_GROUP) {
+    throw MedException("Group scan result is filtered by the type of the first value");
+  }
+  if (!ownCandidates) {
+    scanner->clearCandidates();
+  }
 
   vector<MemPtr> mems;
   ScanParser::OpType op = ScanParser::getOpType(value);
   if (ScanParser::isSnapshotOperator(op) && !ScanParser::hasValues(value)) {
-    mems = scanner->filterUnknown(namedScans.getMemList()->getList(), scanType, op, fastScan);
+    mems = scanner->filterUnknown(scans.getList(), scanType, op, fastScan);
+  } else if (ScanParser::isDeltaOperator(op)) {
+    Operands operands = ScanParser::valueToOperands(value, scanType, op);
+    mems = scanner->filterUnknown(scans.getList(), operands, scanType, op, fastScan);
   } else if (scanType == SCAN_TYPE_CUSTOM) {
     ScanCommand scanCommand = ScanParser::getScanCommand(value);
-    mems = scanner->filter(namedScans.getMemList()->getList(), scanCommand);
+    mems = scanner->filter(scans.getList(), scanCommand);
   }
   else {
     Operands operands = ScanParser::valueToOperands(value, scanType, op);
-    size_t size = operands.getFirstSize();
+    size_t size = ScanParser::getValueSize(operands, scanType, op);
 
-    mems = scanner->filter(namedScans.getMemList()->getList(), operands, size, scanType, op);
+    mems = scanner->filter(scans.getList(), operands, size, scanType, op);
   }
 
-  namedScans.setMemPtrs(mems, scanType);
+  publishScans(mems, scanType, name);
   return mems;
 }
 
@@ -101,9 +331,43 @@ NamedScans& MemEd::getNamedScans() {
   return namedScans;
 }
 
+void MemEd::setActiveScanName(const string& name) {
+  checkScanJobDone();
+  std::lock_guard<std::mutex> lock(getScanListMutex());
+  namedScans.setActiveName(name);
+}
+
+bool MemEd::removeNamedScan(const string& name) {
+  checkScanJobDone();
+  std::lock_guard<std::mutex> lock(getScanListMutex());
+  return namedScans.remove(name);
+}
+
 MemList MemEd::getScans() {
-  MemList list(namedScans.getMemList()->getList());
-  return list;
+  // Shares the vector with the named scan, see MemList
+  return *namedScans.getMemList();
+}
+
+void MemEd::startRecording(const vector<int>& indices, double rate) {
+  vector<RecorderTrack> tracks;
+  {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    for (int index : indices) {
+      SemPtr sem = static_pointer_cast<Sem>(store->getMemPtr(index));
+      tracks.push_back(RecorderTrack{ sem->getAddress(), sem->getScanType(), sem->getDescription() });
+    }
+  }
+  recorder->stop();
+  recorder->setTracks(tracks);
+  recorder->start(rate);
+}
+
+void MemEd::stopRecording() {
+  recorder->stop();
+}
+
+ValueRecorder* MemEd::getRecorder() {
+  return recorder;
 }
 
 vector<Process> MemEd::listProcesses() {
@@ -112,13 +376,51 @@ vector<Process> MemEd::listProcesses() {
 }
 
 Process MemEd::selectProcessByIndex(int index) {
+  checkScanJobDone();
   selectedProcess = processes[index];
   setPid(stoi(selectedProcess.pid));
   return selectedProcess;
 }
 
+size_t MemEd::getScanCount() {
+  size_t count = hasOwnCandidates() ? scanner->getCandidateCount() : 0;
+  return count ? count : namedScans.getMemList()->size();
+}
+
+bool MemEd::hasOwnCandidates() {
+  // Another named scan is active, or the list is replaced, since the candidates are kept
+  return scanner->getCandidateCount() && &candidateScans.getList() == &namedScans.getMemList()->getList();
+}
+
+bool MemEd::undoScan() {
+  return moveInHistory(true);
+}
+
+bool MemEd::redoScan() {
+  return moveInHistory(false);
+}
+
+bool MemEd::moveInHistory(bool backward) {
+  checkScanJobDone();
+  std::lock_guard<std::mutex> lock(getScanListMutex());
+  // The results beyond the list were only in the candidates of the scanner
+  if (namedScans.getHistory().isCapped(backward)) {
+    throw MedException("The result has more addresses than the list keeps, scan again instead");
+  }
+  bool moved = backward ? namedScans.undo() : namedScans.redo();
+  if (moved) {
+    // The candidates are of the latest result, the restored list is filtered instead
+    scanner->clearCandidates();
+  }
+  return moved;
+}
+
 void MemEd::clearScans() {
+  checkScanJobDone();
   namedScans.getMemList()->clear();
+  scanner->clearCandidates();
+  candidateScans = MemList();
+  sampler.clear();
 }
 
 MemList* MemEd::getStore() {
@@ -132,6 +434,65 @@ void MemEd::addToStoreByIndex(int index) {
   getStore()->addMemPtr(sem);
 }
 
+StrideMatch MemEd::addStrideToStore(int index, size_t maxStride) {
+  SemPtr sem = static_pointer_cast<Sem>(getStore()->getMemPtr(index));
+  StrideDetector detector(sem->getScanType(), maxStride);
+  StrideMatch match = scanner->detectStride(detector, sem->getAddress());
+
+  // Every element other than the anchor is added, numbered by its distance from the anchor
+  for (auto addr : match.addresses) {
+    if (addr == sem->getAddress()) continue;
+    SemPtr newSem = Sem::clone(sem);
+    newSem->setAddress(addr);
+    newSem->lock(false);
+    long n = ((long)addr - (long)sem->getAddress()) / (long)match.stride;
+    newSem->setDescription(sem->getDescription() + " [" + (n > 0 ? "+" : "") + to_string(n) + "]");
+    getStore()->addMemPtr(newSem);
+  }
+  return match;
+}
+
+Signature MemEd::makeSignature(int index) {
+  SemPtr sem = static_pointer_cast<Sem>(getStore()->getMemPtr(index));
+  Signature signature = scanner->makeSignature(sem->getAddress(), sem->getSize());
+  sem->setSignature(signature);
+  return signature;
+}
+
+int MemEd::resolveSignatures() {
+  std::lock_guard<std::mutex> lock(storeMutex);
+  int resolved = 0;
+  for (auto& mem : getStore()->getList()) {
+    auto sem = static_pointer_cast<Sem>(mem);
+    if (sem->getSignature().isEmpty()) continue;
+
+    // Ambiguous signature keeps the saved address
+    auto addresses = scanner->resolveSignature(sem->getSignature());
+    if (addresses.size() == 1) {
+      sem->setAddress(addresses[0]);
+      resolved++;
+    }
+  }
+  return resolved;
+}
+
+void MemEd::savePointerMap(Address target, const string& filename) {
+  PointerMap pointerMap;
+  scanner->scanPointers(pointerMap, target);
+  pointerMap.save(filename);
+}
+
+vector<PointerPath> MemEd::findPointerPaths(const vector<string>& filenames, size_t maxDepth, size_t maxOffset) {
+  vector<unique_ptr<PointerMap>> pointerMaps;
+  vector<PointerMap*> list;
+  for (auto& filename : filenames) {
+    pointerMaps.push_back(unique_ptr<PointerMap>(new PointerMap()));
+    pointerMaps.back()->load(filename);
+    list.push_back(pointerMaps.back().get());
+  }
+  return PointerMap::intersect(list, maxDepth, maxOffset);
+}
+
 void MemEd::callLockValues(MemEd* med) {
   while (1) {
     if (med->hasLockValue()) {
@@ -150,7 +511,11 @@ void MemEd::lockValues() {
   for (size_t i = 0; i < list.size(); i++) {
     auto sem = static_pointer_cast<Sem>(list[i]);
     if (sem->isLocked()) {
-      sem->lockValue();
+      try {
+        sem->lockValue();
+      } catch (MedException& ex) {
+        cerr << "lockValues: " << ex.getMessage() << endl;
+      }
     }
   }
   storeMutex.unlock();
@@ -186,6 +551,10 @@ void MemEd::saveFile(const char* filename) {
       pairs["value"] = "";
     }
     pairs["lock"] = sem->isLocked();
+    if (!sem->getSignature().isEmpty()) {
+      pairs["signature"] = sem->getSignature().getPattern();
+      pairs["signatureOffset"] = (Json::Int64)sem->getSignature().getOffset();
+    }
     root["addresses"].append(pairs);
   }
   root["notes"] = getNotes();
@@ -211,7 +580,7 @@ void MemEd::loadLegacyJson(Json::Value& root) {
     sem->setDescription(root[i]["description"].asString());
     sem->lock(false); // always open as false, so that do not update the value
 
-    getStore()->getList().push_back(sem);
+    getStore()->addMemPtr(sem);
   }
 }
 
@@ -227,8 +596,12 @@ void MemEd::loadJson(Json::Value& root) {
     sem->setScanType(scanType);
     sem->setDescription(addresses[i]["description"].asString());
     sem->lock(false); // always open as false, so that do not update the value
+    if (addresses[i].isMember("signature")) {
+      sem->setSignature(Signature(addresses[i]["signature"].asString(),
+                                  addresses[i]["signatureOffset"].asInt64()));
+    }
 
-    getStore()->getList().push_back(sem);
+    getStore()->addMemPtr(sem);
   }
   notes = root["notes"].asString();
 }
@@ -253,6 +626,11 @@ void MemEd::openFile(const char* filename) {
     loadJson(root);
   }
   storeMutex.unlock();
+
+  // The saved addresses are moved to where their signatures are found in the selected process
+  if (pid) {
+    resolveSignatures();
+  }
 }
 
 string& MemEd::getNotes() {
@@ -268,7 +646,7 @@ void MemEd::addNewAddress() {
   SemPtr sem = SemPtr(new Sem(scanTypeToSize(ScanType::Int32), memio));
   sem->setScanType(SCAN_TYPE_INT_32);
   sem->setDescription("No description");
-  store->getList().push_back(sem);
+  store->addMemPtr(sem);
 }
 
 MemPtr MemEd::readMemory(Address addr, size_t size) {
@@ -284,17 +662,57 @@ void MemEd::setValueByAddress(Address addr, const string& value, const string& s
 }
 
 void MemEd::setScopeStart(Address addr) {
+  checkScanJobDone();
   scanner->setScopeStart(addr);
 }
 
 void MemEd::setScopeEnd(Address addr) {
+  checkScanJobDone();
   scanner->setScopeEnd(addr);
 }
 
+void MemEd::setScanRanges(const string& spec) {
+  checkScanJobDone();
+  scanner->setScanRanges(ScanRanges::parse(spec));
+}
+
+string MemEd::getScanRanges() {
+  return scanner->getScanRanges().toString();
+}
+
 std::mutex& MemEd::getScanListMutex() {
   return scanner->getListMutex();
 }
 
+ScanProgress& MemEd::getScanProgress() {
+  return scanner->getProgress();
+}
+
+void MemEd::cancelScan() {
+  scanner->getProgress().cancel();
+}
+
+Metrics& MemEd::getMetrics() {
+  return Metrics::getInstance();
+}
+
+void MemEd::setTraceFile(const string& filename) {
+  traceFile = filename;
+  getMetrics().setTracing(filename.size() > 0);
+}
+
+void MemEd::setSkipZeroPages(bool value) {
+  scanner->setSkipZeroPages(value);
+}
+
+string MemEd::getMemBackend() {
+  return scanner->getMemIO()->getBackend()->getName();
+}
+
+void MemEd::setMemBackend(const string& name) {
+  scanner->getMemIO()->setBackend(name);
+}
+
 void MemEd::resumeProcess() {
   isProcessPaused = false;
   if (pid && isPidSuspended(pid)) {
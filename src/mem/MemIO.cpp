@@ -1,12 +1,10 @@
 #include <cstring>
 #include <string>
-#include <sys/ptrace.h> //ptrace()
-#include <sys/prctl.h> //prctl()
-#include <unistd.h> //open, read, lseek
 #include <iostream>
 
 #include "med/MedException.hpp"
 #include "med/MedCommon.hpp"
+#include "med/Metrics.hpp"
 #include "mem/MemIO.hpp"
 #include "mem/Pem.hpp"
 
@@ -14,119 +12,97 @@ using namespace std;
 
 MemIO::MemIO() {
   pid = 0;
+  backend = make_shared<SelfBackend>();
 }
 
 void MemIO::setPid(pid_t pid) {
+  // Probe before locking, the readers keep using the previous backend meanwhile
+  shared_ptr<MemBackend> probed = MemBackend::probe(pid);
+  std::lock_guard<std::mutex> lock(mutex);
   this->pid = pid;
+  dump = nullptr;
+  backend = probed;
+  fallback = pid ? make_shared<PtraceBackend>(pid) : nullptr;
 }
 
 pid_t MemIO::getPid() {
+  std::lock_guard<std::mutex> lock(mutex);
   return pid;
 }
 
-MemPtr MemIO::read(Address addr, size_t size) {
-  if (pid) {
-    return readProcess(addr, size);
+void MemIO::setDump(std::shared_ptr<MemDump> dump) {
+  if (!dump) {
+    setPid(getPid());
+    return;
   }
-  return readDirect(addr, size);
+  std::lock_guard<std::mutex> lock(mutex);
+  this->dump = dump;
+  pid = 0;
+  backend = make_shared<DumpBackend>(dump);
+  fallback = nullptr;
 }
 
-MemPtr MemIO::readDirect(Address addr, size_t size) {
-  MemPtr mem = MemPtr(new Mem(addr, size));
-  return mem;
+shared_ptr<MemDump> MemIO::getDump() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return dump;
 }
 
-MemPtr MemIO::readProcess(Address addr, size_t size) {
-  mutex.lock();
-  try {
-    pidAttach(pid);
-  } catch (MedException &ex) {
-    mutex.unlock();
-    cerr << ex.getMessage() << endl;
-    return NULL;
+void MemIO::setBackend(const string& name) {
+  pid_t pid = getPid();
+  if (getDump()) {
+    throw MedException("Memory backend cannot be changed for the dump");
   }
+  shared_ptr<MemBackend> created = MemBackend::create(name, pid);
+  std::lock_guard<std::mutex> lock(mutex);
+  backend = created;
+}
 
-  // When read process, use Pem so that the PemPtr can get data
-  // from process through MemIO.
-  MemPtr mem = MemPtr(new Pem(size, this));
-  mem->setAddress(addr);
+shared_ptr<MemBackend> MemIO::getBackend() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return backend;
+}
 
-  int memFd = getMem(pid);
-  if(lseek(memFd, addr, SEEK_SET) == -1) {
-    close(memFd);
-    pidDetach(pid);
-    mutex.unlock();
-    throw MedException("Failed lseek");
+Maps MemIO::getMaps() {
+  auto dump = getDump();
+  if (dump) {
+    return dump->getMaps();
   }
-  if(::read(memFd, mem->getData(), size) == -1) {
-    close(memFd);
-    pidDetach(pid);
-    mutex.unlock();
+  return ::getMaps(getPid());
+}
+
+MemPtr MemIO::read(Address addr, size_t size) {
+  // Pem, so that the PemPtr can get data from the process through MemIO
+  MemPtr mem = MemPtr(new Pem(size, this));
+  mem->setAddress(addr);
+  Metrics::getInstance().add(Counter::Allocations);
+  if (!getBackend()->read(addr, mem->getData(), size)) {
     throw MedException("Address read fail: " + intToHex(addr));
   }
-
-  close(memFd);
-  pidDetach(pid);
-  mutex.unlock();
   return mem;
 }
 
-void MemIO::write(Address addr, MemPtr mem, size_t size) {
-  if (pid) {
-    return writeProcess(addr, mem, size);
-  }
-  return writeDirect(addr, mem, size);
+bool MemIO::read(Address addr, Byte* buf, size_t size) {
+  return getBackend()->read(addr, buf, size);
 }
 
-void MemIO::writeDirect(Address addr, MemPtr mem, size_t size) {
-  Byte* ptr = (Byte*)addr;
-  int writeSize = size ? size : mem->getSize();
-  memcpy(ptr, mem->getData(), writeSize);
+size_t MemIO::readBatch(vector<MemRequest>& requests) {
+  return getBackend()->readBatch(requests);
 }
 
-void MemIO::writeProcess(Address addr, MemPtr mem, size_t size) {
-  mutex.lock();
-  try {
-    pidAttach(pid);
-  } catch (MedException &ex) {
-    mutex.unlock();
-    cerr << ex.getMessage() << endl;
-    return;
-  }
-
+void MemIO::write(Address addr, MemPtr mem, size_t size) {
   int writeSize = size ? size : mem->getSize();
-
-  int psize = padWordSize(writeSize);
-  Byte* buf = new Byte[writeSize];
-
-  long word;
-  for (int i = 0; i < psize; i += sizeof(long)) {
-    errno = 0;
-    word = ptrace(PTRACE_PEEKDATA, pid, (Byte*)(addr) + i, NULL);
-
-    if(errno) {
-      printf("PEEKDATA error: %p, %s\n", (void*)addr, strerror(errno));
-    }
-
-    //Write word to the buffer
-    memcpy((Byte*)buf + i, &word, sizeof(long));
+  shared_ptr<MemBackend> writer, ptraceWriter;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    writer = backend;
+    ptraceWriter = fallback;
   }
+  if (writer->write(addr, mem->getData(), writeSize)) return;
 
-  memcpy(buf, mem->getData(), writeSize); //over-write on top of it, so that the last padding byte will preserved
-
-  for (int i = 0; i < writeSize; i += sizeof(long)) {
-    // This writes as uint32, it should be uint8
-    // According to manual, it reads "word". Depend on the CPU.
-    // If the OS is 32bit, then word is 32bit; if 64bit, then 64bit.
-    // Thus, the best solution is peek first, then only over write the position
-    // Therefore, the value should be the WORD size.
-
-    if (ptrace(PTRACE_POKEDATA, pid, (Byte*)(addr) + i, *(long*)((Byte*)buf + i) ) == -1L) {
-      printf("POKEDATA error: %s\n", strerror(errno));
-    }
+  // process_vm_writev and /proc/pid/mem do not write the read-only pages, ptrace does
+  if (ptraceWriter && writer->getName() != MEM_BACKEND_PTRACE &&
+      ptraceWriter->write(addr, mem->getData(), writeSize)) {
+    return;
   }
-
-  delete[] buf;
-  pidDetach(pid);
-  mutex.unlock();
+  throw MedException("Address write fail: " + intToHex(addr));
 }
@@ -9,82 +9,89 @@
 using namespace std;
 
 MemList::MemList() {
-  list = vector<MemPtr>();
+  list = make_shared<vector<MemPtr>>();
 }
 
 MemList::MemList(vector<MemPtr> list) {
-  this->list = list;
+  this->list = make_shared<vector<MemPtr>>(std::move(list));
+}
+
+vector<MemPtr>& MemList::detach() {
+  if (list.use_count() > 1) {
+    list = make_shared<vector<MemPtr>>(*list);
+  }
+  return *list;
 }
 
 size_t MemList::size() {
-  return list.size();
+  return list->size();
 }
 
 string MemList::getAddressAsString(int index) {
-  return list[index]->getAddressAsString();
+  return (*list)[index]->getAddressAsString();
 }
 
 Address MemList::getAddress(int index) {
-  return list[index]->getAddress();
+  return (*list)[index]->getAddress();
 }
 
 string MemList::getValue(int index, const string& scanType) {
-  if (index >= (int)list.size()) return "";
+  if (index >= (int)list->size()) return "";
 
-  PemPtr pem = static_pointer_cast<Pem>(list[index]);
+  PemPtr pem = static_pointer_cast<Pem>((*list)[index]);
   return pem->getValue(scanType);
 }
 
 string MemList::getValue(int index) {
-  if (index >= (int)list.size()) return "";
+  if (index >= (int)list->size()) return "";
 
-  PemPtr pem = static_pointer_cast<Pem>(list[index]);
+  PemPtr pem = static_pointer_cast<Pem>((*list)[index]);
   return pem->getValue(pem->getScanType());
 }
 
 void MemList::dump(int index, bool newline) {
-  list[index]->dump(newline);
+  (*list)[index]->dump(newline);
 }
 
 string MemList::getScanType(int index) {
-  if (index >= (int)list.size()) return "";
+  if (index >= (int)list->size()) return "";
 
-  PemPtr pem = static_pointer_cast<Pem>(list[index]);
+  PemPtr pem = static_pointer_cast<Pem>((*list)[index]);
   return pem->getScanType();
 }
 
 void MemList::setValue(int index, const string& value, const string& scanType, bool isStored) {
   if (isStored) {
-    SemPtr sem = static_pointer_cast<Sem>(list[index]);
+    SemPtr sem = static_pointer_cast<Sem>((*list)[index]);
     sem->setValue(value, scanType);
     if (sem->isLocked()) {
       sem->setLockedValue(value);
     }
   } else {
-    PemPtr pem = static_pointer_cast<Pem>(list[index]);
+    PemPtr pem = static_pointer_cast<Pem>((*list)[index]);
     pem->setValue(value, scanType);
   }
 }
 
 void MemList::setScanType(int index, const string& scanType) {
-  PemPtr pem = static_pointer_cast<Pem>(list[index]);
+  PemPtr pem = static_pointer_cast<Pem>((*list)[index]);
   pem->setScanType(scanType);
 }
 
 int MemList::getLastIndex() {
-  return list.size() - 1;
+  return list->size() - 1;
 }
 
 void MemList::sortByAddress() {
-  MemList::sortByAddress(list);
+  MemList::sortByAddress(detach());
 }
 
 void MemList::clear() {
-  list.clear();
+  list = make_shared<vector<MemPtr>>();
 }
 
 void MemList::setAddress(int index, const string& address) {
-  list[index]->setAddress(hexToInt(address));
+  (*list)[index]->setAddress(hexToInt(address));
 }
 
 vector<MemPtr> MemList::sortByAddress(vector<MemPtr>& list) {
@@ -96,7 +103,7 @@ vector<MemPtr> MemList::sortByAddress(vector<MemPtr>& list) {
 }
 
 void MemList::sortByDescription() {
-  MemList::sortByDescription(list);
+  MemList::sortByDescription(detach());
 }
 
 vector<MemPtr> MemList::sortByDescription(vector<MemPtr>& list) {
@@ -110,22 +117,22 @@ vector<MemPtr> MemList::sortByDescription(vector<MemPtr>& list) {
 }
 
 MemPtr MemList::getMemPtr(int index) {
-  return list[index];
+  return (*list)[index];
 }
 
 void MemList::addMemPtr(MemPtr mem) {
-  list.push_back(mem);
+  detach().push_back(mem);
 }
 
 void MemList::setList(const vector<MemPtr>& list) {
-  this->list = list;
+  this->list = make_shared<vector<MemPtr>>(list);
 }
-vector<MemPtr>& MemList::getList() {
-  return list;
+const vector<MemPtr>& MemList::getList() {
+  return *list;
 }
 
 void MemList::addNextAddress(int index) {
-  auto mem = list[index];
+  auto mem = (*list)[index];
   SemPtr semPtr = static_pointer_cast<Sem>(mem);
   SemPtr newSem = Sem::clone(semPtr);
 
@@ -134,11 +141,11 @@ void MemList::addNextAddress(int index) {
   newSem->setAddress(addr + step);
   newSem->setDescription("No description");
 
-  list.push_back(newSem);
+  detach().push_back(newSem);
 }
 
 void MemList::addPrevAddress(int index) {
-  auto mem = list[index];
+  auto mem = (*list)[index];
   SemPtr semPtr = static_pointer_cast<Sem>(mem);
   SemPtr newSem = Sem::clone(semPtr);
 
@@ -147,15 +154,74 @@ void MemList::addPrevAddress(int index) {
   newSem->setAddress(addr - step);
   newSem->setDescription("No description");
 
-  list.push_back(newSem);
+  detach().push_back(newSem);
 }
 
 void MemList::shiftAddress(int index, long diff) {
-  auto mem = list[index];
+  auto mem = (*list)[index];
   Address addr = mem->getAddress();
   mem->setAddress(addr + diff);
 }
 
 void MemList::deleteAddress(int index) {
-  list.erase(list.begin() + index);
+  auto& owned = detach();
+  owned.erase(owned.begin() + index);
+}
+
+shared_ptr<const vector<MemPtr>> MemList::sortedByAddress(MemList& list) {
+  auto byAddress = [](const MemPtr& a, const MemPtr& b) {
+    return a->getAddress() < b->getAddress();
+  };
+  if (is_sorted(list.list->begin(), list.list->end(), byAddress)) {
+    return list.list;
+  }
+  auto sorted = make_shared<vector<MemPtr>>(*list.list);
+  stable_sort(sorted->begin(), sorted->end(), byAddress);
+  return sorted;
+}
+
+MemList MemList::intersect(MemList& a, MemList& b) {
+  auto left = sortedByAddress(a);
+  auto right = sortedByAddress(b);
+  vector<MemPtr> result;
+  size_t j = 0;
+  for (auto& mem : *left) {
+    while (j < right->size() && (*right)[j]->getAddress() < mem->getAddress()) j++;
+    if (j < right->size() && (*right)[j]->getAddress() == mem->getAddress()) {
+      result.push_back(mem);
+    }
+  }
+  return MemList(std::move(result));
+}
+
+MemList MemList::unite(MemList& a, MemList& b) {
+  auto left = sortedByAddress(a);
+  auto right = sortedByAddress(b);
+  vector<MemPtr> result;
+  result.reserve(left->size() + right->size());
+  size_t i = 0, j = 0;
+  while (i < left->size() || j < right->size()) {
+    if (j == right->size() || (i < left->size() && (*left)[i]->getAddress() <= (*right)[j]->getAddress())) {
+      Address addr = (*left)[i]->getAddress();
+      result.push_back((*left)[i++]);
+      while (j < right->size() && (*right)[j]->getAddress() == addr) j++;
+    } else {
+      result.push_back((*right)[j++]);
+    }
+  }
+  return MemList(std::move(result));
+}
+
+MemList MemList::subtract(MemList& a, MemList& b) {
+  auto left = sortedByAddress(a);
+  auto right = sortedByAddress(b);
+  vector<MemPtr> result;
+  size_t j = 0;
+  for (auto& mem : *left) {
+    while (j < right->size() && (*right)[j]->getAddress() < mem->getAddress()) j++;
+    if (j == right->size() || (*right)[j]->getAddress() != mem->getAddress()) {
+      result.push_back(mem);
+    }
+  }
+  return MemList(std::move(result));
 }
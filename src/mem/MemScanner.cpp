@@ -1,17 +1,445 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
 #include <iostream>
 #include <unistd.h> //getpagesize()
 #include <utility>
 
 #include "mem/MemScanner.hpp"
 #include "med/MemOperator.hpp"
+#include "med/Metrics.hpp"
 #include "mem/Pem.hpp"
 #include "mem/MemList.hpp"
+#include "mem/PageMap.hpp"
 
 using namespace std;
 
 const int STEP = 1;
-const int CHUNK_SIZE = 128;
+const size_t FILTER_BUCKET_SIZE = 64 * 1024; // Largest single read of a filter bucket
+const size_t FILTER_TASK_CANDIDATES = 4096;
+const size_t FILTER_TASK_BYTES = 1024 * 1024;
 const int ADDRESS_SORTABLE_SIZE = 800;
+const size_t MAX_SCAN_VALUE_SIZE = 256; // Longer value is not checked against zero page
+const size_t PAGEMAP_BATCH = 512;
+const size_t SCAN_TASK_SIZE = 4 * 1024 * 1024; // Maps are split into parts for the workers
+const size_t SCAN_BLOCK_PAGES = 64; // Pages read at once, at most 64 for the bits of the failed pages
+const size_t SCAN_PIPELINE_READERS = 2;
+const size_t SCAN_PIPELINE_BUFFERS = 16; // Blocks in flight between the readers and the workers
+
+// Pagemap of a map is looked up in batches, to find the anonymous pages which are never touched.
+// Such pages are read as zero pages by the kernel, the scan can skip them.
+class ResidentPages {
+public:
+  ResidentPages(pid_t pid, Address start, Address end, bool anonymous) : pageMap(pid) {
+    this->enabled = anonymous && pageMap.isAvailable();
+    this->end = end;
+    batchStart = batchEnd = start;
+  }
+
+  bool isUntouched(Address addr) {
+    if (!enabled) return false;
+
+    size_t pageSize = getpagesize();
+    if (addr < batchStart || addr >= batchEnd) {
+      batchStart = addr;
+      batchEnd = min(end, addr + PAGEMAP_BATCH * pageSize);
+      if (!pageMap.read(batchStart, batchEnd - batchStart, entries)) {
+        enabled = false;
+        return false;
+      }
+    }
+    uint64_t entry = entries[(addr - batchStart) / pageSize];
+    return !PageMap::isPresent(entry) && !PageMap::isSwapped(entry);
+  }
+
+private:
+  PageMap pageMap;
+  bool enabled;
+  Address end;
+  Address batchStart;
+  Address batchEnd;
+  vector<uint64_t> entries;
+};
+
+bool isZeroPage(Byte* page, size_t size) {
+  return page[0] == 0 && memcmp(page, page + 1, size - 1) == 0;
+}
+
+// Counted locally by the filter tasks, then added to the metrics once per chunk
+struct ChunkCounters {
+  size_t comparisons = 0;
+  size_t hits = 0;
+  size_t failed = 0;
+
+  ~ChunkCounters() {
+    Metrics& metrics = Metrics::getInstance();
+    metrics.add(Counter::Comparisons, comparisons);
+    metrics.add(Counter::Hits, hits);
+    metrics.add(Counter::PagesFailed, failed);
+  }
+};
+
+// Filters the buckets of candidates. Each bucket is read once, and all its candidates
+// are matched against the buffer. If the bucket cannot be read as a whole,
+// its candidates are read one by one.
+class BucketFilter {
+public:
+  BucketFilter(MemIO* memio,
+               const vector<MemPtr>& list,
+               const vector<size_t>& order,
+               size_t size,
+               const string& scanType,
+               const BucketMatcher& matcher,
+               ScanProgress& progress) :
+    memio(memio), list(list), order(order), size(size),
+    scanType(scanType), matcher(matcher), progress(progress) {}
+
+  void filter(const vector<FilterBucket>& buckets, size_t first, size_t last, vector<MemPtr>& newList) {
+    MetricsTimer timer("filterChunk");
+    ChunkCounters counters;
+    vector<Byte> buffer;
+    vector<size_t> offsets;
+    vector<Pem*> pems;
+    vector<uint8_t> matched;
+
+    for (size_t i = first; i < last; i++) {
+      auto& bucket = buckets[i];
+      if (progress.isCancelled()) {
+        // Cancelled filter keeps the candidates it has not looked at yet
+        for (size_t k = bucket.begin; k < bucket.end; k++) {
+          newList.push_back(list[order[k]]);
+        }
+        continue;
+      }
+      if (filterBucket(bucket, newList, counters, buffer, offsets, pems, matched)) continue;
+
+      for (size_t k = bucket.begin; k < bucket.end; k++) {
+        FilterBucket single{ k, k + 1, list[order[k]]->getAddress(), size };
+        if (bucket.end - bucket.begin == 1 ||
+            !filterBucket(single, newList, counters, buffer, offsets, pems, matched)) {
+          progress.addBytesScanned(size); // Memory not available
+          counters.failed++;
+        }
+      }
+    }
+  }
+
+private:
+  bool filterBucket(const FilterBucket& bucket,
+                    vector<MemPtr>& newList,
+                    ChunkCounters& counters,
+                    vector<Byte>& buffer,
+                    vector<size_t>& offsets,
+                    vector<Pem*>& pems,
+                    vector<uint8_t>& matched) {
+    buffer.resize(bucket.size);
+    if (!memio->read(bucket.start, buffer.data(), bucket.size)) {
+      return false;
+    }
+
+    size_t count = bucket.end - bucket.begin;
+    offsets.resize(count);
+    pems.resize(count);
+    for (size_t k = 0; k < count; k++) {
+      auto& mem = list[order[bucket.begin + k]];
+      offsets[k] = mem->getAddress() - bucket.start;
+      pems[k] = static_cast<Pem*>(mem.get());
+    }
+    matched.assign(count, 0);
+    matcher(buffer.data(), offsets, pems, matched);
+
+    // The elements are shared with the other named scans and the undo history, so they are not changed
+    size_t hits = 0;
+    for (size_t k = 0; k < count; k++) {
+      if (!matched[k]) continue;
+      PemPtr pem = PemPtr(new Pem(pems[k]->getAddress(), size, memio));
+      memcpy(pem->getData(), buffer.data() + offsets[k], size);
+      pem->setScanType(scanType);
+      pem->rememberValue(buffer.data() + offsets[k], size);
+      newList.push_back(pem);
+      hits++;
+    }
+    progress.addBytesScanned(count * size);
+    progress.addHits(hits);
+    counters.comparisons += count;
+    counters.hits += hits;
+    return true;
+  }
+
+  MemIO* memio;
+  const vector<MemPtr>& list;
+  const vector<size_t>& order;
+  size_t size;
+  string scanType;
+  const BucketMatcher& matcher;
+  ScanProgress& progress;
+};
+
+// Split the maps into parts of at most "size" bytes, so that a large map is scanned by several workers
+Maps splitMaps(Maps& maps, size_t size) {
+  Maps parts;
+  auto& pairs = maps.getMaps();
+  for (size_t i = 0; i < pairs.size(); i++) {
+    for (Address start = std::get<0>(pairs[i]); start < std::get<1>(pairs[i]); start += size) {
+      Address end = min(std::get<1>(pairs[i]), (Address)(start + size));
+      parts.push(AddressPair(start, end), maps.getName(i));
+    }
+  }
+  return parts;
+}
+
+// Pipelined scan of the maps. Reader threads read blocks of pages into a ring of buffers, and compare
+// workers scan the filled buffers, so that the reads overlap the comparisons. A reader waits for a free
+// buffer, so that it does not run ahead of the workers, and the buffers are reused for the whole scan.
+// scanPage(page, address, worker) is called for every page which is not skipped, and returns the number of hits.
+// If a reader or a worker throws, the others stop, and run() throws the first exception.
+class ScanPipeline {
+public:
+  ScanPipeline(ThreadManager* threadManager, MemIO* memio, Maps& tasks, ScanProgress& progress, bool skipZeroPages) :
+    threadManager(threadManager), memio(memio), tasks(tasks), progress(progress), skipZeroPages(skipZeroPages) {
+    pageSize = getpagesize();
+    nextTask = 0;
+    stopped = false;
+
+    // Every reader and worker is a task, so the thread manager must run them all at once
+    if (threadManager->getMaxThreads() < 2) {
+      threadManager->setMaxThreads(2);
+    }
+    size_t threads = threadManager->getMaxThreads();
+    readers = min(SCAN_PIPELINE_READERS, threads / 2);
+    workers = threads - readers;
+    activeReaders = readers;
+  }
+
+  template<typename F>
+  void run(F scanPage) {
+    buffers.resize(SCAN_PIPELINE_BUFFERS);
+    for (size_t i = 0; i < buffers.size(); i++) {
+      buffers[i].resize(SCAN_BLOCK_PAGES * pageSize);
+      freeBuffers.push_back(i);
+    }
+    Metrics::getInstance().add(Counter::Allocations, buffers.size());
+
+    for (size_t i = 0; i < readers; i++) {
+      TMTask* fn = new TMTask();
+      *fn = [this]() {
+        try {
+          read();
+        } catch (...) {
+          fail();
+        }
+      };
+      threadManager->queueTask(fn);
+    }
+    for (size_t i = 0; i < workers; i++) {
+      TMTask* fn = new TMTask();
+      *fn = [this, &scanPage, i]() {
+        try {
+          compare(scanPage, i);
+        } catch (...) {
+          fail();
+        }
+      };
+      threadManager->queueTask(fn);
+    }
+    threadManager->start();
+    threadManager->clear();
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  size_t getWorkers() {
+    return workers;
+  }
+
+private:
+  struct Block {
+    size_t buffer;
+    Address start;
+    size_t pages;
+    uint64_t failed; // Bit of every page which cannot be read
+  };
+
+  void read() {
+    MetricsTimer timer("scanRead");
+    Metrics& metrics = Metrics::getInstance();
+    for (size_t i = nextTask++; i < tasks.size() && !isStopped(); i = nextTask++) {
+      auto& pair = tasks.getMaps()[i];
+      Address end = std::get<1>(pair);
+      // Pagemap of a dump is not available
+      ResidentPages resident(memio->getPid(), std::get<0>(pair), end, tasks.isAnonymous(i) && !memio->getDump());
+
+      Address j = std::get<0>(pair);
+      while (j < end && !isStopped()) {
+        if (resident.isUntouched(j)) {
+          progress.addBytesScanned(pageSize);
+          progress.addPagesSkipped();
+          metrics.add(Counter::PagesSkipped);
+          j += pageSize;
+          continue;
+        }
+
+        // Block of the pages which are touched
+        size_t pages = 1;
+        while (pages < SCAN_BLOCK_PAGES && j + pages * pageSize < end &&
+               !resident.isUntouched(j + pages * pageSize)) {
+          pages++;
+        }
+
+        Block block = { 0, j, pages, 0 };
+        if (!acquireBuffer(block.buffer)) break;
+        Byte* buffer = buffers[block.buffer].data();
+        if (!memio->read(j, buffer, pages * pageSize)) {
+          for (size_t p = 0; p < pages; p++) {
+            if (!memio->read(j + p * pageSize, buffer + p * pageSize, pageSize)) {
+              block.failed |= (uint64_t)1 << p;
+            }
+          }
+        }
+        pushBlock(block);
+        j += pages * pageSize;
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    activeReaders--;
+    blockFilled.notify_all();
+  }
+
+  template<typename F>
+  void compare(F& scanPage, size_t worker) {
+    MetricsTimer timer("scanCompare");
+    Metrics& metrics = Metrics::getInstance();
+    Block block;
+    while (popBlock(block)) {
+      Byte* buffer = buffers[block.buffer].data();
+      for (size_t p = 0; p < block.pages; p++) {
+        Address addr = block.start + p * pageSize;
+        Byte* page = buffer + p * pageSize;
+        progress.addBytesScanned(pageSize);
+        if (block.failed & ((uint64_t)1 << p)) {
+          progress.addPagesSkipped();
+          metrics.add(Counter::PagesFailed);
+          continue;
+        }
+        if (skipZeroPages && isZeroPage(page, pageSize)) {
+          progress.addPagesSkipped();
+          metrics.add(Counter::PagesSkipped);
+          continue;
+        }
+
+        int hits = scanPage(page, addr, worker);
+        progress.addHits(hits);
+        metrics.add(Counter::Hits, hits);
+      }
+      releaseBuffer(block.buffer);
+    }
+  }
+
+  // False when the pipeline is stopped by a failure
+  bool acquireBuffer(size_t& index) {
+    std::unique_lock<std::mutex> lock(mutex);
+    bufferFreed.wait(lock, [this]() {
+        return !freeBuffers.empty() || stopped;
+      });
+    if (stopped) return false;
+    index = freeBuffers.back();
+    freeBuffers.pop_back();
+    return true;
+  }
+
+  void releaseBuffer(size_t index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    freeBuffers.push_back(index);
+    bufferFreed.notify_one();
+  }
+
+  void pushBlock(const Block& block) {
+    std::lock_guard<std::mutex> lock(mutex);
+    filled.push_back(block);
+    blockFilled.notify_one();
+  }
+
+  // False when all the blocks are scanned, or the pipeline is stopped by a failure
+  bool popBlock(Block& block) {
+    std::unique_lock<std::mutex> lock(mutex);
+    blockFilled.wait(lock, [this]() {
+        return !filled.empty() || activeReaders == 0 || stopped;
+      });
+    if (filled.empty() || stopped) return false;
+    block = filled.front();
+    filled.pop_front();
+    return true;
+  }
+
+  bool isStopped() {
+    return stopped || progress.isCancelled();
+  }
+
+  // Keep the first exception, and wake the threads which wait, so that they stop
+  void fail() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!error) {
+      error = std::current_exception();
+    }
+    stopped = true;
+    bufferFreed.notify_all();
+    blockFilled.notify_all();
+  }
+
+  ThreadManager* threadManager;
+  MemIO* memio;
+  Maps& tasks;
+  ScanProgress& progress;
+  bool skipZeroPages;
+  size_t pageSize;
+  size_t readers;
+  size_t workers;
+
+  vector<vector<Byte>> buffers;
+  vector<size_t> freeBuffers;
+  deque<Block> filled;
+  std::atomic<size_t> nextTask;
+  size_t activeReaders;
+  std::atomic<bool> stopped;
+  std::exception_ptr error;
+  std::mutex mutex;
+  std::condition_variable bufferFreed;
+  std::condition_variable blockFilled;
+};
+
+// Hits of a page are appended to the shared list with a single lock
+void appendFound(std::mutex& mutex, vector<MemPtr>& list, vector<MemPtr>& found, ScanProgress& progress) {
+  if (found.empty()) return;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    list.insert(list.end(), found.begin(), found.end());
+  }
+  progress.addFound(found);
+}
+
+size_t mapsTotalSize(Maps& maps) {
+  size_t total = 0;
+  for (auto& pair : maps.getMaps()) {
+    total += std::get<1>(pair) - std::get<0>(pair);
+  }
+  return total;
+}
+
+// Maps are sorted by address
+bool isMapped(Maps& maps, Address addr) {
+  auto& pairs = maps.getMaps();
+  auto it = upper_bound(pairs.begin(), pairs.end(), addr, [](Address a, const AddressPair& pair) {
+      return a < std::get<0>(pair);
+    });
+  if (it == pairs.begin()) return false;
+  --it;
+  return addr < std::get<1>(*it);
+}
 
 MemScanner::MemScanner() {
   pid = 0;
@@ -36,11 +464,28 @@ void MemScanner::initialize() {
   threadManager->setMaxThreads(8);
   memio = new MemIO();
   scope = new AddressPair(0, 0);
+  softDirtyTracking = false;
+  skipZeroPages = true;
 }
 
 void MemScanner::setPid(pid_t pid) {
   this->pid = pid;
   memio->setPid(pid);
+  candidates.clear();
+}
+
+void MemScanner::openDump(const string& filename) {
+  memio->setDump(std::make_shared<MemDump>(filename));
+  pid = 0;
+  softDirtyTracking = false;
+  snapshot.clear();
+  candidates.clear();
+}
+
+void MemScanner::saveDump(const string& filename) {
+  MetricsTimer timer("saveDump");
+  Maps maps = hasScanRanges() ? getRangeMaps() : memio->getMaps();
+  MemDump::save(memio, maps, filename);
 }
 
 pid_t MemScanner::getPid() {
@@ -51,6 +496,22 @@ MemIO* MemScanner::getMemIO() {
   return memio;
 }
 
+ScanProgress& MemScanner::getProgress() {
+  return progress;
+}
+
+bool MemScanner::isSoftDirtyTracking() {
+  return softDirtyTracking;
+}
+
+void MemScanner::setSkipZeroPages(bool value) {
+  skipZeroPages = value;
+}
+
+bool MemScanner::getSkipZeroPages() {
+  return skipZeroPages;
+}
+
 vector<MemPtr> MemScanner::scanInner(Operands& operands,
                                      int size,
                                      Address base,
@@ -108,6 +569,14 @@ vector<MemPtr> MemScanner::filterInner(const vector<MemPtr>& list,
 vector<MemPtr> MemScanner::filterUnknownInner(const vector<MemPtr>& list,
                                               const string& scanType,
                                               const ScanParser::OpType& op) {
+  Operands operands;
+  return filterUnknownInner(list, operands, scanType, op);
+}
+
+vector<MemPtr> MemScanner::filterUnknownInner(const vector<MemPtr>& list,
+                                              Operands& operands,
+                                              const string& scanType,
+                                              const ScanParser::OpType& op) {
   int size = scanTypeToSize(scanType);
   vector<MemPtr> newList;
   for (size_t i = 0; i < list.size(); i++) {
@@ -115,7 +584,7 @@ vector<MemPtr> MemScanner::filterUnknownInner(const vector<MemPtr>& list,
     PemPtr pem = static_pointer_cast<Pem>(list[i]);
     Byte* oldValue = pem->recallValuePtr();
 
-    if (memCompare(mem->getData(), size, oldValue, size, op)) {
+    if (compareChange(mem->getData(), oldValue, size, operands, scanType, op)) {
       PemPtr newPem = Pem::convertToPemPtr(mem, memio);
       newPem->setScanType(scanType);
       newPem->rememberValue(mem->getData(), size);
@@ -131,8 +600,10 @@ vector<MemPtr> MemScanner::scan(Operands& operands,
                                 const ScanParser::OpType& op,
                                 bool fastScan,
                                 int lastDigit) {
-  if (hasScope()) {
-    return scanByScope(operands, size, scanType, op, fastScan, lastDigit);
+  MetricsTimer timer("scan");
+  candidates.clear();
+  if (hasScanRanges()) {
+    return scanByRanges(operands, size, scanType, op, fastScan, lastDigit);
   }
   else {
     return scanByMaps(operands, size, scanType, op, fastScan, lastDigit);
@@ -140,8 +611,10 @@ vector<MemPtr> MemScanner::scan(Operands& operands,
 }
 
 vector<MemPtr> MemScanner::scan(ScanCommand &scanCommand) {
-  if (hasScope()) {
-    return scanByScope(scanCommand);
+  MetricsTimer timer("scan");
+  candidates.clear();
+  if (hasScanRanges()) {
+    return scanByRanges(scanCommand);
   }
   return scanByMaps(scanCommand);
 }
@@ -152,26 +625,56 @@ vector<MemPtr> MemScanner::scanByMaps(Operands& operands,
                                       const ScanParser::OpType& op,
                                       bool fastScan,
                                       int lastDigit) {
+  Maps maps = getMemIO()->getMaps();
+  return scanMaps(maps, operands, size, scanType, op, fastScan, lastDigit);
+}
+
+vector<MemPtr> MemScanner::scanByMaps(ScanCommand &scanCommand) {
+  Maps maps = getMemIO()->getMaps();
+  return scanMaps(maps, scanCommand);
+}
+
+vector<MemPtr> MemScanner::scanByRanges(Operands& operands,
+                                       int size,
+                                       const string& scanType,
+                                       const ScanParser::OpType& op,
+                                       bool fastScan,
+                                       int lastDigit) {
+  Maps maps = getRangeMaps();
+  return scanMaps(maps, operands, size, scanType, op, fastScan, lastDigit);
+}
+
+vector<MemPtr> MemScanner::scanByRanges(ScanCommand &scanCommand) {
+  Maps maps = getRangeMaps();
+  return scanMaps(maps, scanCommand);
+}
+
+vector<MemPtr> MemScanner::scanMaps(Maps& maps,
+                                    Operands& operands,
+                                    int size,
+                                    const string& scanType,
+                                    const ScanParser::OpType& op,
+                                    bool fastScan,
+                                    int lastDigit) {
   vector<MemPtr> list;
 
-  Maps maps = getMaps(pid);
-  int memFd = getMem(pid);
+  Maps tasks = splitMaps(maps, SCAN_TASK_SIZE);
   MemIO* memio = getMemIO();
 
   auto& mutex = listMutex;
-  std::mutex fdMutex;
+  auto& progress = this->progress;
+  progress.start(mapsTotalSize(tasks));
 
-  for (size_t i = 0; i < maps.size(); i++) {
-    TMTask* fn = new TMTask();
-    *fn = [memio, &mutex, &list, &maps, i, memFd, &fdMutex, &operands, size, scanType, op, fastScan, lastDigit]() {
-            scanMap(memio, mutex, list, maps, i, memFd, fdMutex, operands, size, scanType, op, fastScan, lastDigit);
-          };
-    threadManager->queueTask(fn);
-  }
-  threadManager->start();
-  threadManager->clear();
+  // Zero page can be skipped if the value cannot match zero
+  Byte zero[MAX_SCAN_VALUE_SIZE] = { 0 };
+  bool skipZeroPages = this->skipZeroPages &&
+    (size_t)size <= MAX_SCAN_VALUE_SIZE && !memCompare(zero, size, operands, op);
 
-  close(memFd);
+  ScanPipeline pipeline(threadManager, memio, tasks, progress, skipZeroPages);
+  pipeline.run([&](Byte* page, Address start, size_t) {
+      return scanPage(memio, mutex, list, progress, page, start, operands, size, scanType, op, fastScan, lastDigit);
+    });
+  progress.finish();
 
   if (list.size() <= ADDRESS_SORTABLE_SIZE) {
     return MemList::sortByAddress(list);
@@ -179,27 +682,25 @@ vector<MemPtr> MemScanner::scanByMaps(Operands& operands,
   return list;
 }
 
-vector<MemPtr> MemScanner::scanByMaps(ScanCommand &scanCommand) {
+vector<MemPtr> MemScanner::scanMaps(Maps& maps, ScanCommand &scanCommand) {
   vector<MemPtr> list;
 
-  Maps maps = getMaps(pid);
-  int memFd = getMem(pid);
+  Maps tasks = splitMaps(maps, SCAN_TASK_SIZE);
   MemIO* memio = getMemIO();
 
   auto& mutex = listMutex;
-  std::mutex fdMutex;
+  auto& progress = this->progress;
+  progress.start(mapsTotalSize(tasks));
 
-  for (size_t i = 0; i < maps.size(); i++) {
-    TMTask* fn = new TMTask();
-    *fn = [memio, &mutex, &list, &maps, i, memFd, &fdMutex, &scanCommand]() {
-            scanMap(memio, mutex, list, maps, i, memFd, fdMutex, scanCommand);
-          };
-    threadManager->queueTask(fn);
-  }
-  threadManager->start();
-  threadManager->clear();
+  Byte zero[MAX_SCAN_VALUE_SIZE] = { 0 };
+  bool skipZeroPages = this->skipZeroPages &&
+    scanCommand.getSize() <= MAX_SCAN_VALUE_SIZE && !scanCommand.match(zero);
 
-  close(memFd);
+  ScanPipeline pipeline(threadManager, memio, tasks, progress, skipZeroPages);
+  pipeline.run([&](Byte* page, Address start, size_t) {
+      return scanPage(memio, mutex, list, progress, page, start, scanCommand);
+    });
+  progress.finish();
 
   if (list.size() <= ADDRESS_SORTABLE_SIZE) {
     return MemList::sortByAddress(list);
@@ -207,74 +708,279 @@ vector<MemPtr> MemScanner::scanByMaps(ScanCommand &scanCommand) {
   return list;
 }
 
-vector<MemPtr> MemScanner::scanByScope(Operands& operands,
-                                       int size,
-                                       const string& scanType,
-                                       const ScanParser::OpType& op,
-                                       bool fastScan,
-                                       int lastDigit) {
-  vector<MemPtr> list;
-  auto start = scope->first;
-  auto end = scope->second;
-  int fd = getMem(pid);
+vector<GroupMatch> MemScanner::scanGroup(GroupScan& group) {
+  MetricsTimer timer("scanGroup");
+  vector<GroupMatch> matches;
+  Maps maps = hasScanRanges() ? getRangeMaps() : getMemIO()->getMaps();
+  Maps tasks = splitMaps(maps, SCAN_TASK_SIZE);
+  MemIO* memio = getMemIO();
   auto& mutex = listMutex;
-
-  // TODO: Refactor this, since similar to scanMap()
-  for (Address j = start; j < end; j += getpagesize()) {
-    if (lseek(fd, j, SEEK_SET) == -1) {
-      continue;
+  auto& progress = this->progress;
+  progress.start(mapsTotalSize(tasks));
+
+  for (size_t i = 0; i < tasks.size(); i++) {
+    // Each part is read with the span before and after it, within the same map
+    Address from = std::get<0>(tasks.getMaps()[i]);
+    Address to = std::get<1>(tasks.getMaps()[i]);
+    Address readStart = from, readEnd = to;
+    for (auto& pair : maps.getMaps()) {
+      if (from >= std::get<0>(pair) && to <= std::get<1>(pair)) {
+        readStart = max(std::get<0>(pair), from - min(from, (Address)group.getSpan()));
+        readEnd = min(std::get<1>(pair), to + group.getSpan());
+        break;
+      }
     }
 
-    Byte* page = new Byte[getpagesize()];
+    TMTask* fn = new TMTask();
+    *fn = [memio, &mutex, &matches, &progress, &group, from, to, readStart, readEnd]() {
+      if (progress.isCancelled()) return;
+      Metrics& metrics = Metrics::getInstance();
+      vector<Byte> buffer(readEnd - readStart);
+      vector<GroupMatch> found;
+      if (memio->read(readStart, buffer.data(), buffer.size())) {
+        group.scan(buffer.data(), buffer.size(), readStart, from, to, found);
+      } else {
+        // Read page by page, and scan every run of the readable pages, so that only the others are skipped
+        Address pageSize = getpagesize();
+        Address runStart = readStart;
+        size_t failed = 0;
+        for (Address addr = readStart; addr < readEnd;) {
+          Address next = min(readEnd, (addr / pageSize + 1) * pageSize);
+          if (!memio->read(addr, buffer.data() + (addr - readStart), next - addr)) {
+            if (addr > runStart) {
+              group.scan(buffer.data() + (runStart - readStart), addr - runStart, runStart, from, to, found);
+            }
+            if (addr >= from && addr < to) failed++;
+            runStart = next;
+          }
+          addr = next;
+        }
+        if (readEnd > runStart) {
+          group.scan(buffer.data() + (runStart - readStart), readEnd - runStart, runStart, from, to, found);
+        }
+        progress.addPagesSkipped(failed);
+        metrics.add(Counter::PagesFailed, failed);
+      }
+      progress.addBytesScanned(to - from);
+      progress.addHits(found.size());
+      metrics.add(Counter::Hits, found.size());
 
-    if (read(fd, page, getpagesize()) == -1) {
-      continue;
-    }
-    scanPage(memio, mutex, list, page, j, operands, size, scanType, op, fastScan, lastDigit);
+      std::lock_guard<std::mutex> lock(mutex);
+      matches.insert(matches.end(), found.begin(), found.end());
+    };
+    threadManager->queueTask(fn);
+  }
+  threadManager->start();
+  threadManager->clear();
+  progress.finish();
+
+  sort(matches.begin(), matches.end(), [](const GroupMatch& a, const GroupMatch& b) {
+    return a.anchor < b.anchor;
+  });
+  return matches;
+}
 
-    delete[] page;
+StrideMatch MemScanner::detectStride(StrideDetector& detector, Address anchor) {
+  MetricsTimer timer("detectStride");
+  Maps maps = getMemIO()->getMaps();
+  for (auto& pair : maps.getMaps()) {
+    if (anchor < std::get<0>(pair) || anchor >= std::get<1>(pair)) continue;
+
+    // The elements are looked for within the map of the anchor only
+    Address start = max(std::get<0>(pair), anchor - min(anchor, (Address)detector.getExtent()));
+    Address end = min(std::get<1>(pair), anchor + detector.getExtent());
+    vector<Byte> buffer(end - start);
+    bool success = getMemIO()->read(start, buffer.data(), buffer.size());
+    if (!success) {
+      throw MedException("Failed to read memory around " + intToHex(anchor));
+    }
+    return detector.detect(buffer.data(), buffer.size(), start, anchor);
   }
+  throw MedException("Address is not mapped: " + intToHex(anchor));
+}
 
-  if (list.size() <= ADDRESS_SORTABLE_SIZE) {
-    return MemList::sortByAddress(list);
+void MemScanner::scanPointers(PointerMap& pointerMap, Address target) {
+  MetricsTimer timer("scanPointers");
+  Maps allMaps = getMemIO()->getMaps();
+  Maps maps = hasScanRanges() ? getRangeMaps() : allMaps;
+  Maps tasks = splitMaps(maps, SCAN_TASK_SIZE);
+  MemIO* memio = getMemIO();
+  auto& progress = this->progress;
+  progress.start(mapsTotalSize(tasks));
+
+  // Every worker keeps its own pointers, which are sorted by source after the scan
+  ScanPipeline pipeline(threadManager, memio, tasks, progress, true);
+  vector<vector<PointerEntry>> results(pipeline.getWorkers());
+  pipeline.run([&allMaps, &results](Byte* page, Address start, size_t worker) {
+      auto& found = results[worker];
+      size_t hits = 0;
+      for (size_t k = 0; k + sizeof(Address) <= (size_t)getpagesize(); k += sizeof(Address)) {
+        Address value;
+        memcpy(&value, page + k, sizeof(value));
+        if (value && isMapped(allMaps, value)) {
+          found.push_back(PointerEntry{ start + k, value });
+          hits++;
+        }
+      }
+      return (int)hits;
+    });
+  progress.finish();
+
+  vector<PointerEntry> entries;
+  for (auto& found : results) {
+    entries.insert(entries.end(), found.begin(), found.end());
   }
-  return list;
+  sort(entries.begin(), entries.end(), [](const PointerEntry& a, const PointerEntry& b) {
+      return a.source < b.source;
+    });
+  pointerMap.set(allMaps, entries, target);
 }
 
-vector<MemPtr> MemScanner::scanByScope(ScanCommand &scanCommand) {
-  vector<MemPtr> list;
-  auto start = scope->first;
-  auto end = scope->second;
-  int fd = getMem(pid);
-  auto& mutex = listMutex;
+Signature MemScanner::makeSignature(Address addr, size_t valueSize) {
+  MetricsTimer timer("makeSignature");
+  size_t pageSize = getpagesize();
+  Address page = addr / pageSize * pageSize;
+  if (addr + valueSize > page + pageSize) {
+    throw MedException("Signature of the value across pages is not supported");
+  }
+  vector<Byte> buffer(pageSize);
+  bool success = getMemIO()->read(page, buffer.data(), pageSize);
+  if (!success) {
+    throw MedException("Failed to read memory at " + intToHex(addr));
+  }
 
-  // TODO: Refactor this, since similar to scanMap()
-  for (Address j = start; j < end; j += getpagesize()) {
-    if (lseek(fd, j, SEEK_SET) == -1) {
-      continue;
+  // The value itself changes, and the pointers change whenever the process restarts
+  vector<bool> wildcards(pageSize, false);
+  fill(wildcards.begin() + (addr - page), wildcards.begin() + (addr - page + valueSize), true);
+  Maps allMaps = getMemIO()->getMaps();
+  for (size_t i = 0; i + sizeof(Address) <= pageSize; i += sizeof(Address)) {
+    Address value;
+    memcpy(&value, buffer.data() + i, sizeof(value));
+    if (value && isMapped(allMaps, value)) {
+      fill(wildcards.begin() + i, wildcards.begin() + i + sizeof(Address), true);
+    }
+  }
+
+  // Grow the window by 8 bytes at a time, within the page, until the pattern matches only the address.
+  // The first test scans the memory. Later tests filter the previous matches on both sides.
+  // The sides are taken alternately, unless one side leaves half the matches of the other.
+  Maps maps = hasScanRanges() ? getRangeMaps() : getMemIO()->getMaps();
+  MemIO* memio = getMemIO();
+  size_t start = (addr - page) / SIGNATURE_ALIGN * SIGNATURE_ALIGN;
+  size_t end = min(pageSize, (addr - page + valueSize + SIGNATURE_ALIGN - 1) / SIGNATURE_ALIGN * SIGNATURE_ALIGN);
+  auto makeWindow = [&](size_t from, size_t to) {
+    vector<bool> window(wildcards.begin() + from, wildcards.begin() + to);
+    return Signature::fromBytes(buffer.data() + from, window, (long)(addr - page - from));
+  };
+  auto fixedBytes = [&](size_t from, size_t to) {
+    return (size_t)count(wildcards.begin() + from, wildcards.begin() + to, false);
+  };
+  // Matches of the window, from the matches of the window "shift" bytes to the right
+  auto filterShifted = [&](const vector<MemPtr>& list, size_t from, size_t to, size_t shift) {
+    vector<MemPtr> shifted;
+    for (auto& mem : list) {
+      shifted.push_back(PemPtr(new Pem(mem->getAddress() - shift, to - from, memio)));
+    }
+    ScanCommand command(makeWindow(from, to).getPattern());
+    return filter(shifted, command);
+  };
+
+  vector<MemPtr> candidates;
+  bool scanned = false;
+  bool growRight = true;
+  for (;;) {
+    if (!scanned && fixedBytes(start, end) >= SIGNATURE_MIN_FIXED) {
+      ScanCommand command(makeWindow(start, end).getPattern());
+      candidates = scanMaps(maps, command);
+      scanned = true;
+    }
+    if (scanned) {
+      if (candidates.empty()) {
+        throw MedException("Signature does not match " + intToHex(addr) + ", which may be out of the scan ranges");
+      }
+      if (candidates.size() == 1 && candidates[0]->getAddress() == page + start) {
+        return makeWindow(start, end);
+      }
     }
 
-    Byte* page = new Byte[getpagesize()];
+    bool canGrow = end - start < SIGNATURE_MAX_SIZE;
+    bool canGrowRight = canGrow && end + SIGNATURE_ALIGN <= pageSize;
+    bool canGrowLeft = canGrow && start >= SIGNATURE_ALIGN;
+    if (!canGrowRight && !canGrowLeft) {
+      throw MedException("No unique signature within " + to_string(end - start) + " bytes around " + intToHex(addr));
+    }
 
-    if (read(fd, page, getpagesize()) == -1) {
+    if (!scanned) {
+      // Not enough fixed bytes to test yet
+      if ((growRight && canGrowRight) || !canGrowLeft) {
+        end += SIGNATURE_ALIGN;
+      } else {
+        start -= SIGNATURE_ALIGN;
+      }
+      growRight = !growRight;
       continue;
     }
-    scanPage(memio, mutex, list, page, j, scanCommand);
 
-    delete[] page;
+    vector<MemPtr> right, left;
+    if (canGrowRight) {
+      right = filterShifted(candidates, start, end + SIGNATURE_ALIGN, 0);
+    }
+    if (canGrowLeft) {
+      left = filterShifted(candidates, start - SIGNATURE_ALIGN, end, SIGNATURE_ALIGN);
+    }
+    if (canGrowRight && canGrowLeft) {
+      // Balanced growth, unless one side is clearly better
+      if (right.size() * 2 <= left.size()) {
+        growRight = true;
+      } else if (left.size() * 2 <= right.size()) {
+        growRight = false;
+      }
+    } else {
+      growRight = canGrowRight;
+    }
+    if (growRight) {
+      end += SIGNATURE_ALIGN;
+      candidates = right;
+    } else {
+      start -= SIGNATURE_ALIGN;
+      candidates = left;
+    }
+    growRight = !growRight;
   }
+}
 
-  if (list.size() <= ADDRESS_SORTABLE_SIZE) {
-    return MemList::sortByAddress(list);
+vector<Address> MemScanner::resolveSignature(Signature& signature) {
+  MetricsTimer timer("resolveSignature");
+  ScanCommand command(signature.getPattern());
+  Maps maps = hasScanRanges() ? getRangeMaps() : getMemIO()->getMaps();
+  auto list = scanMaps(maps, command);
+
+  vector<Address> addresses;
+  for (auto& mem : list) {
+    addresses.push_back(mem->getAddress() + signature.getOffset());
   }
-  return list;
+  sort(addresses.begin(), addresses.end());
+  return addresses;
 }
 
+Maps MemScanner::getRangeMaps() {
+  ScanRanges effective = ranges;
+  if (scope->first && scope->second) {
+    effective.addInterval(scope->first, scope->second);
+  }
+  Maps maps = getMemIO()->getMaps();
+  return effective.apply(maps);
+}
 
 vector<MemPtr>& MemScanner::saveSnapshot(const vector<MemPtr>& baseList) {
+  MetricsTimer timer("saveSnapshot");
   snapshot.clear();
-  if (hasScope()) {
-    return saveSnapshotByScope();
+  candidates.clear();
+
+  // Clear before reading the snapshot, so that any later write marks the page soft-dirty
+  softDirtyTracking = !memio->getDump() && PageMap::isSoftDirtySupported() && PageMap::clearSoftDirty(pid);
+  if (hasScanRanges()) {
+    return saveSnapshotByRanges();
   }
   else {
     return saveSnapshotByList(baseList);
@@ -285,116 +991,48 @@ vector<MemPtr>& MemScanner::saveSnapshotByList(const vector<MemPtr>& baseList) {
   if (!baseList.size()) {
     throw EmptyListException("Should not scan unknown with empty list");
   }
-  Maps allMaps = getMaps(pid);
+  Maps allMaps = getMemIO()->getMaps();
   Maps maps = getInterestedMaps(allMaps, baseList);
 
   MemIO* memio = getMemIO();
+  progress.start(mapsTotalSize(maps));
 
   for (size_t i = 0; i < maps.size(); i++) {
-    saveSnapshotMap(memio, snapshot, maps, i);
+    saveSnapshotMap(memio, snapshot, maps, i, progress);
   }
+  progress.finish();
   return snapshot;
 }
 
-vector<MemPtr>& MemScanner::saveSnapshotByScope() {
-  int size = getpagesize();
+vector<MemPtr>& MemScanner::saveSnapshotByRanges() {
+  Maps maps = getRangeMaps();
+  progress.start(mapsTotalSize(maps));
 
-  auto start = scope->first;
-  auto end = scope->second;
-  for (Address j = start; j < end; j += size) {
-    try {
-      MemPtr mem = memio->read(j, size);
-      snapshot.push_back(mem);
-    } catch(MedException& ex) {
-      cerr << ex.getMessage() << endl;
-    }
+  for (size_t i = 0; i < maps.size(); i++) {
+    saveSnapshotMap(memio, snapshot, maps, i, progress);
   }
+  progress.finish();
   return snapshot;
 }
 
-void MemScanner::scanMap(MemIO* memio,
-                         std::mutex& mutex,
-                         vector<MemPtr>& list,
-                         Maps& maps,
-                         int mapIndex,
-                         int fd,
-                         std::mutex& fdMutex,
-                         Operands& operands,
-                         int size,
-                         const string& scanType,
-                         const ScanParser::OpType& op,
-                         bool fastScan,
-                         int lastDigit) {
-  auto& pairs = maps.getMaps();
-  auto& pair = pairs[mapIndex];
-  for (Address j = std::get<0>(pair); j < std::get<1>(pair); j += getpagesize()) {
-    Byte* page = new Byte[getpagesize()]; //For block of memory
-
-    fdMutex.lock();
-    if (lseek(fd, j, SEEK_SET) == -1) {
-      delete[] page;
-      fdMutex.unlock();
-      continue;
-    }
-    if (read(fd, page, getpagesize()) == -1) {
-      delete[] page;
-      fdMutex.unlock();
-      continue;
-    }
-    fdMutex.unlock();
-
-    scanPage(memio, mutex, list, page, j, operands, size, scanType, op, fastScan, lastDigit);
-
-    delete[] page;
-  }
-}
-
-void MemScanner::scanMap(MemIO* memio,
-                         std::mutex& mutex,
-                         vector<MemPtr>& list,
-                         Maps& maps,
-                         int mapIndex,
-                         int fd,
-                         std::mutex& fdMutex,
-                         ScanCommand &scanCommand) {
-  auto& pairs = maps.getMaps();
-  auto& pair = pairs[mapIndex];
-  for (Address j = std::get<0>(pair); j < std::get<1>(pair); j += getpagesize()) {
-    Byte* page = new Byte[getpagesize()]; //For block of memory
-
-    fdMutex.lock();
-    if (lseek(fd, j, SEEK_SET) == -1) {
-      delete[] page;
-      fdMutex.unlock();
-      continue;
-    }
-    if (read(fd, page, getpagesize()) == -1) {
-      delete[] page;
-      fdMutex.unlock();
-      continue;
-    }
-    fdMutex.unlock();
-
-    scanPage(memio, mutex, list, page, j, scanCommand);
-
-    delete[] page;
-  }
-}
-
 void MemScanner::saveSnapshotMap(MemIO* memio,
                                  vector<MemPtr>& snapshot,
                                  Maps& maps,
-                                 int mapIndex) {
+                                 int mapIndex,
+                                 ScanProgress& progress) {
   int size = getpagesize();
 
   auto& pairs = maps.getMaps();
   auto& pair = pairs[mapIndex];
   for (Address j = std::get<0>(pair); j < std::get<1>(pair); j += size) {
+    if (progress.isCancelled()) break;
+    progress.addBytesScanned(size);
     try {
       MemPtr mem = memio->read(j, size);
       snapshot.push_back(mem);
     } catch(MedException& ex) {
-      cerr << ex.getMessage() << endl;
+      progress.addPagesSkipped();
+      Metrics::getInstance().add(Counter::PagesFailed);
     }
   }
 }
@@ -413,18 +1051,25 @@ bool skipAddressByLastDigit(long address, int lastDigit) {
   return false;
 }
 
-void MemScanner::scanPage(MemIO* memio,
-                          std::mutex& mutex,
-                          vector<MemPtr>& list,
-                          Byte* page,
-                          Address start,
-                          Operands& operands,
-                          int size,
-                          const string& scanType,
-                          const ScanParser::OpType& op,
-                          bool fastScan,
-                          int lastDigit) {
+int MemScanner::scanPage(MemIO* memio,
+                         std::mutex& mutex,
+                         vector<MemPtr>& list,
+                         ScanProgress& progress,
+                         Byte* page,
+                         Address start,
+                         Operands& operands,
+                         int size,
+                         const string& scanType,
+                         const ScanParser::OpType& op,
+                         bool fastScan,
+                         int lastDigit) {
   int scanTypeSize = scanTypeToSize(scanType);
+  if (ScanParser::isApproxOperator(op)) {
+    return scanPageApprox(memio, mutex, list, progress, page, start, operands, size, scanType, fastScan, lastDigit);
+  }
+
+  vector<MemPtr> found;
+  size_t comparisons = 0;
   for (int k = 0; k <= getpagesize() - size; k += STEP) {
     if (scanType != SCAN_TYPE_STRING &&
         skipAddressByFastScan((Address)(start + k), scanTypeSize, fastScan)) {
@@ -434,50 +1079,75 @@ void MemScanner::scanPage(MemIO* memio,
       continue;
     }
 
-    try {
-      if (memCompare(page + k, size, operands, op)) {
-        MemPtr mem = memio->read((Address)(start + k), size);
-
-        PemPtr pem = Pem::convertToPemPtr(mem, memio);
-        pem->setScanType(scanType);
-        pem->rememberValue(page + k, size);
+    comparisons++;
+    if (memCompare(page + k, size, operands, op)) {
+      // Value is taken from the page, no need to read again
+      PemPtr pem = PemPtr(new Pem((Address)(start + k), size, memio));
+      pem->setScanType(scanType);
+      pem->rememberValue(page + k, size);
+      found.push_back(pem);
+    }
+  }
+  appendFound(mutex, list, found, progress);
+  Metrics::getInstance().add(Counter::Comparisons, comparisons);
+  return found.size();
+}
 
-        mutex.lock();
-        list.push_back(pem);
-        mutex.unlock();
-      }
-    } catch(MedException& ex) {
-      cerr << ex.getMessage() << endl;
+int MemScanner::scanPageApprox(MemIO* memio,
+                               std::mutex& mutex,
+                               vector<MemPtr>& list,
+                               ScanProgress& progress,
+                               Byte* page,
+                               Address start,
+                               Operands& operands,
+                               int size,
+                               const string& scanType,
+                               bool fastScan,
+                               int lastDigit) {
+  vector<MemPtr> found;
+  vector<size_t> offsets;
+  int step = fastScan ? size : STEP;
+  memApproxScan(page, getpagesize(), size, step,
+                operands.getLowerBound(), operands.getUpperBound(), offsets);
+  Metrics::getInstance().add(Counter::Comparisons, (getpagesize() - size) / step + 1);
+
+  for (auto k : offsets) {
+    if (skipAddressByLastDigit((Address)(start + k), lastDigit)) {
+      continue;
     }
+    PemPtr pem = PemPtr(new Pem((Address)(start + k), size, memio));
+    pem->setScanType(scanType);
+    pem->rememberValue(page + k, size);
+    found.push_back(pem);
   }
+  appendFound(mutex, list, found, progress);
+  return found.size();
 }
 
-void MemScanner::scanPage(MemIO* memio,
-                          std::mutex& mutex,
-                          vector<MemPtr>& list,
-                          Byte* page,
-                          Address start,
-                          ScanCommand &scanCommand) {
+int MemScanner::scanPage(MemIO* memio,
+                         std::mutex& mutex,
+                         vector<MemPtr>& list,
+                         ScanProgress& progress,
+                         Byte* page,
+                         Address start,
+                         ScanCommand &scanCommand) {
+  vector<MemPtr> found;
+  size_t comparisons = 0;
   size_t size = scanCommand.getSize();
   for (size_t k = 0; k <= getpagesize() - size; k += STEP) {
     if ((Address)(start + k) % 8 != 0) continue; // NOTE: BlockAlign to 8
 
-    try {
-      if (scanCommand.match(page + k)) {
-        MemPtr mem = memio->read((Address)(start + k), size);
-
-        PemPtr pem = Pem::convertToPemPtr(mem, memio);
-        pem->setScanType(SCAN_TYPE_INT_8); // NOTE: Set to 8
-        pem->rememberValue(page + k, size);
-
-        mutex.lock();
-        list.push_back(pem);
-        mutex.unlock();
-      }
-    } catch(MedException& ex) {
-      cerr << ex.getMessage() << endl;
+    comparisons++;
+    if (scanCommand.match(page + k)) {
+      PemPtr pem = PemPtr(new Pem((Address)(start + k), size, memio));
+      pem->setScanType(SCAN_TYPE_INT_8); // NOTE: Set to 8
+      pem->rememberValue(page + k, size);
+      found.push_back(pem);
     }
   }
+  appendFound(mutex, list, found, progress);
+  Metrics::getInstance().add(Counter::Comparisons, comparisons);
+  return found.size();
 }
 
 vector<MemPtr> MemScanner::filter(const vector<MemPtr>& list,
@@ -485,162 +1155,213 @@ vector<MemPtr> MemScanner::filter(const vector<MemPtr>& list,
                                   int size,
                                   const string& scanType,
                                   const ScanParser::OpType& op) {
-  vector<MemPtr> newList;
-
-  auto& mutex = listMutex;
-
-  for (size_t i = 0; i < list.size(); i += CHUNK_SIZE) {
-    TMTask* fn = new TMTask();
-    *fn = [&mutex, &list, &newList, i, &operands, size, scanType, op]() {
-            filterByChunk(mutex, list, newList, i, operands, size, scanType, op);
-          };
-    threadManager->queueTask(fn);
+  MetricsTimer timer("filter");
+  if (!candidates.empty()) {
+    progress.start(candidates.getPageCount() * getpagesize());
+    candidates.filter(memio, size, progress, [&operands, size, op](const Byte* newValue, const Byte*) {
+        return memCompare(newValue, size, operands, op);
+      });
+    progress.finish();
+    return takeCandidates(scanType);
   }
-  threadManager->start();
-  threadManager->clear();
-
-  if (newList.size() <= ADDRESS_SORTABLE_SIZE) {
-    return MemList::sortByAddress(newList);
-  }
-  return newList;
+  return filterByBuckets(list, size, scanType,
+    [&operands, size, op](const Byte* values, const vector<size_t>& offsets,
+                          const vector<Pem*>&, vector<uint8_t>& matched) {
+      if (memGatherCompare(values, offsets, size, operands, op, matched)) return;
+      for (size_t i = 0; i < offsets.size(); i++) {
+        matched[i] = memCompare(values + offsets[i], size, operands, op);
+      }
+    });
 }
 
 vector<MemPtr> MemScanner::filter(const vector<MemPtr> &list,
                                   ScanCommand &scanCommand) {
-  vector<MemPtr> newList;
-
-  auto& mutex = listMutex;
-
-  for (size_t i = 0; i < list.size(); i += CHUNK_SIZE) {
-    TMTask* fn = new TMTask();
-    *fn = [&mutex, &list, &newList, i, &scanCommand]() {
-            filterByChunk(mutex, list, newList, i, scanCommand);
-          };
-    threadManager->queueTask(fn);
+  MetricsTimer timer("filter");
+  if (!candidates.empty()) {
+    progress.start(candidates.getPageCount() * getpagesize());
+    candidates.filter(memio, scanCommand.getSize(), progress, [&scanCommand](const Byte* newValue, const Byte*) {
+        return scanCommand.match((Byte*)newValue);
+      });
+    progress.finish();
+    return takeCandidates(SCAN_TYPE_INT_8);
   }
-  threadManager->start();
-  threadManager->clear();
+  return filterByBuckets(list, scanCommand.getSize(), SCAN_TYPE_INT_8,
+    [&scanCommand](const Byte* values, const vector<size_t>& offsets,
+                   const vector<Pem*>&, vector<uint8_t>& matched) {
+      for (size_t i = 0; i < offsets.size(); i++) {
+        matched[i] = scanCommand.match((Byte*)values + offsets[i]);
+      }
+    });
+}
 
-  if (newList.size() <= ADDRESS_SORTABLE_SIZE) {
-    return MemList::sortByAddress(newList);
-  }
-  return newList;
+vector<MemPtr> MemScanner::filterUnknown(const vector<MemPtr>& list,
+                                         const string& scanType,
+                                         const ScanParser::OpType& op,
+                                         bool fastScan) {
+  Operands operands;
+  return filterUnknown(list, operands, scanType, op, fastScan);
 }
 
 vector<MemPtr> MemScanner::filterUnknown(const vector<MemPtr>& list,
+                                         Operands& operands,
                                          const string& scanType,
                                          const ScanParser::OpType& op,
                                          bool fastScan) {
+  MetricsTimer timer("filterUnknown");
   if (snapshot.size()) {
-    return filterSnapshot(scanType, op, fastScan);
+    return filterSnapshot(operands, scanType, op, fastScan);
+  }
+  else if (!candidates.empty()) {
+    return filterCandidates(operands, scanType, op);
   }
   else {
-    return filterUnknownWithList(list, scanType, op);
+    return filterUnknownWithList(list, operands, scanType, op);
   }
 }
 
+vector<MemPtr> MemScanner::filterCandidates(Operands& operands,
+                                            const string& scanType,
+                                            const ScanParser::OpType& op) {
+  int size = scanTypeToSize(scanType);
+  if ((size_t)size != candidates.getValueSize()) {
+    throw MedException("Filter by the type of the unknown scan, " + to_string(candidates.getValueSize()) + " bytes");
+  }
+  progress.start(candidates.getPageCount() * getpagesize());
+  candidates.filter(memio, size, progress, [&operands, size, &scanType, op](const Byte* newValue, const Byte* oldValue) {
+      return compareChange((Byte*)newValue, (Byte*)oldValue, size, operands, scanType, op);
+    });
+  progress.finish();
+  return takeCandidates(scanType);
+}
+
+vector<MemPtr> MemScanner::takeCandidates(const string& scanType) {
+  vector<MemPtr> list = candidates.toList(memio, scanType, CANDIDATE_LIST_MAX);
+  if (candidates.size() <= CANDIDATE_LIST_MAX) {
+    candidates.clear();
+  }
+  return list;
+}
+
+size_t MemScanner::getCandidateCount() {
+  return candidates.size();
+}
+
+CandidateSet& MemScanner::getCandidates() {
+  return candidates;
+}
+
+void MemScanner::clearCandidates() {
+  candidates.clear();
+}
+
 vector<MemPtr> MemScanner::filterUnknownWithList(const vector<MemPtr>& list,
+                                                 Operands& operands,
                                                  const string& scanType,
                                                  const ScanParser::OpType& op) {
-  vector<MemPtr> newList;
+  int size = scanTypeToSize(scanType);
+  return filterByBuckets(list, size, scanType,
+    [&operands, size, scanType, op](const Byte* values, const vector<size_t>& offsets,
+                                    const vector<Pem*>& pems, vector<uint8_t>& matched) {
+      for (size_t i = 0; i < offsets.size(); i++) {
+        Byte* oldValue = pems[i]->recallValuePtr();
+        matched[i] = oldValue && compareChange((Byte*)values + offsets[i], oldValue, size, operands, scanType, op);
+      }
+    });
+}
 
-  auto& mutex = listMutex;
+vector<FilterBucket> MemScanner::makeFilterBuckets(const vector<Address>& addresses, size_t size) {
+  vector<FilterBucket> buckets;
+  size_t pageSize = getpagesize();
+  for (size_t i = 0; i < addresses.size(); i++) {
+    Address addr = addresses[i];
+    Address end = addr + size;
+    if (buckets.size()) {
+      auto& bucket = buckets.back();
+      Address bucketEnd = bucket.start + bucket.size;
+      bool nearby = addr / pageSize <= (bucketEnd - 1) / pageSize + 1;
+      Address newEnd = max(bucketEnd, end);
+      if (nearby && newEnd - bucket.start <= FILTER_BUCKET_SIZE) {
+        bucket.end = i + 1;
+        bucket.size = newEnd - bucket.start;
+        continue;
+      }
+    }
+    buckets.push_back(FilterBucket{ i, i + 1, addr, size });
+  }
+  return buckets;
+}
+
+vector<MemPtr> MemScanner::filterByBuckets(const vector<MemPtr>& list,
+                                           size_t size,
+                                           const string& scanType,
+                                           const BucketMatcher& matcher) {
+  progress.start(list.size() * size);
 
-  for (size_t i = 0; i < list.size(); i += CHUNK_SIZE) {
+  vector<size_t> order(list.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  auto byAddress = [&list](size_t a, size_t b) {
+    return list[a]->getAddress() < list[b]->getAddress();
+  };
+  if (!is_sorted(order.begin(), order.end(), byAddress)) {
+    sort(order.begin(), order.end(), byAddress);
+  }
+  vector<Address> addresses(order.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    addresses[i] = list[order[i]]->getAddress();
+  }
+  vector<FilterBucket> buckets = makeFilterBuckets(addresses, size);
+
+  // Each task takes a range of buckets, and writes the survivors to its own list,
+  // so that the lists are concatenated in address order.
+  vector<pair<size_t, size_t>> taskRanges;
+  size_t candidates = 0, bytes = 0;
+  for (size_t i = 0; i < buckets.size(); i++) {
+    if (taskRanges.empty() || candidates >= FILTER_TASK_CANDIDATES || bytes >= FILTER_TASK_BYTES) {
+      taskRanges.push_back(make_pair(i, i));
+      candidates = bytes = 0;
+    }
+    taskRanges.back().second = i + 1;
+    candidates += buckets[i].end - buckets[i].begin;
+    bytes += buckets[i].size;
+  }
+
+  vector<vector<MemPtr>> results(taskRanges.size());
+  BucketFilter bucketFilter(memio, list, order, size, scanType, matcher, progress);
+  for (size_t i = 0; i < taskRanges.size(); i++) {
     TMTask* fn = new TMTask();
-    *fn = [&mutex, &list, &newList, i, scanType, op]() {
-      filterUnknownByChunk(mutex, list, newList, i, scanType, op);
+    *fn = [&bucketFilter, &buckets, &taskRanges, &results, i]() {
+      bucketFilter.filter(buckets, taskRanges[i].first, taskRanges[i].second, results[i]);
     };
     threadManager->queueTask(fn);
   }
   threadManager->start();
   threadManager->clear();
+  progress.finish();
 
-  if (newList.size() <= ADDRESS_SORTABLE_SIZE) {
-    return MemList::sortByAddress(newList);
+  vector<MemPtr> newList;
+  size_t total = 0;
+  for (auto& result : results) {
+    total += result.size();
+  }
+  newList.reserve(total);
+  for (auto& result : results) {
+    newList.insert(newList.end(), result.begin(), result.end());
   }
   return newList;
 }
 
-void MemScanner::filterByChunk(std::mutex& mutex,
-                               const vector<MemPtr>& list,
-                               vector<MemPtr>& newList,
-                               int listIndex,
-                               Operands& operands,
+bool MemScanner::compareChange(Byte* newValue,
+                               Byte* oldValue,
                                int size,
+                               Operands& operands,
                                const string& scanType,
                                const ScanParser::OpType& op) {
-  for (int i = listIndex; i < listIndex + CHUNK_SIZE && i < (int)list.size(); i++) {
-    PemPtr pem = static_pointer_cast<Pem>(list[i]);
-    BytePtr data;
-    try {
-      data = size > 1 ? pem->getValuePtr(size) : pem->getValuePtr();
-    } catch(MedException &ex) { // Memory not available
-      continue;
-    }
-    if (memCompare(data.get(), size, operands, op)) {
-      pem->setScanType(scanType);
-      pem->rememberValue(data.get(), size);
-
-      mutex.lock();
-      newList.push_back(pem);
-      mutex.unlock();
-    }
-  }
-}
-
-void MemScanner::filterByChunk(std::mutex& mutex,
-                               const vector<MemPtr>& list,
-                               vector<MemPtr>& newList,
-                               int listIndex,
-                               ScanCommand &scanCommand) {
-  size_t size = scanCommand.getSize();
-  for (int i = listIndex; i < listIndex + CHUNK_SIZE && i < (int)list.size(); i++) {
-    PemPtr pem = static_pointer_cast<Pem>(list[i]);
-    BytePtr data;
-    try {
-      data = size > 1 ? pem->getValuePtr(size) : pem->getValuePtr();
-    } catch(MedException &ex) { // Memory not available
-      continue;
-    }
-    if (scanCommand.match(data.get())) {
-      pem->setScanType(SCAN_TYPE_INT_8);
-      pem->rememberValue(data.get(), size);
-
-      mutex.lock();
-      newList.push_back(pem);
-      mutex.unlock();
-    }
-  }
-}
-
-void MemScanner::filterUnknownByChunk(std::mutex& mutex,
-                                      const vector<MemPtr>& list,
-                                      vector<MemPtr>& newList,
-                                      int listIndex,
-                                      const string& scanType,
-                                      const ScanParser::OpType& op) {
-  for (int i = listIndex; i < listIndex + CHUNK_SIZE && i < (int)list.size(); i++) {
-    int size = scanTypeToSize(scanType);
-    PemPtr pem = static_pointer_cast<Pem>(list[i]);
-    BytePtr data;
-    Byte* oldValue = NULL;
-    try {
-      data = pem->getValuePtr();
-      oldValue = pem->recallValuePtr();
-    } catch(MedException &ex) {
-      continue;
-    }
-
-    if (memCompare(data.get(), size, oldValue, size, op)) {
-      pem->setScanType(scanType);
-      pem->rememberValue(data.get(), size);
-
-      mutex.lock();
-      newList.push_back(pem);
-      mutex.unlock();
-    }
+  if (ScanParser::isDeltaOperator(op)) {
+    return memCompareDelta(newValue, oldValue, stringToScanType(scanType), operands, op);
   }
+  return memCompare(newValue, size, oldValue, size, op);
 }
 
 Maps MemScanner::getInterestedMaps(Maps& maps, const vector<MemPtr>& list) {
@@ -656,7 +1377,7 @@ Maps MemScanner::getInterestedMaps(Maps& maps, const vector<MemPtr>& list) {
       if (inRegion) {
         AddressPair addressPair(start, end);
         if (!interested.hasPair(addressPair)) {
-          interested.push(addressPair);
+          interested.push(addressPair, maps.getName(j));
         }
         break;
       }
@@ -665,19 +1386,93 @@ Maps MemScanner::getInterestedMaps(Maps& maps, const vector<MemPtr>& list) {
   return interested;
 }
 
-vector<MemPtr> MemScanner::filterSnapshot(const string& scanType, const ScanParser::OpType& op, bool fastScan) {
-  vector<MemPtr> list;
+// Whether an unchanged value matches depends on the operator only, not on the value
+bool isUnchangedMatchByOperator(const ScanParser::OpType& op) {
+  switch (op) {
+  case ScanParser::Eq:
+  case ScanParser::Gt:
+  case ScanParser::Lt:
+  case ScanParser::Neq:
+  case ScanParser::Ge:
+  case ScanParser::Le:
+  case ScanParser::IncreasedBy:
+  case ScanParser::DecreasedBy:
+    return true;
+  default:
+    return false;
+  }
+}
+
+vector<MemPtr> MemScanner::filterSnapshot(Operands& operands,
+                                          const string& scanType,
+                                          const ScanParser::OpType& op,
+                                          bool fastScan) {
+  MetricsTimer timer("filterSnapshot");
+  PageMap pageMap(pid);
+  bool useSoftDirty = softDirtyTracking && pageMap.isAvailable();
+
+  size_t total = 0;
+  for (auto& block : snapshot) {
+    if (block) total += block->getSize();
+  }
+  progress.start(total);
+  int size = scanTypeToSize(scanType);
+  candidates.reset(size);
+  vector<uint16_t> offsets;
+
+  // A page which is not soft-dirty still has the values of the snapshot, as the bits are cleared when it is saved.
+  // Unchanged values match or not by the operator only, like "=" keeps them all and ">" none.
+  // With the other operators, like "%=" which depends on the old value, and for a longer value,
+  // the page is compared with itself.
+  Byte same[MAX_SCAN_VALUE_SIZE] = { 0 };
+  bool cleanKnown = (size_t)size <= MAX_SCAN_VALUE_SIZE && isUnchangedMatchByOperator(op);
+  bool cleanMatches = cleanKnown && compareChange(same, same, size, operands, scanType, op);
+
   for (size_t i = 0; i < snapshot.size(); i++) {
-    auto block = memio->read(snapshot[i]->getAddress(), snapshot[i]->getSize());
-    compareBlocks(list, snapshot[i], block, scanType, op, fastScan);
+    auto& oldBlock = snapshot[i];
+    if (!oldBlock) continue;
+    if (progress.isCancelled()) {
+      // The pages which are not checked keep all their candidates
+      keepBlock(offsets, oldBlock, scanType, fastScan);
+      candidates.addPage(oldBlock->getAddress(), offsets, oldBlock->getData());
+      continue;
+    }
+    progress.addBytesScanned(oldBlock->getSize());
+
+    if (useSoftDirty && !pageMap.isSoftDirty(oldBlock->getAddress(), oldBlock->getSize())) {
+      // Not written since the snapshot, neither read nor compared
+      progress.addPagesSkipped();
+      if (!cleanKnown) {
+        compareBlocks(offsets, oldBlock, oldBlock, operands, scanType, op, fastScan);
+        candidates.addPage(oldBlock->getAddress(), offsets, oldBlock->getData());
+      } else if (cleanMatches) {
+        keepBlock(offsets, oldBlock, scanType, fastScan);
+        candidates.addPage(oldBlock->getAddress(), offsets, oldBlock->getData());
+      }
+      continue;
+    }
+
+    MemPtr block;
+    try {
+      block = memio->read(oldBlock->getAddress(), oldBlock->getSize());
+    } catch (MedException& ex) {
+      Metrics::getInstance().add(Counter::PagesFailed);
+      continue;
+    }
+    if (!block) continue;
+    compareBlocks(offsets, oldBlock, block, operands, scanType, op, fastScan);
+    candidates.addPage(block->getAddress(), offsets, block->getData());
   }
+  progress.finish();
   snapshot.clear();
-  return list;
+  softDirtyTracking = false;
+  return takeCandidates(scanType);
 }
 
-void MemScanner::compareBlocks(vector<MemPtr>& list,
+void MemScanner::compareBlocks(vector<uint16_t>& offsets,
                                MemPtr& oldBlock,
                                MemPtr& newBlock,
+                               Operands& operands,
                                const string& scanType,
                                const ScanParser::OpType& op,
                                bool fastScan) {
@@ -685,6 +1480,8 @@ void MemScanner::compareBlocks(vector<MemPtr>& list,
   int size = scanTypeToSize(scanType);
   Byte* oldBlockPtr = oldBlock->getData();
   Byte* newBlockPtr = newBlock->getData();
+  size_t comparisons = 0;
+  offsets.clear();
   for (size_t i = 0; i <= blockSize - size; i += STEP) {
     Address oldAddress = oldBlock->getAddress() + i;
     if (scanType != SCAN_TYPE_STRING &&
@@ -692,14 +1489,27 @@ void MemScanner::compareBlocks(vector<MemPtr>& list,
       continue;
     }
 
-    if (memCompare(newBlockPtr + i, size, oldBlockPtr + i, size, op)) {
-      MemPtr mem = memio->read(oldAddress, size);
-      PemPtr pem = Pem::convertToPemPtr(mem, memio);
-      pem->setScanType(scanType);
-      pem->rememberValue(mem->getData(), size);
+    comparisons++;
+    if (compareChange(newBlockPtr + i, oldBlockPtr + i, size, operands, scanType, op)) {
+      // New block already has the value, it is kept by the candidate set
+      offsets.push_back(i);
+    }
+  }
+  Metrics& metrics = Metrics::getInstance();
+  metrics.add(Counter::Comparisons, comparisons);
+  metrics.add(Counter::Hits, offsets.size());
+}
 
-      list.push_back(pem);
+void MemScanner::keepBlock(vector<uint16_t>& offsets, MemPtr& block, const string& scanType, bool fastScan) {
+  size_t blockSize = block->getSize();
+  int size = scanTypeToSize(scanType);
+  offsets.clear();
+  for (size_t i = 0; i <= blockSize - size; i += STEP) {
+    if (scanType != SCAN_TYPE_STRING &&
+        skipAddressByFastScan(block->getAddress() + i, size, fastScan)) {
+      continue;
     }
+    offsets.push_back(i);
   }
 }
 
@@ -715,8 +1525,16 @@ void MemScanner::setScopeEnd(Address addr) {
   scope->second = addr;
 }
 
-bool MemScanner::hasScope() {
-  return scope->first && scope->second;
+void MemScanner::setScanRanges(const ScanRanges& ranges) {
+  this->ranges = ranges;
+}
+
+ScanRanges& MemScanner::getScanRanges() {
+  return ranges;
+}
+
+bool MemScanner::hasScanRanges() {
+  return (scope->first && scope->second) || !ranges.isEmpty();
 }
 
 std::mutex& MemScanner::getListMutex() {
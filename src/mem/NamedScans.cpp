@@ -24,6 +24,49 @@ MemList* NamedScans::addNewScan(string name) {
   return &data[trimmed];
 }
 
+// Operator with the space around it, so that the names can have the symbols
+static bool splitCombinedScan(const string& expression, string& a, char& op, string& b) {
+  for (auto symbol : { " & ", " | ", " - " }) {
+    size_t pos = expression.find(symbol);
+    if (pos == string::npos) continue;
+    a = StringUtil::trim(expression.substr(0, pos));
+    op = symbol[1];
+    b = StringUtil::trim(expression.substr(pos + 3));
+    return a.size() && b.size();
+  }
+  return false;
+}
+
+bool NamedScans::isCombinedScan(string expression) {
+  string a, b;
+  char op;
+  return splitCombinedScan(StringUtil::trim(expression), a, op, b);
+}
+
+MemList* NamedScans::addCombinedScan(string expression) {
+  auto trimmed = StringUtil::trim(expression);
+  string a, b;
+  char op;
+  if (!splitCombinedScan(trimmed, a, op, b)) return NULL;
+  if (data.find(trimmed) != data.end()) return NULL;
+
+  MemList* left = getMemList(a);
+  MemList* right = getMemList(b);
+  if (!left || !right) return NULL;
+
+  MemList result;
+  if (op == '&') {
+    result = MemList::intersect(*left, *right);
+  } else if (op == '|') {
+    result = MemList::unite(*left, *right);
+  } else {
+    result = MemList::subtract(*left, *right);
+  }
+  data[trimmed] = result;
+  scanTypes[trimmed] = scanTypes[a];
+  return &data[trimmed];
+}
+
 MemList* NamedScans::getMemList() {
   return getMemList(activeName);
 }
@@ -40,8 +83,35 @@ MemList* NamedScans::getMemList(string name) {
 }
 
 void NamedScans::setMemPtrs(vector<MemPtr> list, string scanType) {
-  getMemList()->setList(list);
+  setMemPtrs(activeName, list, scanType);
+}
+
+bool NamedScans::setMemPtrs(string name, vector<MemPtr> list, string scanType, bool capped) {
+  MemList* memList = getMemList(name);
+  if (!memList) return false;
+  auto trimmed = StringUtil::trim(name);
+  memList->setList(list);
+  scanTypes[trimmed] = scanType;
+  histories[trimmed].push(*memList, scanType, capped);
+  return true;
+}
+
+bool NamedScans::undo() {
+  string scanType;
+  if (!histories[activeName].undo(*getMemList(), scanType)) return false;
   setScanType(scanType);
+  return true;
+}
+
+bool NamedScans::redo() {
+  string scanType;
+  if (!histories[activeName].redo(*getMemList(), scanType)) return false;
+  setScanType(scanType);
+  return true;
+}
+
+ScanHistory& NamedScans::getHistory() {
+  return histories[activeName];
 }
 
 bool NamedScans::remove(string name) {
@@ -52,6 +122,7 @@ bool NamedScans::remove(string name) {
   if (search != data.end()) {
     data.erase(search);
     removeScanTypes(trimmed);
+    histories.erase(trimmed);
     activeName = DEFAULT;
     return true;
   }
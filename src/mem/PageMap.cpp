@@ -0,0 +1,86 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "mem/PageMap.hpp"
+#include "med/Metrics.hpp"
+
+using namespace std;
+
+string procPath(pid_t pid, const char* name) {
+  char filename[64];
+  if (pid) {
+    sprintf(filename, "/proc/%d/%s", pid, name);
+  } else {
+    sprintf(filename, "/proc/self/%s", name);
+  }
+  return filename;
+}
+
+PageMap::PageMap(pid_t pid) {
+  fd = open(procPath(pid, "pagemap").c_str(), O_RDONLY);
+}
+
+PageMap::~PageMap() {
+  if (fd != -1) {
+    close(fd);
+  }
+}
+
+bool PageMap::isAvailable() {
+  return fd != -1;
+}
+
+bool PageMap::read(Address addr, size_t size, vector<uint64_t>& entries) {
+  if (fd == -1 || !size) return false;
+
+  size_t pageSize = getpagesize();
+  Address first = addr / pageSize;
+  Address last = (addr + size - 1) / pageSize;
+  size_t count = last - first + 1;
+  entries.resize(count);
+
+  Metrics::getInstance().add(Counter::Syscalls);
+  ssize_t bytes = count * sizeof(uint64_t);
+  return pread(fd, entries.data(), bytes, first * sizeof(uint64_t)) == bytes;
+}
+
+bool PageMap::isSoftDirty(Address addr, size_t size) {
+  vector<uint64_t> entries;
+  if (!read(addr, size, entries)) return true;
+
+  for (auto entry : entries) {
+    if (isSoftDirty(entry)) return true;
+  }
+  return false;
+}
+
+bool PageMap::clearSoftDirty(pid_t pid) {
+  int clearFd = open(procPath(pid, "clear_refs").c_str(), O_WRONLY);
+  if (clearFd == -1) return false;
+
+  bool result = write(clearFd, "4", 1) == 1;
+  close(clearFd);
+  return result;
+}
+
+bool PageMap::isSoftDirtySupported() {
+  static bool supported = probeSoftDirty();
+  return supported;
+}
+
+bool PageMap::probeSoftDirty() {
+  size_t pageSize = getpagesize();
+  volatile Byte* page = (Byte*)aligned_alloc(pageSize, pageSize);
+  page[0] = 1;
+
+  PageMap pageMap(0);
+  bool cleared = clearSoftDirty(0) && !pageMap.isSoftDirty((Address)page, 1);
+  page[0] = 2;
+  bool supported = cleared && pageMap.isSoftDirty((Address)page, 1);
+
+  free((void*)page);
+  return supported;
+}
@@ -0,0 +1,324 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mem/PointerMap.hpp"
+#include "med/MedException.hpp"
+
+using namespace std;
+
+// File layout, all little-endian 64-bit unless noted:
+// magic, target, map count, pointer count,
+// maps (start, end, name length, name padded to 8 bytes),
+// pointers sorted by source (source, value), index sorted by value (32-bit).
+const char POINTER_MAP_MAGIC[8] = { 'M', 'E', 'D', 'P', 'T', 'R', '1', 0 };
+
+namespace {
+  string toHex(Address value) {
+    char str[32];
+    snprintf(str, sizeof(str), "0x%lx", (unsigned long)value);
+    return string(str);
+  }
+
+  size_t padded(size_t size) {
+    return (size + 7) / 8 * 8;
+  }
+}
+
+bool PointerPath::operator==(const PointerPath& other) const {
+  return module == other.module && offset == other.offset && offsets == other.offsets;
+}
+
+bool PointerPath::operator<(const PointerPath& other) const {
+  if (module != other.module) return module < other.module;
+  if (offset != other.offset) return offset < other.offset;
+  return offsets < other.offsets;
+}
+
+string PointerPath::toString() const {
+  string s = module + "+" + toHex(offset);
+  for (auto o : offsets) {
+    s = "[" + s + "]+" + toHex(o);
+  }
+  return s;
+}
+
+PointerMap::PointerMap() {
+  target = 0;
+  count = 0;
+  entries = NULL;
+  byValue = NULL;
+  mapped = NULL;
+  mappedSize = 0;
+}
+
+PointerMap::~PointerMap() {
+  unmap();
+}
+
+void PointerMap::unmap() {
+  if (mapped) {
+    munmap(mapped, mappedSize);
+    mapped = NULL;
+    mappedSize = 0;
+  }
+}
+
+void PointerMap::set(Maps& maps, vector<PointerEntry>& entries, Address target) {
+  if (entries.size() > UINT32_MAX) {
+    throw MedException("Too many pointers: " + to_string(entries.size()));
+  }
+  unmap();
+  this->maps = maps;
+  this->target = target;
+  ownEntries.swap(entries);
+  entries.clear();
+
+  ownByValue.resize(ownEntries.size());
+  for (size_t i = 0; i < ownByValue.size(); i++) {
+    ownByValue[i] = i;
+  }
+  auto& list = ownEntries;
+  sort(ownByValue.begin(), ownByValue.end(), [&list](uint32_t a, uint32_t b) {
+      return list[a].value < list[b].value;
+    });
+
+  count = ownEntries.size();
+  this->entries = ownEntries.data();
+  byValue = ownByValue.data();
+}
+
+void PointerMap::save(const string& filename) {
+  ofstream ofs(filename, ios::binary);
+  if (ofs.fail()) {
+    throw MedException("Save pointer map: Fail to open file " + filename);
+  }
+  auto write64 = [&ofs](uint64_t value) {
+    ofs.write((const char*)&value, sizeof(value));
+  };
+
+  ofs.write(POINTER_MAP_MAGIC, sizeof(POINTER_MAP_MAGIC));
+  write64(target);
+  write64(maps.size());
+  write64(count);
+  for (size_t i = 0; i < maps.size(); i++) {
+    auto& name = maps.getName(i);
+    write64(std::get<0>(maps.getMaps()[i]));
+    write64(std::get<1>(maps.getMaps()[i]));
+    write64(name.size());
+    string paddedName = name;
+    paddedName.resize(padded(name.size()), '\0');
+    ofs.write(paddedName.data(), paddedName.size());
+  }
+  ofs.write((const char*)entries, count * sizeof(PointerEntry));
+  ofs.write((const char*)byValue, count * sizeof(uint32_t));
+  if (ofs.fail()) {
+    throw MedException("Save pointer map: Fail to write file " + filename);
+  }
+}
+
+void PointerMap::load(const string& filename) {
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd == -1) {
+    throw MedException("Open pointer map: Fail to open file " + filename);
+  }
+  struct stat st;
+  if (fstat(fd, &st) == -1 || st.st_size < (off_t)(sizeof(POINTER_MAP_MAGIC) + 3 * sizeof(uint64_t))) {
+    close(fd);
+    throw MedException("Open pointer map: Invalid file " + filename);
+  }
+  void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    throw MedException("Open pointer map: Fail to map file " + filename);
+  }
+
+  unmap();
+  ownEntries.clear();
+  ownByValue.clear();
+  mapped = data;
+  mappedSize = st.st_size;
+
+  const Byte* begin = (const Byte*)data;
+  const Byte* end = begin + mappedSize;
+  const Byte* ptr = begin;
+  auto read64 = [&ptr, end, &filename]() {
+    if (ptr + sizeof(uint64_t) > end) {
+      throw MedException("Open pointer map: Truncated file " + filename);
+    }
+    uint64_t value;
+    memcpy(&value, ptr, sizeof(value));
+    ptr += sizeof(value);
+    return value;
+  };
+
+  try {
+    if (memcmp(ptr, POINTER_MAP_MAGIC, sizeof(POINTER_MAP_MAGIC)) != 0) {
+      throw MedException("Open pointer map: Invalid file " + filename);
+    }
+    ptr += sizeof(POINTER_MAP_MAGIC);
+    target = read64();
+    uint64_t mapCount = read64();
+    count = read64();
+
+    maps = Maps();
+    for (uint64_t i = 0; i < mapCount; i++) {
+      Address start = read64();
+      Address mapEnd = read64();
+      uint64_t nameLength = read64();
+      if (nameLength > (uint64_t)(end - ptr) || padded(nameLength) > (uint64_t)(end - ptr)) {
+        throw MedException("Open pointer map: Truncated file " + filename);
+      }
+      maps.push(AddressPair(start, mapEnd), string((const char*)ptr, nameLength));
+      ptr += padded(nameLength);
+    }
+
+    if (count > (uint64_t)(end - ptr) / (sizeof(PointerEntry) + sizeof(uint32_t))) {
+      throw MedException("Open pointer map: Truncated file " + filename);
+    }
+    entries = (const PointerEntry*)ptr;
+    byValue = (const uint32_t*)(ptr + count * sizeof(PointerEntry));
+  } catch (MedException& ex) {
+    unmap();
+    count = 0;
+    entries = NULL;
+    byValue = NULL;
+    throw;
+  }
+}
+
+Address PointerMap::getTarget() {
+  return target;
+}
+
+size_t PointerMap::size() {
+  return count;
+}
+
+Maps& PointerMap::getMaps() {
+  return maps;
+}
+
+bool PointerMap::readPointer(Address addr, Address& value) {
+  auto it = lower_bound(entries, entries + count, addr, [](const PointerEntry& entry, Address a) {
+      return entry.source < a;
+    });
+  if (it == entries + count || it->source != addr) return false;
+  value = it->value;
+  return true;
+}
+
+vector<PointerEntry> PointerMap::findPointersTo(Address low, Address high) {
+  auto list = entries;
+  auto it = lower_bound(byValue, byValue + count, low, [list](uint32_t index, Address a) {
+      return list[index].value < a;
+    });
+  vector<PointerEntry> found;
+  for (; it != byValue + count && entries[*it].value <= high; ++it) {
+    found.push_back(entries[*it]);
+  }
+  return found;
+}
+
+string PointerMap::getModuleName(int index) {
+  string& path = maps.getName(index);
+  return path.substr(path.find_last_of('/') + 1);
+}
+
+int PointerMap::findStaticMap(Address addr) {
+  auto& pairs = maps.getMaps();
+  auto it = upper_bound(pairs.begin(), pairs.end(), addr, [](Address a, const AddressPair& pair) {
+      return a < std::get<0>(pair);
+    });
+  if (it == pairs.begin()) return -1;
+  --it;
+  if (addr >= std::get<1>(*it)) return -1;
+
+  // Only the file-backed maps are at the same place relative to the module in every run
+  int index = it - pairs.begin();
+  string& name = maps.getName(index);
+  if (name.empty() || name[0] == '[') return -1;
+  return index;
+}
+
+bool PointerMap::getModuleBase(const string& module, Address& base) {
+  for (size_t i = 0; i < maps.size(); i++) {
+    string& name = maps.getName(i);
+    if (name.empty() || name[0] == '[') continue;
+    if (getModuleName(i) == module) {
+      base = std::get<0>(maps.getMaps()[i]);
+      return true;
+    }
+  }
+  return false;
+}
+
+vector<PointerPath> PointerMap::findPaths(size_t maxDepth, size_t maxOffset, size_t maxResults) {
+  struct Node {
+    Address addr;
+    vector<long> offsets;
+  };
+
+  // Breadth first from the target, so that the shorter paths come first
+  vector<PointerPath> paths;
+  vector<Node> level = { Node{ target, {} } };
+  for (size_t depth = 0; depth < maxDepth && !level.empty(); depth++) {
+    vector<Node> next;
+    for (auto& node : level) {
+      Address low = node.addr >= maxOffset ? node.addr - maxOffset : 0;
+      for (auto& pointer : findPointersTo(low, node.addr)) {
+        vector<long> offsets = { (long)(node.addr - pointer.value) };
+        offsets.insert(offsets.end(), node.offsets.begin(), node.offsets.end());
+
+        int index = findStaticMap(pointer.source);
+        if (index >= 0) {
+          PointerPath path;
+          path.module = getModuleName(index);
+          Address base = 0;
+          getModuleBase(path.module, base);
+          path.offset = pointer.source - base;
+          path.offsets = offsets;
+          paths.push_back(path);
+          if (paths.size() >= maxResults) return paths;
+        } else if (next.size() < POINTER_MAX_NODES) {
+          next.push_back(Node{ pointer.source, offsets });
+        }
+      }
+    }
+    level.swap(next);
+  }
+  return paths;
+}
+
+bool PointerMap::resolve(const PointerPath& path, Address& addr) {
+  Address base;
+  if (!getModuleBase(path.module, base)) return false;
+  addr = base + path.offset;
+  for (auto offset : path.offsets) {
+    Address value;
+    if (!readPointer(addr, value)) return false;
+    addr = value + offset;
+  }
+  return true;
+}
+
+vector<PointerPath> PointerMap::intersect(const vector<PointerMap*>& maps, size_t maxDepth, size_t maxOffset) {
+  if (maps.empty()) return vector<PointerPath>();
+
+  vector<PointerPath> paths = maps[0]->findPaths(maxDepth, maxOffset);
+  sort(paths.begin(), paths.end());
+  paths.erase(unique(paths.begin(), paths.end()), paths.end());
+  for (size_t i = 1; i < maps.size(); i++) {
+    auto map = maps[i];
+    paths.erase(remove_if(paths.begin(), paths.end(), [map](const PointerPath& path) {
+          Address addr;
+          return !map->resolve(path, addr) || addr != map->getTarget();
+        }), paths.end());
+  }
+  return paths;
+}
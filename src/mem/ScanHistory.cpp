@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <cstring>
+
+#include "mem/ScanHistory.hpp"
+#include "mem/Pem.hpp"
+
+using namespace std;
+
+ScanHistory::ScanHistory() {
+  current = 0;
+}
+
+void ScanHistory::push(MemList& list, const string& scanType, bool capped) {
+  if (entries.size()) {
+    entries.erase(entries.begin() + current + 1, entries.end());
+  }
+
+  Entry entry;
+  entry.count = list.size();
+  entry.scanType = scanType;
+  entry.capped = capped;
+  entry.valueSize = 0;
+  vector<uint64_t> kept;
+  if (entries.size() && entries.back().scanType == scanType && makeKept(entries.back(), list, kept)) {
+    entry.base = entries.back().base;
+    entry.order = entries.back().order;
+    entry.kept.swap(kept);
+    saveValues(list, entry);
+  } else {
+    entry.base = list;
+    auto& mems = list.getList();
+    auto byAddress = [&mems](size_t a, size_t b) {
+      return mems[a]->getAddress() < mems[b]->getAddress();
+    };
+    vector<size_t> order(mems.size());
+    for (size_t i = 0; i < order.size(); i++) {
+      order[i] = i;
+    }
+    if (!is_sorted(order.begin(), order.end(), byAddress)) {
+      sort(order.begin(), order.end(), byAddress);
+      entry.order = make_shared<vector<size_t>>(std::move(order));
+    }
+  }
+  entries.push_back(std::move(entry));
+  if (entries.size() > SCAN_HISTORY_MAX) {
+    entries.pop_front();
+  }
+  current = entries.size() - 1;
+}
+
+size_t ScanHistory::basePosition(Entry& entry, size_t index) {
+  return entry.order ? (*entry.order)[index] : index;
+}
+
+bool ScanHistory::makeKept(Entry& entry, MemList& list, vector<uint64_t>& kept) {
+  if (list.size() > entry.count) return false;
+  auto& base = entry.base.getList();
+  auto& mems = list.getList();
+  kept.assign((base.size() + 63) / 64, 0);
+
+  // Both are walked by address, every element of the list must be one of the entry
+  size_t k = 0;
+  for (auto& mem : mems) {
+    Address addr = mem->getAddress();
+    size_t i = 0;
+    while (k < base.size()) {
+      i = basePosition(entry, k);
+      if ((entry.kept.empty() || entry.kept[i / 64] >> (i % 64) & 1) && base[i]->getAddress() >= addr) break;
+      k++;
+    }
+    if (k == base.size() || base[i]->getAddress() != addr) return false;
+    kept[i / 64] |= (uint64_t)1 << (i % 64);
+    k++;
+  }
+  return true;
+}
+
+void ScanHistory::saveValues(MemList& list, Entry& entry) {
+  auto& mems = list.getList();
+  if (mems.empty()) return;
+  size_t size = mems[0]->getSize();
+  vector<Byte> values(mems.size() * size);
+  for (size_t i = 0; i < mems.size(); i++) {
+    // The scan results are Pem
+    Pem* pem = static_cast<Pem*>(mems[i].get());
+    if (pem->getSize() != size || !pem->recallValuePtr()) return;
+    memcpy(values.data() + i * size, pem->recallValuePtr(), size);
+  }
+  entry.values.swap(values);
+  entry.valueSize = size;
+}
+
+void ScanHistory::clear() {
+  entries.clear();
+  current = 0;
+}
+
+bool ScanHistory::canUndo() {
+  return entries.size() && current > 0;
+}
+
+bool ScanHistory::canRedo() {
+  return entries.size() && current + 1 < entries.size();
+}
+
+bool ScanHistory::isCapped(bool backward) {
+  if (backward ? !canUndo() : !canRedo()) return false;
+  return entries[backward ? current - 1 : current + 1].capped;
+}
+
+bool ScanHistory::undo(MemList& list, string& scanType) {
+  if (!canUndo()) return false;
+  current--;
+  restore(entries[current], list, scanType);
+  return true;
+}
+
+bool ScanHistory::redo(MemList& list, string& scanType) {
+  if (!canRedo()) return false;
+  current++;
+  restore(entries[current], list, scanType);
+  return true;
+}
+
+void ScanHistory::restore(Entry& entry, MemList& list, string& scanType) {
+  scanType = entry.scanType;
+  if (entry.kept.empty()) {
+    list = entry.base;
+    return;
+  }
+
+  auto& base = entry.base.getList();
+  vector<MemPtr> mems;
+  mems.reserve(entry.count);
+  auto add = [&](size_t i) {
+    const MemPtr& mem = base[i];
+    if (entry.values.empty()) {
+      mems.push_back(mem);
+      return;
+    }
+    Byte* value = entry.values.data() + mems.size() * entry.valueSize;
+    PemPtr pem = PemPtr(new Pem(mem->getAddress(), entry.valueSize, static_cast<Pem*>(mem.get())->getMemIO()));
+    memcpy(pem->getData(), value, entry.valueSize);
+    pem->setScanType(entry.scanType);
+    pem->rememberValue(value, entry.valueSize);
+    mems.push_back(pem);
+  };
+  // In address order, as the filter result was
+  if (entry.order) {
+    for (size_t i : *entry.order) {
+      if (entry.kept[i / 64] >> (i % 64) & 1) add(i);
+    }
+  } else {
+    for (size_t w = 0; w < entry.kept.size(); w++) {
+      uint64_t word = entry.kept[w];
+      while (word) {
+        add(w * 64 + __builtin_ctzll(word));
+        word &= word - 1;
+      }
+    }
+  }
+  list = MemList(std::move(mems));
+}
+
+size_t ScanHistory::size() {
+  return entries.size();
+}
+
+size_t ScanHistory::getMemoryUsage() {
+  size_t bytes = 0;
+  for (auto& entry : entries) {
+    bytes += entry.kept.capacity() * sizeof(uint64_t) + entry.values.capacity();
+    if (entry.order && entry.kept.empty()) {
+      bytes += entry.order->capacity() * sizeof(size_t);
+    }
+  }
+  return bytes;
+}
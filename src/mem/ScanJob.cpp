@@ -0,0 +1,195 @@
+#include <iostream>
+
+#include "mem/ScanJob.hpp"
+#include "med/MedException.hpp"
+
+using namespace std;
+
+ScanJob::ScanJob(ScanProgress& progress, Task task) : progress(progress) {
+  this->task = task;
+  thread = NULL;
+  status = ScanJobStatus::Running;
+  batchSize = SCAN_JOB_BATCH_SIZE;
+  foundCount = 0;
+}
+
+ScanJob::~ScanJob() {
+  if (thread) {
+    if (thread->joinable()) {
+      if (thread->get_id() == std::this_thread::get_id()) {
+        thread->detach(); // Last reference is released by the callback
+      } else {
+        thread->join();
+      }
+    }
+    delete thread;
+  }
+}
+
+void ScanJob::start() {
+  if (thread) {
+    throw MedException("Scan job is already started");
+  }
+  thread = new std::thread(&ScanJob::run, this);
+}
+
+void ScanJob::run() {
+  vector<MemPtr> list;
+  string message;
+  bool failed = false;
+  progress.setOnFound([this](const vector<MemPtr>& found) {
+    addFound(found);
+  });
+  try {
+    list = task();
+  } catch (MedException& ex) {
+    message = ex.getMessage();
+    failed = true;
+  } catch (std::exception& ex) {
+    message = ex.what();
+    failed = true;
+  }
+  progress.setOnFound(NULL);
+
+  ScanJobStatus finalStatus;
+  if (failed) {
+    finalStatus = ScanJobStatus::Failed;
+  } else if (progress.isCancelled()) {
+    finalStatus = ScanJobStatus::Cancelled;
+  } else {
+    finalStatus = ScanJobStatus::Done;
+  }
+
+  mutex.lock();
+  // A filter does not pass what it found, so its results are passed at the end
+  if (!foundCount && !failed) {
+    found = list;
+  }
+  results = list;
+  error = message;
+  mutex.unlock();
+
+  // The job is done once the last batch is delivered. A batch callback set later is given all the results.
+  CompleteCallback completeCallback;
+  while (true) {
+    flushFound(true);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!onBatch || found.empty()) {
+      status = finalStatus;
+      completeCallback = onComplete;
+      break;
+    }
+  }
+  if (completeCallback) {
+    completeCallback(*this);
+  }
+}
+
+void ScanJob::addFound(const vector<MemPtr>& found) {
+  mutex.lock();
+  this->found.insert(this->found.end(), found.begin(), found.end());
+  foundCount += found.size();
+  mutex.unlock();
+  flushFound(false);
+}
+
+void ScanJob::flushFound(bool all) {
+  std::lock_guard<std::mutex> lock(batchMutex);
+  mutex.lock();
+  if (!onBatch || found.empty() || (!all && found.size() < batchSize)) {
+    mutex.unlock();
+    return;
+  }
+  vector<MemPtr> taken;
+  taken.swap(found);
+  BatchCallback callback = onBatch;
+  size_t size = batchSize;
+  mutex.unlock();
+
+  size_t i = 0;
+  for (; i < taken.size() && (all || i + size <= taken.size()); i += size) {
+    size_t end = min(taken.size(), i + size);
+    vector<MemPtr> batch(taken.begin() + i, taken.begin() + end);
+    callback(batch);
+  }
+  // The rest waits for a full batch
+  if (i < taken.size()) {
+    mutex.lock();
+    found.insert(found.begin(), taken.begin() + i, taken.end());
+    mutex.unlock();
+  }
+}
+
+void ScanJob::deliverBatches(BatchCallback& callback, size_t batchSize) {
+  for (size_t i = 0; i < results.size(); i += batchSize) {
+    size_t end = min(results.size(), i + batchSize);
+    vector<MemPtr> batch(results.begin() + i, results.begin() + end);
+    callback(batch);
+  }
+}
+
+void ScanJob::wait() {
+  if (thread && thread->joinable() && thread->get_id() != std::this_thread::get_id()) {
+    thread->join();
+  }
+}
+
+void ScanJob::cancel() {
+  progress.cancel();
+}
+
+ScanJobStatus ScanJob::getStatus() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return status;
+}
+
+bool ScanJob::isDone() {
+  return getStatus() != ScanJobStatus::Running;
+}
+
+ScanProgress& ScanJob::getProgress() {
+  return progress;
+}
+
+string ScanJob::getError() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return error;
+}
+
+vector<MemPtr> ScanJob::getResults() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return results;
+}
+
+vector<MemPtr> ScanJob::takeFound() {
+  std::lock_guard<std::mutex> lock(mutex);
+  vector<MemPtr> taken;
+  taken.swap(found);
+  return taken;
+}
+
+void ScanJob::setOnBatch(BatchCallback callback, size_t batchSize) {
+  mutex.lock();
+  bool done = status != ScanJobStatus::Running;
+  onBatch = callback;
+  this->batchSize = max((size_t)1, batchSize);
+  if (done) {
+    found.clear();
+  }
+  mutex.unlock();
+
+  if (done) {
+    deliverBatches(callback, this->batchSize);
+  }
+}
+
+void ScanJob::setOnComplete(CompleteCallback callback) {
+  mutex.lock();
+  bool done = status != ScanJobStatus::Running;
+  onComplete = callback;
+  mutex.unlock();
+
+  if (done) {
+    callback(*this);
+  }
+}
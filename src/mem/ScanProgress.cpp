@@ -0,0 +1,113 @@
+#include <algorithm>
+#include "mem/ScanProgress.hpp"
+
+using namespace std;
+
+ScanProgress::ScanProgress() {
+  running = false;
+  reset();
+}
+
+void ScanProgress::reset() {
+  bytesTotal = 0;
+  bytesScanned = 0;
+  pagesSkipped = 0;
+  hits = 0;
+  cancelled = false;
+  duration = 0;
+  startTime = chrono::steady_clock::now().time_since_epoch().count();
+}
+
+void ScanProgress::start(size_t bytesTotal) {
+  this->bytesTotal = bytesTotal;
+  bytesScanned = 0;
+  pagesSkipped = 0;
+  hits = 0;
+  duration = 0;
+  startTime = chrono::steady_clock::now().time_since_epoch().count();
+  running = true;
+}
+
+void ScanProgress::startTimed(double seconds) {
+  start(0);
+  duration = seconds;
+}
+
+void ScanProgress::finish() {
+  running = false;
+}
+
+bool ScanProgress::isRunning() {
+  return running;
+}
+
+void ScanProgress::cancel() {
+  cancelled = true;
+}
+
+bool ScanProgress::isCancelled() {
+  return cancelled;
+}
+
+void ScanProgress::addBytesScanned(size_t bytes) {
+  bytesScanned += bytes;
+}
+
+void ScanProgress::addPagesSkipped(size_t pages) {
+  pagesSkipped += pages;
+}
+
+void ScanProgress::addHits(size_t hits) {
+  this->hits += hits;
+}
+
+void ScanProgress::addFound(const vector<MemPtr>& found) {
+  if (found.empty()) return;
+  std::lock_guard<std::mutex> lock(foundMutex);
+  if (onFound) {
+    onFound(found);
+  }
+}
+
+void ScanProgress::setOnFound(FoundCallback callback) {
+  std::lock_guard<std::mutex> lock(foundMutex);
+  onFound = callback;
+}
+
+size_t ScanProgress::getBytesTotal() {
+  return bytesTotal;
+}
+
+size_t ScanProgress::getBytesScanned() {
+  return bytesScanned;
+}
+
+size_t ScanProgress::getPagesSkipped() {
+  return pagesSkipped;
+}
+
+size_t ScanProgress::getHits() {
+  return hits;
+}
+
+double ScanProgress::getFraction() {
+  double seconds = duration;
+  if (seconds > 0) {
+    return running ? min(1.0, getElapsedSeconds() / seconds) : 1;
+  }
+  size_t total = bytesTotal;
+  if (!total) return running ? 0 : 1;
+  return min(1.0, (double)bytesScanned / total);
+}
+
+double ScanProgress::getElapsedSeconds() {
+  chrono::steady_clock::time_point start{ chrono::steady_clock::duration(startTime.load()) };
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+double ScanProgress::getEtaSeconds() {
+  double fraction = getFraction();
+  if (fraction <= 0) return -1;
+  return getElapsedSeconds() * (1 - fraction) / fraction;
+}
@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <tuple>
+#include <unistd.h>
+
+#include "med/MedCommon.hpp"
+#include "med/MedException.hpp"
+#include "mem/ScanRanges.hpp"
+#include "mem/StringUtil.hpp"
+
+using namespace std;
+
+const char* ANONYMOUS_MODULE = "anon";
+
+ScanRanges::ScanRanges() {}
+
+ScanRanges ScanRanges::parse(const string& spec) {
+  ScanRanges ranges;
+  string normalized = spec;
+  replace(normalized.begin(), normalized.end(), ',', ' ');
+
+  for (auto& token : StringUtil::split(normalized, ' ')) {
+    string range = StringUtil::trim(token);
+    if (range.empty()) continue;
+
+    size_t dash = range.find('-');
+    bool isInterval = dash != string::npos && dash > 0 &&
+      range.find_first_not_of("0123456789abcdefABCDEFxX-") == string::npos;
+    if (!isInterval) {
+      ranges.addModule(range);
+      continue;
+    }
+
+    Address start = hexToInt(range.substr(0, dash));
+    Address end = hexToInt(range.substr(dash + 1));
+    if (end <= start) {
+      throw MedException("Invalid scan range: " + range);
+    }
+    ranges.addInterval(start, end);
+  }
+  return ranges;
+}
+
+void ScanRanges::addInterval(Address start, Address end) {
+  intervals.push_back(AddressPair(start, end));
+}
+
+void ScanRanges::addModule(const string& name) {
+  modules.push_back(name);
+}
+
+void ScanRanges::clear() {
+  intervals.clear();
+  modules.clear();
+}
+
+bool ScanRanges::isEmpty() {
+  return intervals.empty() && modules.empty();
+}
+
+AddressPairs& ScanRanges::getIntervals() {
+  return intervals;
+}
+
+vector<string>& ScanRanges::getModules() {
+  return modules;
+}
+
+bool ScanRanges::matchModule(Maps& maps, int index) {
+  string& path = maps.getName(index);
+  string filename = path.substr(path.find_last_of('/') + 1);
+  for (auto& module : modules) {
+    if (module == ANONYMOUS_MODULE && maps.isAnonymous(index)) return true;
+    if (path.size() && (module == path || module == filename)) return true;
+  }
+  return false;
+}
+
+Maps ScanRanges::apply(Maps& maps) {
+  vector<tuple<Address, Address, string>> parts;
+  Address pageSize = getpagesize();
+  auto& pairs = maps.getMaps();
+  for (size_t i = 0; i < pairs.size(); i++) {
+    Address start = std::get<0>(pairs[i]);
+    Address end = std::get<1>(pairs[i]);
+    if (matchModule(maps, i)) {
+      parts.push_back(make_tuple(start, end, maps.getName(i)));
+      continue;
+    }
+    // Intervals are extended to whole pages, as the scan reads by pages
+    for (auto& interval : intervals) {
+      Address partStart = max(start, std::get<0>(interval) / pageSize * pageSize);
+      Address partEnd = min(end, (std::get<1>(interval) + pageSize - 1) / pageSize * pageSize);
+      if (partStart < partEnd) {
+        parts.push_back(make_tuple(partStart, partEnd, maps.getName(i)));
+      }
+    }
+  }
+  sort(parts.begin(), parts.end());
+
+  // Merge the overlapping parts, which are covered by several ranges
+  Maps result;
+  for (size_t i = 0; i < parts.size(); i++) {
+    Address start = std::get<0>(parts[i]);
+    Address end = std::get<1>(parts[i]);
+    while (i + 1 < parts.size() && std::get<0>(parts[i + 1]) < end) {
+      end = max(end, std::get<1>(parts[++i]));
+    }
+    result.push(AddressPair(start, end), std::get<2>(parts[i]));
+  }
+  return result;
+}
+
+string ScanRanges::toString() {
+  string str;
+  for (auto& interval : intervals) {
+    if (str.size()) str += " ";
+    str += intToHex(std::get<0>(interval)) + "-" + intToHex(std::get<1>(interval));
+  }
+  for (auto& module : modules) {
+    if (str.size()) str += " ";
+    str += module;
+  }
+  return str;
+}
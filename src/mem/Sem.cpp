@@ -15,6 +15,7 @@ Sem::Sem(Sem& sem) : Pem(sem.getSize(), sem.getMemIO()) {
   setScanType(sem.getScanType());
   locked = false;
   description = sem.getDescription();
+  signature = sem.getSignature();
 }
 
 Sem::Sem(size_t size, MemIO* memio) : Pem(size, memio) {
@@ -56,6 +57,14 @@ void Sem::lockValue() {
   setValue(getLockedValue(), getScanType());
 }
 
+Signature& Sem::getSignature() {
+  return signature;
+}
+
+void Sem::setSignature(const Signature& signature) {
+  this->signature = signature;
+}
+
 SemPtr Sem::clone(SemPtr semPtr) {
   // It is:
   // Sem* storedPtr = semPtr.get();
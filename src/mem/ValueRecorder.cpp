@@ -0,0 +1,259 @@
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+#include "mem/ValueRecorder.hpp"
+#include "med/MedCommon.hpp"
+#include "med/MedException.hpp"
+
+using namespace std;
+
+ValueRecorder::ValueRecorder(MemIO* memio, size_t capacity) {
+  this->memio = memio;
+  this->capacity = capacity;
+  times.reset(new std::atomic<int64_t>[capacity]);
+  failures.reset(new std::atomic<uint64_t>[capacity]);
+  head = 0;
+  running = false;
+  thread = NULL;
+  rate = RECORDER_DEFAULT_RATE;
+}
+
+ValueRecorder::~ValueRecorder() {
+  stop();
+}
+
+void ValueRecorder::setTracks(const vector<RecorderTrack>& tracks) {
+  if (running) {
+    throw MedException("Stop the recording before changing the addresses");
+  }
+  if (tracks.size() > RECORDER_TRACKS_MAX) {
+    throw MedException("Record at most " + to_string(RECORDER_TRACKS_MAX) + " addresses");
+  }
+  vector<ScanType> types;
+  for (auto& track : tracks) {
+    ScanType type = stringToScanType(track.scanType);
+    if (type == String || type == Custom || type == Unknown) {
+      throw MedException("Cannot record the value of " + track.scanType);
+    }
+    types.push_back(type);
+  }
+  this->tracks = tracks;
+  this->types = types;
+  values.reset(new std::atomic<uint64_t>[capacity * max((size_t)1, tracks.size())]);
+  head = 0;
+}
+
+vector<RecorderTrack>& ValueRecorder::getTracks() {
+  return tracks;
+}
+
+void ValueRecorder::start(double rate) {
+  if (running) {
+    throw MedException("Recording is running");
+  }
+  if (tracks.empty()) {
+    throw MedException("No addresses to record");
+  }
+  if (rate <= 0 || rate > RECORDER_RATE_MAX) {
+    throw MedException("Record at up to " + to_string((int)RECORDER_RATE_MAX) + " samples per second");
+  }
+  this->rate = rate;
+  head = 0;
+  running = true;
+  thread = new std::thread(&ValueRecorder::run, this);
+}
+
+void ValueRecorder::stop() {
+  running = false;
+  if (thread) {
+    thread->join();
+    delete thread;
+    thread = NULL;
+  }
+}
+
+bool ValueRecorder::isRunning() {
+  return running;
+}
+
+double ValueRecorder::getRate() {
+  return rate;
+}
+
+void ValueRecorder::run() {
+  vector<MemRequest> requests(tracks.size());
+  vector<uint64_t> raws(tracks.size());
+  auto interval = chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(1.0 / rate));
+  startTime = chrono::steady_clock::now();
+  auto next = startTime;
+  while (running) {
+    auto now = chrono::steady_clock::now();
+    record(requests, raws, chrono::duration_cast<chrono::microseconds>(now - startTime).count());
+
+    // Behind by more than a sample, the missed ones are skipped instead of read in a burst
+    next += interval;
+    now = chrono::steady_clock::now();
+    if (now > next + interval) {
+      next = now;
+    }
+    std::this_thread::sleep_until(next);
+  }
+}
+
+void ValueRecorder::record(vector<MemRequest>& requests, vector<uint64_t>& raws, int64_t timeUs) {
+  for (size_t i = 0; i < tracks.size(); i++) {
+    raws[i] = 0;
+    requests[i] = MemRequest{ tracks[i].address, (Byte*)&raws[i], (size_t)scanTypeToSize(types[i]), false };
+  }
+  memio->readBatch(requests);
+
+  size_t n = head.load(std::memory_order_relaxed);
+  size_t slot = n % capacity;
+  uint64_t failed = 0;
+  for (size_t i = 0; i < tracks.size(); i++) {
+    if (!requests[i].success) {
+      failed |= (uint64_t)1 << i;
+    }
+    values[slot * tracks.size() + i].store(raws[i], std::memory_order_relaxed);
+  }
+  times[slot].store(timeUs, std::memory_order_relaxed);
+  failures[slot].store(failed, std::memory_order_relaxed);
+  head.store(n + 1, std::memory_order_release);
+}
+
+size_t ValueRecorder::getRecorded() {
+  return head.load(std::memory_order_acquire);
+}
+
+vector<RecorderSample> ValueRecorder::getSamples(size_t max) {
+  size_t end = head.load(std::memory_order_acquire);
+  size_t begin = end > capacity ? end - capacity : 0;
+  if (end - begin > max) {
+    begin = end - max;
+  }
+
+  vector<RecorderSample> samples;
+  samples.reserve(end - begin);
+  for (size_t n = begin; n < end; n++) {
+    size_t slot = n % capacity;
+    RecorderSample sample;
+    sample.timeUs = times[slot].load(std::memory_order_relaxed);
+    sample.failed = failures[slot].load(std::memory_order_relaxed);
+    sample.values.resize(tracks.size());
+    for (size_t i = 0; i < tracks.size(); i++) {
+      sample.values[i] = toDouble(values[slot * tracks.size() + i].load(std::memory_order_relaxed), types[i]);
+    }
+    samples.push_back(std::move(sample));
+  }
+
+  // The slots which the recording thread wrote again meanwhile are not consistent. While it runs, so is
+  // the slot of the sample "latest", which it may be writing now over the sample "latest - capacity".
+  std::atomic_thread_fence(std::memory_order_acquire);
+  size_t latest = head.load(std::memory_order_relaxed) + (running ? 1 : 0);
+  if (latest > capacity && latest - capacity > begin) {
+    size_t overwritten = min(samples.size(), latest - capacity - begin);
+    samples.erase(samples.begin(), samples.begin() + overwritten);
+  }
+  return samples;
+}
+
+double ValueRecorder::toDouble(uint64_t raw, ScanType type) {
+  switch (type) {
+  case Int8:
+    return (uint8_t)raw;
+  case Int16:
+    return (uint16_t)raw;
+  case Int32:
+  case Ptr32:
+    return (uint32_t)raw;
+  case Float32: {
+    float value;
+    uint32_t bits = (uint32_t)raw;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+  case Float64: {
+    double value;
+    memcpy(&value, &raw, sizeof(value));
+    return value;
+  }
+  default:
+    return (double)raw;
+  }
+}
+
+void ValueRecorder::saveCsv(const string& filename) {
+  if (running) {
+    throw MedException("Stop the recording before saving it");
+  }
+  ofstream ofs(filename);
+  if (ofs.fail()) {
+    throw MedException("Save recording: Fail to open file " + filename);
+  }
+  ofs << "time_ms";
+  for (auto& track : tracks) {
+    string name = track.description.size() ? track.description : intToHex(track.address);
+    string quoted;
+    for (char ch : name) {
+      quoted += ch == '"' ? "\"\"" : string(1, ch);
+    }
+    ofs << ",\"" << quoted << "\"";
+  }
+  ofs << "\n" << setprecision(17);
+
+  for (auto& sample : getSamples()) {
+    ofs << sample.timeUs / 1000.0;
+    for (size_t i = 0; i < sample.values.size(); i++) {
+      ofs << ",";
+      if (!(sample.failed >> i & 1)) {
+        ofs << sample.values[i];
+      }
+    }
+    ofs << "\n";
+  }
+  if (ofs.fail()) {
+    throw MedException("Save recording: Fail to write file " + filename);
+  }
+}
+
+void ValueRecorder::saveBinary(const string& filename) {
+  if (running) {
+    throw MedException("Stop the recording before saving it");
+  }
+  ofstream ofs(filename, ios::binary);
+  if (ofs.fail()) {
+    throw MedException("Save recording: Fail to open file " + filename);
+  }
+  auto write64 = [&ofs](uint64_t value) {
+    ofs.write((const char*)&value, sizeof(value));
+  };
+  auto writeString = [&ofs, &write64](const string& value) {
+    write64(value.size());
+    ofs.write(value.data(), value.size());
+  };
+
+  // The raw values, as the bytes of the memory
+  size_t end = head.load(std::memory_order_acquire);
+  size_t begin = end > capacity ? end - capacity : 0;
+  ofs.write(RECORDER_MAGIC, sizeof(RECORDER_MAGIC));
+  write64(tracks.size());
+  for (auto& track : tracks) {
+    write64(track.address);
+    writeString(track.scanType);
+    writeString(track.description);
+  }
+  write64(end - begin);
+  for (size_t n = begin; n < end; n++) {
+    size_t slot = n % capacity;
+    write64(times[slot].load(std::memory_order_relaxed));
+    write64(failures[slot].load(std::memory_order_relaxed));
+    for (size_t i = 0; i < tracks.size(); i++) {
+      write64(values[slot * tracks.size() + i].load(std::memory_order_relaxed));
+    }
+  }
+  if (ofs.fail()) {
+    throw MedException("Save recording: Fail to write file " + filename);
+  }
+}
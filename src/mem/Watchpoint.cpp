@@ -0,0 +1,339 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <iostream>
+#include <signal.h>
+#include <sys/ptrace.h>
+#include <sys/syscall.h>
+#include <sys/user.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+#include "mem/Watchpoint.hpp"
+#include "med/MedCommon.hpp"
+#include "med/MedException.hpp"
+#include "med/Metrics.hpp"
+
+using namespace std;
+
+#if defined(__x86_64__)
+#define WATCH_SUPPORTED
+#define WATCH_IP_OFFSET offsetof(struct user, regs.rip)
+#elif defined(__i386__)
+#define WATCH_SUPPORTED
+#define WATCH_IP_OFFSET offsetof(struct user, regs.eip)
+#endif
+
+#ifdef WATCH_SUPPORTED
+#define WATCH_DR_OFFSET(i) (offsetof(struct user, u_debugreg) + (i) * sizeof(((struct user*)0)->u_debugreg[0]))
+#endif
+
+namespace {
+  string toHex(Address value) {
+    char str[32];
+    snprintf(str, sizeof(str), "0x%lx", (unsigned long)value);
+    return string(str);
+  }
+}
+
+string WatchHit::toString() const {
+  if (module.empty()) return toHex(ip);
+  return module + "+" + toHex(offset);
+}
+
+Watchpoint::Watchpoint(pid_t pid) {
+  this->pid = pid;
+}
+
+void Watchpoint::add(Address address, size_t size) {
+  if (!size) {
+    throw MedException("Nothing to watch");
+  }
+  // The debug register watches the range aligned to its length
+  vector<WatchRange> added;
+  while (size) {
+    size_t length = sizeof(long);
+    while (length > size || address % length) {
+      length /= 2;
+    }
+    added.push_back(WatchRange{ address, length });
+    address += length;
+    size -= length;
+  }
+  if (ranges.size() + added.size() > WATCH_SLOTS) {
+    throw MedException("Watch at most " + to_string(WATCH_SLOTS) + " aligned ranges of up to " +
+                       to_string(sizeof(long)) + " bytes");
+  }
+  ranges.insert(ranges.end(), added.begin(), added.end());
+}
+
+vector<WatchRange>& Watchpoint::getRanges() {
+  return ranges;
+}
+
+uint64_t Watchpoint::makeControl(const vector<WatchRange>& ranges) {
+  uint64_t control = 0;
+  for (size_t i = 0; i < ranges.size(); i++) {
+    uint64_t length;
+    switch (ranges[i].size) {
+    case 1: length = 0; break;
+    case 2: length = 1; break;
+    case 8: length = 2; break;
+    default: length = 3; break;
+    }
+    control |= (uint64_t)1 << (i * 2); // Local enable
+    control |= (uint64_t)1 << (16 + i * 4); // Break on the data writes
+    control |= length << (18 + i * 4);
+  }
+  return control;
+}
+
+vector<pid_t> Watchpoint::listThreads(pid_t pid) {
+  vector<pid_t> tids;
+  string path = "/proc/" + to_string(pid) + "/task";
+  DIR* d = opendir(path.c_str());
+  if (!d) {
+    throw MedException("Failed to list the threads of " + to_string(pid));
+  }
+  struct dirent* dir;
+  while ((dir = readdir(d)) != NULL) {
+    if (dir->d_name[0] < '0' || dir->d_name[0] > '9') continue;
+    tids.push_back(atoi(dir->d_name));
+  }
+  closedir(d);
+  sort(tids.begin(), tids.end());
+  return tids;
+}
+
+#ifndef WATCH_SUPPORTED
+
+void Watchpoint::watch(double, ScanProgress&) {
+  throw MedException("Watchpoints need the x86 debug registers");
+}
+
+bool Watchpoint::attach(pid_t) { return false; }
+void Watchpoint::setRegisters(pid_t, uint64_t) {}
+void Watchpoint::handleStop(pid_t, int, uint64_t, ScanProgress&) {}
+void Watchpoint::release(pid_t, ScanProgress&) {}
+
+#else
+
+void Watchpoint::watch(double seconds, ScanProgress& progress) {
+  if (ranges.empty()) {
+    throw MedException("No address to watch");
+  }
+  if (seconds <= 0) {
+    throw MedException("Watch duration must be positive");
+  }
+  counts.clear();
+  threads.clear();
+  starting.clear();
+  uint64_t control = makeControl(ranges);
+
+  // Attach again until no thread is created meanwhile
+  try {
+    bool attached = true;
+    while (attached) {
+      attached = false;
+      for (pid_t tid : listThreads(pid)) {
+        if (threads.count(tid)) continue;
+        if (attach(tid)) {
+          attached = true;
+        } else if (tid == pid) {
+          throw MedException("Failed to attach " + to_string(pid));
+        }
+      }
+    }
+    for (pid_t tid : threads) {
+      setRegisters(tid, control);
+    }
+  } catch (MedException& ex) {
+    for (pid_t tid : threads) {
+      setRegisters(tid, 0);
+      try {
+        pidDetach(tid);
+      } catch (MedException& ex) {}
+    }
+    threads.clear();
+    throw;
+  }
+  for (pid_t tid : threads) {
+    ptrace(PTRACE_CONT, tid, NULL, 0);
+  }
+
+  auto end = chrono::steady_clock::now() +
+    chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(seconds));
+  progress.startTimed(seconds);
+  while (!progress.isCancelled() && threads.size() && chrono::steady_clock::now() < end) {
+    // Only the watched threads are waited for, the other children of the process are not reaped.
+    // The stop of a created thread stays pending until the clone event of its creator adds it.
+    bool stopped = false;
+    vector<pid_t> tids(threads.begin(), threads.end());
+    for (pid_t tid : tids) {
+      int status;
+      pid_t waited = waitpid(tid, &status, __WALL | WNOHANG);
+      if (waited == -1 && errno == ECHILD) {
+        threads.erase(tid); // Gone without its exit seen
+        starting.erase(tid);
+      }
+      if (waited <= 0) continue;
+      stopped = true;
+      handleStop(tid, status, control, progress);
+    }
+    if (!stopped) {
+      std::this_thread::sleep_for(chrono::microseconds(WATCH_POLL_US));
+    }
+  }
+
+  loadModules();
+  while (threads.size()) {
+    release(*threads.begin(), progress);
+  }
+  progress.finish();
+}
+
+bool Watchpoint::attach(pid_t tid) {
+  try {
+    pidAttach(tid);
+  } catch (MedException& ex) {
+    return false;
+  }
+  Metrics::getInstance().add(Counter::PtraceAttaches);
+  threads.insert(tid);
+  ptrace(PTRACE_SETOPTIONS, tid, NULL, PTRACE_O_TRACECLONE);
+  return true;
+}
+
+void Watchpoint::setRegisters(pid_t tid, uint64_t control) {
+  Metrics::getInstance().add(Counter::Syscalls, control ? ranges.size() + 1 : 1);
+  if (!control) {
+    ptrace(PTRACE_POKEUSER, tid, WATCH_DR_OFFSET(7), 0);
+    return;
+  }
+  // The addresses first, the control is checked against them
+  for (size_t i = 0; i < ranges.size(); i++) {
+    if (ptrace(PTRACE_POKEUSER, tid, WATCH_DR_OFFSET(i), ranges[i].address) == -1L) {
+      throw MedException("Failed to set the debug registers: " + string(strerror(errno)));
+    }
+  }
+  if (ptrace(PTRACE_POKEUSER, tid, WATCH_DR_OFFSET(7), control) == -1L) {
+    throw MedException("Failed to set the debug registers: " + string(strerror(errno)));
+  }
+}
+
+void Watchpoint::handleStop(pid_t tid, int status, uint64_t control, ScanProgress& progress) {
+  Metrics& metrics = Metrics::getInstance();
+  if (WIFEXITED(status) || WIFSIGNALED(status)) {
+    threads.erase(tid);
+    starting.erase(tid);
+    return;
+  }
+  if (!WIFSTOPPED(status)) return;
+  int sig = WSTOPSIG(status);
+  int event = status >> 16;
+
+  // The thread created by a watched one is attached, and starts with SIGSTOP.
+  // It does not inherit the debug registers. It is waited for once the event of the creator is seen.
+  if (starting.count(tid) && sig == SIGSTOP) {
+    starting.erase(tid);
+    try {
+      setRegisters(tid, control);
+    } catch (MedException& ex) {
+      cerr << ex.getMessage() << endl;
+    }
+    ptrace(PTRACE_CONT, tid, NULL, 0);
+    return;
+  }
+  if (event == PTRACE_EVENT_CLONE) {
+    unsigned long newTid;
+    if (ptrace(PTRACE_GETEVENTMSG, tid, NULL, &newTid) != -1L && !threads.count(newTid)) {
+      threads.insert(newTid);
+      starting.insert(newTid);
+    }
+    ptrace(PTRACE_CONT, tid, NULL, 0);
+    return;
+  }
+  if (event) {
+    ptrace(PTRACE_CONT, tid, NULL, 0);
+    return;
+  }
+
+  if (sig == SIGTRAP) {
+    errno = 0;
+    long debugStatus = ptrace(PTRACE_PEEKUSER, tid, WATCH_DR_OFFSET(6), NULL);
+    if (!errno && (debugStatus & ((1 << ranges.size()) - 1))) {
+      long ip = ptrace(PTRACE_PEEKUSER, tid, WATCH_IP_OFFSET, NULL);
+      counts[(Address)ip]++;
+      progress.addHits();
+      // The status bits are sticky
+      ptrace(PTRACE_POKEUSER, tid, WATCH_DR_OFFSET(6), 0);
+      ptrace(PTRACE_CONT, tid, NULL, 0);
+      metrics.add(Counter::Syscalls, 5);
+      return;
+    }
+  }
+  // Any other signal is delivered to the process, as without the watch
+  ptrace(PTRACE_CONT, tid, NULL, sig);
+}
+
+void Watchpoint::release(pid_t tid, ScanProgress& progress) {
+  // The thread has to be stopped to clear its registers, the starting one is stopped by itself
+  bool stopping = starting.count(tid) || syscall(SYS_tgkill, pid, tid, SIGSTOP) == 0;
+  while (stopping) {
+    int status;
+    if (waitpid(tid, &status, __WALL) == -1 || WIFEXITED(status) || WIFSIGNALED(status)) break;
+    if (WIFSTOPPED(status) && WSTOPSIG(status) == SIGSTOP && !(status >> 16)) {
+      setRegisters(tid, 0);
+      try {
+        pidDetach(tid);
+      } catch (MedException& ex) {}
+      break;
+    }
+    // Until then, it may hit or create a thread
+    handleStop(tid, status, 0, progress);
+  }
+  threads.erase(tid);
+  starting.erase(tid);
+}
+
+#endif
+
+void Watchpoint::loadModules() {
+  modules.clear();
+  ifstream file("/proc/" + to_string(pid) + "/maps");
+  string line;
+  while (getline(file, line)) {
+    unsigned long start, end, offset;
+    char perms[8];
+    int pathStart = 0;
+    if (sscanf(line.c_str(), "%lx-%lx %7s %lx %*s %*u %n", &start, &end, perms, &offset, &pathStart) < 4) continue;
+    if (!pathStart || pathStart >= (int)line.size() || line[pathStart] == '[') continue;
+    string path = line.substr(pathStart);
+    modules.push_back(Module{ start, end, start - offset, path.substr(path.find_last_of('/') + 1) });
+  }
+}
+
+vector<WatchHit> Watchpoint::getHits() {
+  vector<WatchHit> hits;
+  for (auto& entry : counts) {
+    WatchHit hit{ entry.first, entry.second, "", entry.first };
+    for (auto& module : modules) {
+      if (hit.ip >= module.start && hit.ip < module.end) {
+        hit.module = module.name;
+        hit.offset = hit.ip - module.base;
+        break;
+      }
+    }
+    hits.push_back(hit);
+  }
+  stable_sort(hits.begin(), hits.end(), [](const WatchHit& a, const WatchHit& b) {
+      return a.count > b.count;
+    });
+  return hits;
+}
@@ -258,7 +258,11 @@ void MemEditor::writeToProcessMemory(int position, char ch) {
 
   Address address = getAddressByCursorPosition(position);
   if (address) {
-    mainUi->med->setValueByAddress(address, value, SCAN_TYPE_INT_8);
+    try {
+      mainUi->med->setValueByAddress(address, value, SCAN_TYPE_INT_8);
+    } catch (MedException& ex) {
+      mainUi->statusBar->showMessage(ex.what());
+    }
   }
 
   refresh();
@@ -330,6 +334,10 @@ void MemEditor::onEnterClicked() {
 
   if (!address) return;
 
-  mainUi->med->setValueByAddress(address, value, scanType);
+  try {
+    mainUi->med->setValueByAddress(address, value, scanType);
+  } catch (MedException& ex) {
+    mainUi->statusBar->showMessage(ex.what());
+  }
   refresh();
 }
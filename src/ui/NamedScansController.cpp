@@ -3,6 +3,7 @@
 #include "ui/Ui.hpp"
 #include "ui/NamedScansController.hpp"
 #include "mem/StringUtil.hpp"
+#include "med/MedException.hpp"
 
 using namespace std;
 
@@ -33,7 +34,13 @@ void NamedScansController::onAddClicked() {
   auto nameInput = mainWindow->findChild<QLineEdit*>("namedScan_name");
   string name = nameInput->text().toStdString();
   auto trimmed = StringUtil::trim(name);
-  auto result = namedScans->addNewScan(trimmed);
+  MemList* result;
+  {
+    // The combined scan reads the other named scans, which the scan job can replace
+    std::lock_guard<std::mutex> lock(med->getScanListMutex());
+    result = NamedScans::isCombinedScan(trimmed) ?
+      namedScans->addCombinedScan(trimmed) : namedScans->addNewScan(trimmed);
+  }
   if (!result) return;
 
   comboBox->addItem(QString(trimmed.c_str()));
@@ -48,14 +55,24 @@ void NamedScansController::selectByName(string name) {
   if (index < 0) return;
 
   comboBox->setCurrentIndex(index);
-  namedScans->setActiveName(trimmed);
+  try {
+    med->setActiveScanName(trimmed);
+  } catch (MedException &ex) {
+    mainUi->statusBar->showMessage(ex.what());
+  }
 }
 
 void NamedScansController::onDeleteClicked() {
   string name = comboBox->currentText().toStdString();
   auto trimmed = StringUtil::trim(name);
   int index = comboBox->currentIndex();
-  auto result = namedScans->remove(trimmed);
+  bool result;
+  try {
+    result = med->removeNamedScan(trimmed);
+  } catch (MedException &ex) {
+    mainUi->statusBar->showMessage(ex.what());
+    return;
+  }
   if (!result) return;
 
   comboBox->setCurrentIndex(0); // Default
@@ -65,7 +82,12 @@ void NamedScansController::onDeleteClicked() {
 void NamedScansController::onComboBoxChanged(int) {
   string name = comboBox->currentText().toStdString();
   auto trimmed = StringUtil::trim(name);
-  namedScans->setActiveName(trimmed);
+  try {
+    med->setActiveScanName(trimmed);
+  } catch (MedException &ex) {
+    mainUi->statusBar->showMessage(ex.what());
+    return;
+  }
   updateScanTree();
   updateScanType();
 }
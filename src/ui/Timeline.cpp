@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <cmath>
+
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QPainter>
+#include <QVBoxLayout>
+
+#include "ui/Timeline.hpp"
+#include "med/MedCommon.hpp"
+#include "med/MedException.hpp"
+
+using namespace std;
+
+TimelinePlot::TimelinePlot(ValueRecorder* recorder, QWidget* parent) : QWidget(parent) {
+  this->recorder = recorder;
+  setMinimumSize(500, 250);
+}
+
+void TimelinePlot::paintEvent(QPaintEvent*) {
+  QPainter painter(this);
+  painter.fillRect(rect(), Qt::white);
+  painter.setPen(Qt::lightGray);
+  painter.drawRect(rect().adjusted(0, 0, -1, -1));
+
+  auto samples = recorder->getSamples(TIMELINE_PLOT_SAMPLES);
+  auto& tracks = recorder->getTracks();
+  if (samples.size() < 2 || tracks.empty()) return;
+
+  double startTime = samples.front().timeUs;
+  double duration = max(1.0, samples.back().timeUs - startTime);
+  int lineHeight = painter.fontMetrics().height();
+
+  painter.setRenderHint(QPainter::Antialiasing);
+  for (size_t i = 0; i < tracks.size(); i++) {
+    double low = INFINITY, high = -INFINITY;
+    for (auto& sample : samples) {
+      if (sample.failed >> i & 1) continue;
+      low = min(low, sample.values[i]);
+      high = max(high, sample.values[i]);
+    }
+    if (low > high) continue;
+    double range = high > low ? high - low : 1;
+
+    // The line breaks where the value is not read
+    QColor color = QColor::fromHsv((int)(i * 360 / tracks.size()), 200, 180);
+    painter.setPen(QPen(color, 1.5));
+    QPainterPath path;
+    bool drawing = false;
+    for (auto& sample : samples) {
+      if (sample.failed >> i & 1) {
+        drawing = false;
+        continue;
+      }
+      double x = (sample.timeUs - startTime) / duration * (width() - 1);
+      double y = (height() - 1) - (sample.values[i] - low) / range * (height() - 1);
+      if (drawing) {
+        path.lineTo(x, y);
+      } else {
+        path.moveTo(x, y);
+        drawing = true;
+      }
+    }
+    painter.drawPath(path);
+
+    string name = tracks[i].description.size() ? tracks[i].description : intToHex(tracks[i].address);
+    QString legend = QString::fromStdString(name) + QString(" [%1, %2]").arg(low).arg(high);
+    painter.drawText(6, lineHeight * (int)(i + 1), legend);
+  }
+}
+
+Timeline::Timeline(MedUi* mainUi) : QWidget(NULL, Qt::SubWindow) {
+  this->mainUi = mainUi;
+  this->med = mainUi->med;
+  setWindowTitle("Timeline");
+
+  plot = new TimelinePlot(med->getRecorder(), this);
+  rateSpin = new QDoubleSpinBox(this);
+  rateSpin->setRange(1, RECORDER_RATE_MAX);
+  rateSpin->setValue(RECORDER_DEFAULT_RATE);
+  rateSpin->setSuffix(" Hz");
+  startButton = new QPushButton("&Start", this);
+  stopButton = new QPushButton("S&top", this);
+  csvButton = new QPushButton("Export &CSV", this);
+  binaryButton = new QPushButton("Export &Binary", this);
+  statusLabel = new QLabel(this);
+
+  QHBoxLayout* controls = new QHBoxLayout;
+  controls->addWidget(rateSpin);
+  controls->addWidget(startButton);
+  controls->addWidget(stopButton);
+  controls->addWidget(statusLabel, 1);
+  controls->addWidget(csvButton);
+  controls->addWidget(binaryButton);
+  QVBoxLayout* layout = new QVBoxLayout;
+  layout->addWidget(plot, 1);
+  layout->addLayout(controls);
+  this->setLayout(layout);
+  this->resize(750, 400);
+
+  timer = new QTimer(this);
+  QObject::connect(startButton, SIGNAL(clicked()), this, SLOT(onStartClicked()));
+  QObject::connect(stopButton, SIGNAL(clicked()), this, SLOT(onStopClicked()));
+  QObject::connect(csvButton, SIGNAL(clicked()), this, SLOT(onExportCsvClicked()));
+  QObject::connect(binaryButton, SIGNAL(clicked()), this, SLOT(onExportBinaryClicked()));
+  QObject::connect(timer, SIGNAL(timeout()), this, SLOT(onTimerTimeout()));
+  updateControls();
+}
+
+void Timeline::record(const vector<int>& rows) {
+  this->rows = rows;
+  onStartClicked();
+}
+
+void Timeline::onStartClicked() {
+  try {
+    med->startRecording(rows, rateSpin->value());
+    timer->start(TIMELINE_REFRESH_MS);
+  } catch (MedException& ex) {
+    statusLabel->setText(ex.what());
+  }
+  updateControls();
+}
+
+void Timeline::onStopClicked() {
+  med->stopRecording();
+  timer->stop();
+  plot->update();
+  updateControls();
+}
+
+void Timeline::onExportCsvClicked() {
+  exportRecording(false);
+}
+
+void Timeline::onExportBinaryClicked() {
+  exportRecording(true);
+}
+
+void Timeline::exportRecording(bool binary) {
+  QString filename = QFileDialog::getSaveFileName(this,
+                                                  "Export Recording",
+                                                  "./",
+                                                  binary ? "Recording (*.medrec)" : "CSV (*.csv)");
+  if (filename == "") return;
+  try {
+    ValueRecorder* recorder = med->getRecorder();
+    if (binary) {
+      recorder->saveBinary(filename.toStdString());
+    } else {
+      recorder->saveCsv(filename.toStdString());
+    }
+    statusLabel->setText("Exported " + filename);
+  } catch (MedException& ex) {
+    statusLabel->setText(ex.what());
+  }
+}
+
+void Timeline::onTimerTimeout() {
+  plot->update();
+  updateControls();
+}
+
+void Timeline::updateControls() {
+  ValueRecorder* recorder = med->getRecorder();
+  bool running = recorder->isRunning();
+  startButton->setEnabled(!running && rows.size());
+  stopButton->setEnabled(running);
+  rateSpin->setEnabled(!running);
+  csvButton->setEnabled(!running && recorder->getRecorded());
+  binaryButton->setEnabled(!running && recorder->getRecorded());
+  if (running) {
+    statusLabel->setText(QString("%1 samples").arg(recorder->getRecorded()));
+  }
+}
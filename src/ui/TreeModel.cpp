@@ -198,6 +198,10 @@ void TreeModel::clearAll() {
 void TreeModel::addScan(string scanType) {
   this->clearAll();
   auto scans = med->getScans();
+  appendScans(scans, scanType);
+}
+
+void TreeModel::appendScans(MemList& scans, string scanType) {
   for(size_t i = 0; i < scans.size(); i++) {
     string address = scans.getAddressAsString(i);
     string value = scans.getValue(i, scanType);
@@ -1,8 +1,10 @@
+#include <algorithm>
 #include <cstdio>
 #include <iostream>
 
 #include <QtUiTools>
 #include <QtDebug>
+#include <QMessageBox>
 
 #include "med/MedException.hpp"
 #include "med/MedCommon.hpp"
@@ -14,19 +16,23 @@
 #include "ui/CheckBoxDelegate.hpp"
 #include "ui/EncodingManager.hpp"
 #include "ui/MemEditor.hpp"
+#include "ui/Timeline.hpp"
 
 using namespace std;
 
 MedUi::MedUi(QApplication* app) {
   this->app = app;
   this->autoRefresh = true;
+  this->scanJobPreview = false;
   this->fastScan = true;
+  scanTimer = new QTimer(this);
   med = new MemEd();
   scanUpdateMutex = &med->getScanListMutex();
 
   loadUiFiles();
   loadProcessUi();
   loadMemEditor();
+  loadTimeline();
   setupStatusBar();
   setupScanTreeView();
   setupStoreTreeView();
@@ -58,6 +64,8 @@ void MedUi::loadUiFiles() {
 
   selectedProcessLine = mainWindow->findChild<QLineEdit*>("selectedProcess");
   scanTypeCombo = mainWindow->findChild<QComboBox*>("scanType");
+  scanProgressBar = mainWindow->findChild<QProgressBar*>("scanProgress");
+  cancelButton = mainWindow->findChild<QPushButton*>("cancelButton");
   scanTreeView = mainWindow->findChild<QTreeView*>("scanTreeView");
   storeTreeView = mainWindow->findChild<QTreeView*>("storeTreeView");
 
@@ -95,6 +103,10 @@ void MedUi::loadMemEditor() {
   memEditor = new MemEditor(this);
 }
 
+void MedUi::loadTimeline() {
+  timeline = new Timeline(this);
+}
+
 void MedUi::setupUi() {
   scanTypeCombo->setCurrentIndex(2); // int32
   mainWindow->show();
@@ -102,6 +114,9 @@ void MedUi::setupUi() {
 
   refreshThread = new std::thread(MedUi::refresh, this);
 
+  scanProgressBar->hide();
+  cancelButton->hide();
+
   QAction* showNotesAction = mainWindow->findChild<QAction*>("actionShowNotes");
   if (showNotesAction->isChecked()) {
     notesArea->show();
@@ -133,6 +148,16 @@ void MedUi::setupSignals() {
                    this,
                    SLOT(onFilterClicked()));
 
+  QObject::connect(cancelButton,
+                   SIGNAL(clicked()),
+                   this,
+                   SLOT(onCancelClicked()));
+
+  QObject::connect(scanTimer,
+                   SIGNAL(timeout()),
+                   this,
+                   SLOT(onScanProgressTimeout()));
+
   QObject::connect(mainWindow->findChild<QWidget*>("pauseCheckbox"),
                    SIGNAL(clicked(bool)),
                    this,
@@ -163,6 +188,10 @@ void MedUi::setupSignals() {
                    SIGNAL(triggered()),
                    this,
                    SLOT(onSaveTriggered()));
+  QObject::connect(mainWindow->findChild<QAction*>("actionOpenDump"),
+                   SIGNAL(triggered()),
+                   this,
+                   SLOT(onOpenDumpTriggered()));
   QObject::connect(mainWindow->findChild<QAction*>("actionQuit"),
                    SIGNAL(triggered()),
                    this,
@@ -192,6 +221,18 @@ void MedUi::setupSignals() {
                    SIGNAL(triggered(bool)),
                    this,
                    SLOT(onResumeProcessTriggered(bool)));
+  QObject::connect(mainWindow->findChild<QAction*>("actionSample"),
+                   SIGNAL(triggered()),
+                   this,
+                   SLOT(onSampleTriggered()));
+  QObject::connect(mainWindow->findChild<QAction*>("actionUndoScan"),
+                   SIGNAL(triggered()),
+                   this,
+                   SLOT(onUndoScanTriggered()));
+  QObject::connect(mainWindow->findChild<QAction*>("actionRedoScan"),
+                   SIGNAL(triggered()),
+                   this,
+                   SLOT(onRedoScanTriggered()));
   QObject::connect(mainWindow->findChild<QAction*>("actionFastScan"),
                    SIGNAL(triggered(bool)),
                    this,
@@ -205,6 +246,14 @@ void MedUi::setupSignals() {
                    SIGNAL(clicked()),
                    this,
                    SLOT(onStorePrevClicked()));
+  QObject::connect(mainWindow->findChild<QPushButton*>("strideAddress"),
+                   SIGNAL(clicked()),
+                   this,
+                   SLOT(onStoreStrideClicked()));
+  QObject::connect(mainWindow->findChild<QPushButton*>("signatureAddress"),
+                   SIGNAL(clicked()),
+                   this,
+                   SLOT(onStoreSignatureClicked()));
   QObject::connect(mainWindow->findChild<QPushButton*>("storeShift"),
                    SIGNAL(clicked()),
                    this,
@@ -233,6 +282,14 @@ void MedUi::setupSignals() {
                    SIGNAL(triggered()),
                    this,
                    SLOT(onMemEditorTriggered()));
+  QObject::connect(mainWindow->findChild<QAction*>("actionTimeline"),
+                   SIGNAL(triggered()),
+                   this,
+                   SLOT(onTimelineTriggered()));
+  QObject::connect(mainWindow->findChild<QAction*>("actionFindWrites"),
+                   SIGNAL(triggered()),
+                   this,
+                   SLOT(onFindWritesTriggered()));
 
   QObject::connect(mainWindow->findChild<QLineEdit*>("scopeStart"),
                    SIGNAL(editingFinished()),
@@ -242,6 +299,10 @@ void MedUi::setupSignals() {
                    SIGNAL(editingFinished()),
                    this,
                    SLOT(onScopeEndEdited()));
+  QObject::connect(mainWindow->findChild<QLineEdit*>("scanRanges"),
+                   SIGNAL(editingFinished()),
+                   this,
+                   SLOT(onScanRangesEdited()));
 }
 
 void MedUi::setupScanTreeView() {
@@ -315,9 +376,16 @@ void MedUi::onProcessClicked() {
 void MedUi::onProcessItemDblClicked(QTreeWidgetItem* item, int) {
   int index = item->treeWidget()->indexOfTopLevelItem(item); //Get the current row index
 
-  Process process = med->selectProcessByIndex(med->processes.size() - 1 - index);
+  Process process;
+  try {
+    process = med->selectProcessByIndex(med->processes.size() - 1 - index);
+  } catch (MedException &ex) {
+    statusBar->showMessage(ex.what());
+    return;
+  }
 
   selectedProcessLine->setText(QString::fromLatin1((process.pid + " " + process.cmdline).c_str())); //Do not use fromStdString(), it will append with some unknown characters
+  statusBar->showMessage(QString::fromStdString("Memory access: " + med->getMemBackend()));
 
   processDialog->hide();
 }
@@ -346,29 +414,7 @@ void MedUi::onScanClicked() {
   scanModel->clearAll();
   scanUpdateMutex->unlock();
 
-  try {
-    med->scan(scanValue, scanType, fastScan, getLastDigit());
-  } catch(EmptyListException &ex) {
-    statusBar->showMessage(ex.what());
-    cerr << ex.what() << endl;
-    return;
-  } catch(MedException &ex) {
-    cerr << "scan: "<< ex.what() << endl;
-  }
-
-  if(med->getScans().size() <= SCAN_ADDRESS_VISIBLE_SIZE) {
-    scanUpdateMutex->lock();
-    scanModel->addScan(scanType);
-    scanUpdateMutex->unlock();
-  }
-
-  if (QString(scanValue.c_str()).trimmed() == "?") {
-    statusBar->showMessage("Snapshot saved");
-  }
-  updateNumberOfAddresses();
-  if (!med->getIsProcessPaused() && med->getCanResumeProcess()) {
-    med->resumeProcess();
-  }
+  startScanJob(scanValue, scanType, false);
 }
 
 
@@ -388,26 +434,176 @@ void MedUi::onFilterClicked() {
     scanValue = encodingManager->encode(scanValue);
   }
 
+  startScanJob(scanValue, scanType, true);
+}
+
+void MedUi::startScanJob(const string& scanValue, const string& scanType, bool isFilter) {
+  if (scanJob) {
+    statusBar->showMessage("Scan is running");
+    return;
+  }
+
+  scanJobValue = scanValue;
+  scanJobType = scanType;
   try {
-    med->filter(scanValue, scanType, fastScan);
-  } catch (EmptyListException &ex) {
+    if (isFilter) {
+      scanJob = med->filterAsync(scanValue, scanType, fastScan);
+    }
+    else {
+      scanJob = med->scanAsync(scanValue, scanType, fastScan, getLastDigit());
+    }
+  } catch (MedException &ex) {
     statusBar->showMessage(ex.what());
-    cerr << ex.what() << endl;
     return;
+  }
+  watchScanJob();
+}
+
+void MedUi::onSampleTriggered() {
+  if (scanJob) {
+    statusBar->showMessage("Scan is running");
+    return;
+  }
+
+  scanJobValue = SAMPLE_JOB_VALUE;
+  scanJobType = med->getNamedScans().getScanType();
+  try {
+    scanJob = med->sampleAsync();
   } catch (MedException &ex) {
-    cerr << "filter: "<< ex.what() << endl;
+    statusBar->showMessage(ex.what());
+    return;
+  }
+  watchScanJob();
+}
+
+void MedUi::watchScanJob() {
+  // Callback is on the job thread, queue it back to the UI thread
+  scanJob->setOnComplete([this](ScanJob&) {
+    QMetaObject::invokeMethod(this, "onScanJobFinished", Qt::QueuedConnection);
+  });
+
+  scanJobPreview = false;
+  setScanControlsEnabled(false);
+  scanTimer->start(SCAN_PROGRESS_RATE);
+}
+
+void MedUi::onScanProgressTimeout() {
+  if (!scanJob) return;
+
+  // The results found so far are shown until the table is full. It is filled again from the published
+  // scans when the job finishes.
+  vector<MemPtr> found = scanJob->takeFound();
+  if (found.size()) {
+    scanUpdateMutex->lock();
+    if (!scanJobPreview) {
+      scanModel->clearAll();
+      scanJobPreview = true;
+    }
+    size_t rows = scanModel->rowCount();
+    if (rows < SCAN_ADDRESS_VISIBLE_SIZE) {
+      found.resize(min(found.size(), (size_t)SCAN_ADDRESS_VISIBLE_SIZE - rows));
+      MemList preview(found);
+      scanModel->appendScans(preview, scanJobType);
+    }
+    scanUpdateMutex->unlock();
+  }
+  ScanProgress& progress = scanJob->getProgress();
+  scanProgressBar->setValue((int)(progress.getFraction() * scanProgressBar->maximum()));
+
+  double eta = progress.getEtaSeconds();
+  QString message = QString("Scanned %1 MB, skipped %2 pages, %3 found, ETA %4")
+    .arg(progress.getBytesScanned() / (1024 * 1024))
+    .arg(progress.getPagesSkipped())
+    .arg(progress.getHits())
+    .arg(eta < 0 ? QString("-") : QString("%1s").arg((int)eta));
+  statusBar->showMessage(message);
+}
+
+void MedUi::onScanJobFinished() {
+  if (!scanJob) return;
+
+  scanTimer->stop();
+  ScanJobPtr job = scanJob;
+  scanJob = NULL;
+  job->wait();
+  setScanControlsEnabled(true);
+  scanUpdateMutex->lock();
+  if (scanJobPreview) {
+    scanModel->clearAll();
+    scanJobPreview = false;
+  }
+  scanUpdateMutex->unlock();
+
+  if (job->getStatus() == ScanJobStatus::Failed) {
+    statusBar->showMessage(job->getError().c_str());
+    cerr << "scan: " << job->getError() << endl;
+    return;
   }
 
   if(med->getScans().size() <= SCAN_ADDRESS_VISIBLE_SIZE) {
-    scanModel->addScan(scanType);
+    scanUpdateMutex->lock();
+    scanModel->addScan(scanJobType);
+    scanUpdateMutex->unlock();
   }
 
   updateNumberOfAddresses();
+  // The watch keeps the writers found until it is cancelled
+  if (scanJobValue == WATCH_JOB_VALUE) {
+    showWatchHits();
+  }
+  else if (job->getStatus() == ScanJobStatus::Cancelled) {
+    statusBar->showMessage("Scan cancelled, showing the results found so far");
+  }
+  else if (QString(scanJobValue.c_str()).trimmed() == "?") {
+    statusBar->showMessage("Snapshot saved");
+  }
+  else if (scanJobValue == SAMPLE_JOB_VALUE) {
+    QString message = QString("Sampled %1 times, filter by the change count, like \"#>= 20\" or \"#= 0\"")
+      .arg(med->getSampler().getSamples());
+    statusBar->showMessage(message);
+  }
+  else {
+    statusBar->showMessage(med->getMetrics().getSummary().c_str());
+  }
   if (!med->getIsProcessPaused() && med->getCanResumeProcess()) {
     med->resumeProcess();
   }
 }
 
+void MedUi::showWatchHits() {
+  auto& hits = med->getWatchHits();
+  statusBar->showMessage(QString("%1 instructions write the address").arg(hits.size()));
+  if (hits.empty()) return;
+
+  // The address is after the writing instruction
+  QString text;
+  for (size_t i = 0; i < hits.size() && i < WATCH_HITS_VISIBLE; i++) {
+    text += QString("%1\t%2\n").arg(hits[i].count).arg(QString::fromStdString(hits[i].toString()));
+  }
+  QMessageBox::information(mainWindow, "Find What Writes", text);
+}
+
+void MedUi::onCancelClicked() {
+  if (scanJob) {
+    scanJob->cancel();
+  }
+}
+
+void MedUi::setScanControlsEnabled(bool enabled) {
+  mainWindow->findChild<QWidget*>("scanButton")->setEnabled(enabled);
+  mainWindow->findChild<QWidget*>("filterButton")->setEnabled(enabled);
+  scanTreeView->setEnabled(enabled);
+  // The job reads the scan list and the process, they cannot be switched while it runs
+  for (auto name : {"process", "scanClear", "scopeStart", "scopeEnd", "scanRanges",
+                    "namedScans", "namedScan_add", "namedScan_delete"}) {
+    mainWindow->findChild<QWidget*>(name)->setEnabled(enabled);
+  }
+  mainWindow->findChild<QAction*>("actionOpenDump")->setEnabled(enabled);
+  scanProgressBar->setValue(0);
+  scanProgressBar->setVisible(!enabled);
+  cancelButton->setVisible(!enabled);
+}
+
 void MedUi::onPauseCheckboxClicked(bool checked) {
   if (checked) {
     med->pauseProcess();
@@ -487,7 +683,13 @@ void MedUi::onScanAddAllClicked() {
 
 void MedUi::onScanClearClicked() {
   scanUpdateMutex->lock();
-  scanModel->empty();
+  try {
+    scanModel->empty();
+  } catch (MedException &ex) {
+    scanUpdateMutex->unlock();
+    statusBar->showMessage(ex.what());
+    return;
+  }
   scanUpdateMutex->unlock();
   statusBar->showMessage("Scan cleared");
 }
@@ -541,6 +743,43 @@ void MedUi::onStorePrevClicked() {
   storeUpdateMutex.unlock();
 }
 
+void MedUi::onStoreStrideClicked() {
+  auto indexes = storeTreeView->selectionModel()->selectedRows(STORE_COL_ADDRESS);
+  if (indexes.size() == 0) {
+    cerr << "onStoreStrideClicked: nothing selected" << endl;
+    return;
+  }
+
+  storeUpdateMutex.lock();
+  try {
+    StrideMatch match = med->addStrideToStore(indexes[0].row());
+    storeModel->refresh();
+    statusBar->showMessage(QString::fromStdString(
+      "Stride " + to_string(match.stride) + ", " + to_string(match.addresses.size()) + " elements"));
+  } catch (MedException &ex) {
+    statusBar->showMessage(ex.what());
+  }
+  storeUpdateMutex.unlock();
+}
+
+void MedUi::onStoreSignatureClicked() {
+  auto indexes = storeTreeView->selectionModel()->selectedRows(STORE_COL_ADDRESS);
+  if (indexes.size() == 0) {
+    cerr << "onStoreSignatureClicked: nothing selected" << endl;
+    return;
+  }
+
+  storeUpdateMutex.lock();
+  try {
+    Signature signature = med->makeSignature(indexes[0].row());
+    statusBar->showMessage(QString::fromStdString(
+      "Signature: " + signature.getPattern() + " @ " + to_string(signature.getOffset())));
+  } catch (MedException &ex) {
+    statusBar->showMessage(ex.what());
+  }
+  storeUpdateMutex.unlock();
+}
+
 
 void storeShift(MedUi* mainUi, bool reverse = false) {
   auto mainWindow = mainUi->mainWindow;
@@ -656,6 +895,27 @@ void MedUi::onOpenTriggered() {
   openFile(filename);
 }
 
+void MedUi::onOpenDumpTriggered() {
+  QString filename = QFileDialog::getOpenFileName(mainWindow,
+                                                  QString("Open dump"),
+                                                  "./",
+                                                  QString("Memory dump or core file (*)"));
+  if (filename == "") {
+    return;
+  }
+
+  try {
+    med->openDump(filename.toStdString());
+  } catch (MedException &ex) {
+    statusBar->showMessage(ex.what());
+    return;
+  }
+  scanUpdateMutex->lock();
+  scanModel->clearAll();
+  scanUpdateMutex->unlock();
+  selectedProcessLine->setText(QString::fromLatin1(("dump " + med->selectedProcess.cmdline).c_str()));
+}
+
 void MedUi::onReloadTriggered() {
   if(med->selectedProcess.pid == "") {
     statusBar->showMessage("No process selected");
@@ -719,6 +979,37 @@ void MedUi::onAutoRefreshTriggered(bool checked) {
   }
 }
 
+void MedUi::onUndoScanTriggered() {
+  moveInScanHistory(true);
+}
+
+void MedUi::onRedoScanTriggered() {
+  moveInScanHistory(false);
+}
+
+void MedUi::moveInScanHistory(bool backward) {
+  bool moved;
+  try {
+    moved = backward ? med->undoScan() : med->redoScan();
+  } catch (MedException &ex) {
+    statusBar->showMessage(ex.what());
+    return;
+  }
+  if (!moved) {
+    statusBar->showMessage(backward ? "Nothing to undo" : "Nothing to redo");
+    return;
+  }
+
+  scanUpdateMutex->lock();
+  scanModel->clearAll();
+  if (med->getScans().size() <= SCAN_ADDRESS_VISIBLE_SIZE) {
+    scanModel->addScan(med->getNamedScans().getScanType());
+  }
+  scanUpdateMutex->unlock();
+  updateNumberOfAddresses();
+  statusBar->showMessage(backward ? "Filter undone" : "Filter redone");
+}
+
 void MedUi::onFastScanTriggered(bool checked) {
   if (checked) {
     fastScan = true;
@@ -782,9 +1073,52 @@ void MedUi::onMemEditorTriggered() {
   memEditor->show();
 }
 
+void MedUi::onTimelineTriggered() {
+  auto indexes = storeTreeView->selectionModel()->selectedRows(STORE_COL_ADDRESS);
+  if (indexes.size() == 0) {
+    statusBar->showMessage("Select the stored addresses to record");
+    return;
+  }
+  vector<int> rows;
+  for (auto& index : indexes) {
+    rows.push_back(index.row());
+  }
+  sort(rows.begin(), rows.end());
+  timeline->show();
+  timeline->record(rows);
+}
+
+void MedUi::onFindWritesTriggered() {
+  if (scanJob) {
+    statusBar->showMessage("Scan is running");
+    return;
+  }
+  auto indexes = storeTreeView->selectionModel()->selectedRows(STORE_COL_ADDRESS);
+  if (indexes.size() == 0) {
+    statusBar->showMessage("Select the stored address to watch");
+    return;
+  }
+
+  storeUpdateMutex.lock();
+  MemPtr mem = med->getStore()->getMemPtr(indexes[0].row());
+  Address address = mem->getAddress();
+  size_t size = mem->getSize();
+  storeUpdateMutex.unlock();
+
+  scanJobValue = WATCH_JOB_VALUE;
+  scanJobType = med->getNamedScans().getScanType();
+  try {
+    scanJob = med->watchWritesAsync(address, size);
+  } catch (MedException &ex) {
+    statusBar->showMessage(ex.what());
+    return;
+  }
+  watchScanJob();
+}
+
 void MedUi::updateNumberOfAddresses() {
   char message[128];
-  sprintf(message, "%ld", med->getScans().size());
+  sprintf(message, "%zu", med->getScanCount());
   mainWindow->findChild<QLabel*>("found")->setText(message);
 }
 
@@ -806,6 +1140,11 @@ void MedUi::onRefreshTriggered() {
 
 void MedUi::refreshScanTreeView() {
   scanUpdateMutex->lock();
+  // The rows of the preview are not the scans
+  if (scanJobPreview) {
+    scanUpdateMutex->unlock();
+    return;
+  }
   try {
     scanModel->refreshValues();
   } catch (MedException& ex) {
@@ -844,20 +1183,27 @@ void MedUi::setStoreState(UiState state) {
 
 void MedUi::onScopeStartEdited() {
   string start = mainWindow->findChild<QLineEdit*>("scopeStart")->text().toStdString();
-  if (start.size() == 0) {
-    med->setScopeStart(0);
-  }
-  else {
-    med->setScopeStart(hexToInt(start));
+  try {
+    med->setScopeStart(start.size() == 0 ? 0 : hexToInt(start));
+  } catch (MedException &ex) {
+    statusBar->showMessage(ex.what());
   }
 }
 
 void MedUi::onScopeEndEdited() {
   string end = mainWindow->findChild<QLineEdit*>("scopeEnd")->text().toStdString();
-  if (end.size() == 0) {
-    med->setScopeEnd(0);
+  try {
+    med->setScopeEnd(end.size() == 0 ? 0 : hexToInt(end));
+  } catch (MedException &ex) {
+    statusBar->showMessage(ex.what());
   }
-  else {
-    med->setScopeEnd(hexToInt(end));
+}
+
+void MedUi::onScanRangesEdited() {
+  string ranges = mainWindow->findChild<QLineEdit*>("scanRanges")->text().toStdString();
+  try {
+    med->setScanRanges(ranges);
+  } catch (MedException &ex) {
+    statusBar->showMessage(ex.what());
   }
 }
@@ -0,0 +1,87 @@
+#include <cstring>
+#include <unistd.h>
+#include <cxxtest/TestSuite.h>
+
+#include "mem/CandidateSet.hpp"
+#include "mem/MemScanner.hpp"
+#include "mem/Pem.hpp"
+
+using namespace std;
+
+class TestCandidateSet : public CxxTest::TestSuite {
+public:
+  void testDenseToSparse() {
+    size_t pageSize = getpagesize();
+    int* memory = (int*)aligned_alloc(pageSize, pageSize);
+    memset(memory, 0, pageSize);
+    MemIO memio;
+
+    // Every aligned int of the page is a candidate
+    CandidateSet candidates;
+    candidates.reset(sizeof(int));
+    vector<uint16_t> offsets;
+    for (size_t i = 0; i < pageSize; i += sizeof(int)) {
+      offsets.push_back(i);
+    }
+    candidates.addPage((Address)memory, offsets, (Byte*)memory);
+    TS_ASSERT_EQUALS(candidates.size(), pageSize / sizeof(int));
+    TS_ASSERT_EQUALS(candidates.getDensePageCount(), 1);
+
+    memory[3] = 7;
+    memory[100] = 9;
+    ScanProgress progress;
+    size_t kept = candidates.filter(&memio, sizeof(int), progress, [](const Byte* newValue, const Byte* oldValue) {
+        return memcmp(newValue, oldValue, sizeof(int)) != 0;
+      });
+    TS_ASSERT_EQUALS(kept, 2);
+    TS_ASSERT_EQUALS(candidates.getPageCount(), 1);
+    TS_ASSERT_EQUALS(candidates.getDensePageCount(), 0);
+
+    auto list = candidates.toList(&memio, "int32");
+    TS_ASSERT_EQUALS(list.size(), 2);
+    TS_ASSERT_EQUALS(list[1]->getAddress(), (Address)&memory[100]);
+    int value;
+    memcpy(&value, static_pointer_cast<Pem>(list[1])->recallValuePtr(), sizeof(value));
+    TS_ASSERT_EQUALS(value, 9);
+    free(memory);
+  }
+
+  void testMemoryUsage() {
+    size_t pageSize = getpagesize();
+    vector<Byte> data(pageSize, 0);
+    vector<uint16_t> offsets;
+    for (size_t i = 0; i + sizeof(int) <= pageSize; i++) {
+      offsets.push_back(i);
+    }
+    CandidateSet candidates;
+    candidates.reset(sizeof(int));
+    for (Address page = 0; page < 64; page++) {
+      candidates.addPage(page * pageSize, offsets, data.data());
+    }
+    // The bitmap and the copy of the page, instead of a Pem for each candidate
+    TS_ASSERT_LESS_THAN(candidates.getMemoryUsage(), candidates.size() * 2);
+  }
+
+  void testScannerKeepsCandidates() {
+    MemScanner scanner;
+    size_t pageSize = getpagesize();
+    size_t pages = CANDIDATE_LIST_MAX * sizeof(int) / pageSize + 8;
+    int* memory = (int*)aligned_alloc(pageSize, pageSize * pages);
+    memset(memory, 0, pageSize * pages);
+    scanner.setScopeStart((Address)memory);
+    scanner.setScopeEnd((Address)memory + pageSize * pages);
+
+    vector<MemPtr> empty;
+    scanner.saveSnapshot(empty);
+    auto list = scanner.filterUnknown(empty, "int32", ScanParser::OpType::Eq, true);
+    TS_ASSERT_EQUALS(list.size(), CANDIDATE_LIST_MAX);
+    TS_ASSERT_EQUALS(scanner.getCandidateCount(), pages * pageSize / sizeof(int));
+
+    memory[pageSize / sizeof(int) * (pages - 1)] = 5;
+    list = scanner.filterUnknown(list, "int32", ScanParser::OpType::Gt);
+    TS_ASSERT_EQUALS(list.size(), 1);
+    TS_ASSERT_EQUALS(list[0]->getAddress(), (Address)&memory[pageSize / sizeof(int) * (pages - 1)]);
+    TS_ASSERT_EQUALS(scanner.getCandidateCount(), 0);
+    free(memory);
+  }
+};
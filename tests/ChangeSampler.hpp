@@ -0,0 +1,57 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cxxtest/TestSuite.h>
+
+#include "mem/ChangeSampler.hpp"
+#include "mem/Pem.hpp"
+#include "med/MedException.hpp"
+
+using namespace std;
+
+class TestChangeSampler : public CxxTest::TestSuite {
+public:
+  void testSample() {
+    static int memory[] = { 7, 0, 9 };
+    MemIO memio;
+    vector<MemPtr> mems;
+    for (int i = 0; i < 3; i++) {
+      PemPtr pem = PemPtr(new Pem((Address)&memory[i], sizeof(int), &memio));
+      pem->setScanType("int32");
+      mems.push_back(pem);
+    }
+    MemList list(mems);
+
+    // The middle value changes every millisecond, the others never
+    std::atomic<bool> running(true);
+    std::thread writer([&running]() {
+        while (running) {
+          __atomic_add_fetch(&memory[1], 1, __ATOMIC_RELAXED);
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+      });
+    ChangeSampler sampler;
+    sampler.reset(list, "int32");
+    ScanProgress progress;
+    sampler.sample(&memio, 0.2, 50, progress);
+    running = false;
+    writer.join();
+
+    TS_ASSERT_EQUALS(sampler.getSamples(), 10);
+    TS_ASSERT_EQUALS(sampler.getChanges(0), 0);
+    TS_ASSERT_LESS_THAN(5, sampler.getChanges(1));
+    TS_ASSERT_EQUALS(sampler.getMin(2), "9");
+    TS_ASSERT_EQUALS(sampler.getMax(2), "9");
+    TS_ASSERT_LESS_THAN(stoi(sampler.getMin(1)), stoi(sampler.getMax(1)));
+
+    auto constant = sampler.filter("#= 0");
+    TS_ASSERT_EQUALS(constant.size(), 2);
+    TS_ASSERT_EQUALS(constant[1]->getAddress(), (Address)&memory[2]);
+    auto changing = sampler.filter("#>= 5");
+    TS_ASSERT_EQUALS(changing.size(), 1);
+    TS_ASSERT_EQUALS(changing[0]->getAddress(), (Address)&memory[1]);
+    TS_ASSERT_EQUALS(sampler.filter("#<> 1 3").size(), 0);
+    TS_ASSERT_THROWS(sampler.filter("#>="), MedException);
+    TS_ASSERT_THROWS(sampler.filter("#~ 5"), MedException);
+  }
+};
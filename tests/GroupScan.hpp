@@ -0,0 +1,45 @@
+#include <cstring>
+#include <cxxtest/TestSuite.h>
+
+#include "med/GroupScan.hpp"
+#include "med/MedException.hpp"
+
+using namespace std;
+
+class TestGroupScan : public CxxTest::TestSuite {
+public:
+  void testParse() {
+    GroupScan group("100, int16:50, float32:1.5, span:32");
+    TS_ASSERT_EQUALS(group.getMembers().size(), 3);
+    TS_ASSERT_EQUALS(group.getSpan(), 32);
+    TS_ASSERT_EQUALS(group.getAnchorType(), "int32");
+    TS_ASSERT_EQUALS(group.getMembers()[1].value.size(), 2);
+
+    TS_ASSERT_THROWS(GroupScan("span:16"), MedException);
+    TS_ASSERT_THROWS(GroupScan("string:abc"), MedException);
+  }
+
+  void testScan() {
+    alignas(8) Byte buf[256] = { 0 };
+    int32_t hp = 100, maxHp = 100;
+    int16_t level = 7;
+    memcpy(buf + 64, &hp, 4);     // Anchor with both members
+    memcpy(buf + 72, &maxHp, 4);
+    memcpy(buf + 58, &level, 2);
+    memcpy(buf + 200, &hp, 4);    // Anchor without the other members nearby
+
+    GroupScan group("100, 100, int16:7, span:16");
+    vector<GroupMatch> matches;
+    group.scan(buf, sizeof(buf), 0x1000, 0x1000, 0x1100, matches);
+
+    // 100 at 64 pairs with 100 at 72 and the level at 58, and the reverse
+    TS_ASSERT_EQUALS(matches.size(), 2);
+    TS_ASSERT_EQUALS(matches[0].anchor, 0x1000 + 64);
+    TS_ASSERT(matches[0].offsets == vector<long>({ 0, 8, -6 }));
+    TS_ASSERT_EQUALS(matches[1].anchor, 0x1000 + 72);
+
+    matches.clear();
+    group.scan(buf, sizeof(buf), 0x1000, 0x1000, 0x1000 + 70, matches);
+    TS_ASSERT_EQUALS(matches.size(), 1);
+  }
+};
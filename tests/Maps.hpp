@@ -0,0 +1,27 @@
+#include <cxxtest/TestSuite.h>
+
+#include "mem/Maps.hpp"
+
+using namespace std;
+
+class TestMaps : public CxxTest::TestSuite {
+public:
+  void testIsAnonymous() {
+    Maps maps;
+    maps.push(AddressPair(0x1000, 0x2000));
+    maps.push(AddressPair(0x2000, 0x3000), "[heap]");
+    maps.push(AddressPair(0x3000, 0x4000), "[stack]");
+    maps.push(AddressPair(0x4000, 0x5000), "[anon:scudo]");
+    maps.push(AddressPair(0x5000, 0x6000), "/usr/lib/libc.so.6");
+    maps.push(AddressPair(0x6000, 0x7000), "[vvar]");
+
+    TS_ASSERT_EQUALS(maps.size(), 6);
+    TS_ASSERT(maps.isAnonymous(0));
+    TS_ASSERT(maps.isAnonymous(1));
+    TS_ASSERT(maps.isAnonymous(2));
+    TS_ASSERT(maps.isAnonymous(3));
+    TS_ASSERT(!maps.isAnonymous(4));
+    TS_ASSERT(!maps.isAnonymous(5));
+    TS_ASSERT_EQUALS(maps.getName(4), "/usr/lib/libc.so.6");
+  }
+};
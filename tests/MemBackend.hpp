@@ -0,0 +1,76 @@
+#include <cstring>
+#include <unistd.h>
+#include <cxxtest/TestSuite.h>
+
+#include "mem/MemBackend.hpp"
+#include "mem/MemIO.hpp"
+#include "med/MedException.hpp"
+
+using namespace std;
+
+class TestMemBackend : public CxxTest::TestSuite {
+public:
+  // Read and write the memory of this process, which is allowed without ptrace
+  void checkBackend(MemBackend& backend) {
+    int memory[] = { 100, 200, 300 };
+    int value = 0;
+    TS_ASSERT(backend.read((Address)&memory[1], (Byte*)&value, sizeof(value)));
+    TS_ASSERT_EQUALS(value, 200);
+
+    value = 250;
+    TS_ASSERT(backend.write((Address)&memory[2], (Byte*)&value, sizeof(value)));
+    TS_ASSERT_EQUALS(memory[2], 250);
+  }
+
+  void testSelf() {
+    SelfBackend backend;
+    TS_ASSERT_EQUALS(backend.getName(), MEM_BACKEND_SELF);
+    checkBackend(backend);
+  }
+
+  void testProcMem() {
+    ProcMemBackend backend(getpid());
+    TS_ASSERT_EQUALS(backend.getName(), MEM_BACKEND_PROC_MEM);
+    checkBackend(backend);
+  }
+
+  void testVm() {
+    VmBackend backend(getpid());
+    checkBackend(backend);
+
+    // The request which fails does not stop the rest of the batch
+    int memory[] = { 1, 2 };
+    int values[3] = { 0 };
+    vector<MemRequest> requests = {
+      { (Address)&memory[0], (Byte*)&values[0], sizeof(int), false },
+      { 0x8, (Byte*)&values[1], sizeof(int), false },
+      { (Address)&memory[1], (Byte*)&values[2], sizeof(int), false }
+    };
+    TS_ASSERT_EQUALS(backend.readBatch(requests), 2);
+    TS_ASSERT(requests[0].success);
+    TS_ASSERT(!requests[1].success);
+    TS_ASSERT(requests[2].success);
+    TS_ASSERT_EQUALS(values[0], 1);
+    TS_ASSERT_EQUALS(values[2], 2);
+  }
+
+  void testCreate() {
+    TS_ASSERT_EQUALS(MemBackend::probe(0)->getName(), MEM_BACKEND_SELF);
+    TS_ASSERT_EQUALS(MemBackend::create(MEM_BACKEND_VM, getpid())->getName(), MEM_BACKEND_VM);
+    TS_ASSERT_THROWS(MemBackend::create(MEM_BACKEND_VM, 0), MedException);
+    TS_ASSERT_THROWS(MemBackend::create("unknown", getpid()), MedException);
+
+    MemIO memio;
+    TS_ASSERT_EQUALS(memio.getBackend()->getName(), MEM_BACKEND_SELF);
+    memio.setPid(getpid());
+    TS_ASSERT_DIFFERS(memio.getBackend()->getName(), MEM_BACKEND_SELF);
+    memio.setBackend(MEM_BACKEND_PROC_MEM);
+    TS_ASSERT_EQUALS(memio.getBackend()->getName(), MEM_BACKEND_PROC_MEM);
+
+    int memory = 42;
+    MemPtr mem = memio.read((Address)&memory, sizeof(memory));
+    int value;
+    memcpy(&value, mem->getData(), sizeof(value));
+    TS_ASSERT_EQUALS(value, 42);
+  }
+};
@@ -0,0 +1,117 @@
+#include <cstdio>
+#include <cstring>
+#include <elf.h>
+#include <fstream>
+#include <unistd.h>
+#include <cxxtest/TestSuite.h>
+
+#include "mem/MemDump.hpp"
+#include "mem/MemIO.hpp"
+#include "mem/MemScanner.hpp"
+#include "med/MedException.hpp"
+#include "med/Operands.hpp"
+
+using namespace std;
+
+class TestMemDump : public CxxTest::TestSuite {
+public:
+  void testSaveAndScan() {
+    static int memory[1024] = { 0 };
+    memory[10] = 12345;
+    memory[900] = 12345;
+    Address start = (Address)memory;
+
+    MemIO memio;
+    Maps maps;
+    maps.push(AddressPair(start, start + sizeof(memory)), "[heap]");
+    string filename = "/tmp/med-test-dump-" + to_string(getpid());
+    MemDump::save(&memio, maps, filename);
+
+    MemScanner scanner;
+    scanner.openDump(filename);
+    memory[10] = 0; // The dump is not changed by the process
+    TS_ASSERT_EQUALS(scanner.getMemIO()->getMaps().size(), 1);
+    TS_ASSERT_EQUALS(scanner.getMemIO()->getMaps().getName(0), "[heap]");
+
+    auto buffer = ScanParser::valueToBytes("12345", "int32");
+    Operands operands(std::vector<SizedBytes>{ buffer });
+    auto list = scanner.scan(operands, 4, "int32", ScanParser::OpType::Eq);
+    TS_ASSERT_EQUALS(list.size(), 2);
+    TS_ASSERT_EQUALS(list[0]->getAddress(), (Address)&memory[10]);
+
+    // Write changes the dump, not the process
+    MemPtr mem = scanner.getMemIO()->read((Address)&memory[900], 4);
+    int changed = 7;
+    memcpy(mem->getData(), &changed, sizeof(changed));
+    scanner.getMemIO()->write((Address)&memory[900], mem);
+    TS_ASSERT_EQUALS(memory[900], 12345);
+    int value;
+    memcpy(&value, scanner.getMemIO()->read((Address)&memory[900], 4)->getData(), 4);
+    TS_ASSERT_EQUALS(value, 7);
+
+    TS_ASSERT_THROWS(scanner.getMemIO()->read(start + sizeof(memory), 4), MedException);
+    remove(filename.c_str());
+  }
+
+  void testCore() {
+    const Address segmentStart = 0x10000;
+    const size_t segmentSize = 0x1000;
+    const char* path = "/usr/bin/game";
+
+    // NT_FILE: count, page size, (start, end, offset) per file, then the names
+    vector<uint64_t> files = { 1, 0x1000, segmentStart, segmentStart + segmentSize, 0 };
+    size_t descSize = files.size() * sizeof(uint64_t) + strlen(path) + 1;
+    size_t noteSize = sizeof(Elf64_Nhdr) + 8 + (descSize + 3) / 4 * 4;
+
+    size_t noteOffset = sizeof(Elf64_Ehdr) + 2 * sizeof(Elf64_Phdr);
+    size_t loadOffset = (noteOffset + noteSize + 0xfff) / 0x1000 * 0x1000;
+    vector<Byte> core(loadOffset + segmentSize, 0);
+
+    Elf64_Ehdr* header = (Elf64_Ehdr*)core.data();
+    memcpy(header->e_ident, ELFMAG, SELFMAG);
+    header->e_ident[EI_CLASS] = ELFCLASS64;
+    header->e_type = ET_CORE;
+    header->e_phoff = sizeof(Elf64_Ehdr);
+    header->e_phnum = 2;
+
+    Elf64_Phdr* segments = (Elf64_Phdr*)(core.data() + header->e_phoff);
+    segments[0].p_type = PT_NOTE;
+    segments[0].p_offset = noteOffset;
+    segments[0].p_filesz = noteSize;
+    segments[1].p_type = PT_LOAD;
+    segments[1].p_flags = PF_R | PF_W;
+    segments[1].p_offset = loadOffset;
+    segments[1].p_vaddr = segmentStart;
+    segments[1].p_filesz = segmentSize;
+    segments[1].p_memsz = segmentSize;
+
+    Elf64_Nhdr* note = (Elf64_Nhdr*)(core.data() + noteOffset);
+    note->n_namesz = 5;
+    note->n_descsz = descSize;
+    note->n_type = NT_FILE;
+    Byte* desc = core.data() + noteOffset + sizeof(Elf64_Nhdr);
+    memcpy(desc, "CORE", 5);
+    desc += 8;
+    memcpy(desc, files.data(), files.size() * sizeof(uint64_t));
+    strcpy((char*)desc + files.size() * sizeof(uint64_t), path);
+
+    int value = 4321;
+    memcpy(core.data() + loadOffset + 0x40, &value, sizeof(value));
+
+    string filename = "/tmp/med-test-core-" + to_string(getpid());
+    ofstream ofs(filename, ios::binary);
+    ofs.write((const char*)core.data(), core.size());
+    ofs.close();
+
+    MemDump dump(filename);
+    TS_ASSERT_EQUALS(dump.getMaps().size(), 1);
+    TS_ASSERT_EQUALS(dump.getMaps().getName(0), path);
+    int read = 0;
+    TS_ASSERT(dump.read(segmentStart + 0x40, (Byte*)&read, sizeof(read)));
+    TS_ASSERT_EQUALS(read, 4321);
+    TS_ASSERT(!dump.read(segmentStart + segmentSize - 2, (Byte*)&read, sizeof(read)));
+    remove(filename.c_str());
+
+    TS_ASSERT_THROWS(MemDump missing(filename), MedException);
+  }
+};
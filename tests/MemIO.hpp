@@ -1,7 +1,12 @@
 #include <string>
 #include <cstdio>
+#include <csignal>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
 #include <cxxtest/TestSuite.h>
 
+#include "med/MedException.hpp"
 #include "mem/MemIO.hpp"
 #include "mem/Mem.hpp"
 
@@ -28,4 +33,27 @@ public:
     TS_ASSERT_EQUALS(ptr1[1], 0x68);
     TS_ASSERT_EQUALS(ptr1[2], 0x66);
   }
+
+  void testWriteReadOnly() {
+    // The read-only page of the child is written by ptrace, when the probed backend cannot
+    Byte* page = (Byte*)mmap(NULL, getpagesize(), PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    pid_t child = fork();
+    if (child == 0) {
+      pause();
+      _exit(0);
+    }
+    MemIO memIO;
+    memIO.setPid(child);
+    MemPtr mem = memIO.read((Address)page, 4);
+    mem->setValue(0x12345678);
+    memIO.write((Address)page, mem);
+    uint32_t value = 0;
+    TS_ASSERT(memIO.read((Address)page, (Byte*)&value, sizeof(value)));
+    TS_ASSERT_EQUALS(value, 0x12345678);
+    TS_ASSERT_THROWS(memIO.write(0, mem), MedException);
+
+    kill(child, SIGKILL);
+    waitpid(child, NULL, 0);
+    munmap(page, getpagesize());
+  }
 };
@@ -0,0 +1,73 @@
+#include <cxxtest/TestSuite.h>
+
+#include "mem/MemList.hpp"
+#include "mem/NamedScans.hpp"
+
+using namespace std;
+
+class TestMemList : public CxxTest::TestSuite {
+public:
+  MemList makeList(const vector<Address>& addresses) {
+    vector<MemPtr> list;
+    for (auto addr : addresses) {
+      MemPtr mem = MemPtr(new Mem(4));
+      mem->setAddress(addr);
+      list.push_back(mem);
+    }
+    return MemList(list);
+  }
+
+  vector<Address> addressesOf(MemList& list) {
+    vector<Address> addresses;
+    for (size_t i = 0; i < list.size(); i++) {
+      addresses.push_back(list.getAddress(i));
+    }
+    return addresses;
+  }
+
+  void testCopyOnWrite() {
+    MemList list = makeList({ 0x10, 0x20 });
+    MemList copy = list;
+    TS_ASSERT_EQUALS(&copy.getList(), &list.getList());
+
+    copy.deleteAddress(0);
+    TS_ASSERT_EQUALS(copy.size(), 1);
+    TS_ASSERT_EQUALS(list.size(), 2);
+
+    // The elements are still shared
+    TS_ASSERT_EQUALS(copy.getMemPtr(0), list.getMemPtr(1));
+  }
+
+  void testSetOperations() {
+    MemList walking = makeList({ 0x30, 0x10, 0x20, 0x40 });
+    MemList standing = makeList({ 0x20, 0x50, 0x40 });
+
+    MemList both = MemList::intersect(walking, standing);
+    TS_ASSERT(addressesOf(both) == vector<Address>({ 0x20, 0x40 }));
+    TS_ASSERT_EQUALS(both.getMemPtr(0), walking.getMemPtr(2));
+
+    MemList any = MemList::unite(walking, standing);
+    TS_ASSERT(addressesOf(any) == vector<Address>({ 0x10, 0x20, 0x30, 0x40, 0x50 }));
+
+    MemList moving = MemList::subtract(walking, standing);
+    TS_ASSERT(addressesOf(moving) == vector<Address>({ 0x10, 0x30 }));
+
+    // The operands are not changed
+    TS_ASSERT_EQUALS(walking.getAddress(0), 0x30);
+  }
+
+  void testCombinedScan() {
+    NamedScans namedScans;
+    namedScans.addNewScan("walk");
+    namedScans.addNewScan("stand");
+    namedScans.getMemList("walk")->setList(makeList({ 0x10, 0x20 }).getList());
+    namedScans.getMemList("stand")->setList(makeList({ 0x20 }).getList());
+
+    TS_ASSERT(NamedScans::isCombinedScan("walk - stand"));
+    TS_ASSERT(!NamedScans::isCombinedScan("walk-stand"));
+    MemList* moving = namedScans.addCombinedScan("walk - stand");
+    TS_ASSERT(moving);
+    TS_ASSERT(addressesOf(*moving) == vector<Address>({ 0x10 }));
+    TS_ASSERT(!namedScans.addCombinedScan("walk & run"));
+  }
+};
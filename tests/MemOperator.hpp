@@ -60,6 +60,83 @@ public:
                                 ScanParser::Within), false);
   }
 
+  void testMemApprox() {
+    float f = 100.49999f;
+    double d = 100.54;
+    TS_ASSERT_EQUALS(memApprox(&f, sizeof(f), 100.45, 100.55), true);
+    TS_ASSERT_EQUALS(memApprox(&d, sizeof(d), 100.45, 100.55), true);
+    d = 100.56;
+    TS_ASSERT_EQUALS(memApprox(&d, sizeof(d), 100.45, 100.55), false);
+  }
+
+  void testMemApproxScan() {
+    float values[] = { 1.0f, 100.5f, 3.0f, 100.46f, 100.56f };
+    vector<size_t> offsets;
+    memApproxScan((Byte*)values, sizeof(values), sizeof(float), sizeof(float), 100.45, 100.55, offsets);
+    TS_ASSERT_EQUALS(offsets.size(), 2);
+    TS_ASSERT_EQUALS(offsets[0], 4);
+    TS_ASSERT_EQUALS(offsets[1], 12);
+  }
+
+  void testMemGatherCompare() {
+    uint32_t values[] = { 7, 3, 7, 9 };
+    vector<size_t> offsets = { 0, 4, 8, 12 };
+    uint32_t seven = 7;
+    Operands operands(std::vector<SizedBytes>{ SizedBytes((Byte*)&seven, 4) });
+    vector<uint8_t> matched;
+
+    TS_ASSERT(memGatherCompare((Byte*)values, offsets, 4, operands, ScanParser::Eq, matched));
+    TS_ASSERT(matched == vector<uint8_t>({ 1, 0, 1, 0 }));
+    TS_ASSERT(memGatherCompare((Byte*)values, offsets, 4, operands, ScanParser::Neq, matched));
+    TS_ASSERT(matched == vector<uint8_t>({ 0, 1, 0, 1 }));
+    TS_ASSERT(!memGatherCompare((Byte*)values, offsets, 4, operands, ScanParser::Gt, matched));
+  }
+
+  void testMemCompareDelta() {
+    uint16_t oldValue = 100;
+    uint16_t newValue = 125;
+    Operands operands = Operands::fromInterval(25, 25);
+    TS_ASSERT_EQUALS(memCompareDelta(&newValue, &oldValue, Int16, operands, ScanParser::IncreasedBy), true);
+    TS_ASSERT_EQUALS(memCompareDelta(&newValue, &oldValue, Int16, operands, ScanParser::DecreasedBy), false);
+    TS_ASSERT_EQUALS(memCompareDelta(&oldValue, &newValue, Int16, operands, ScanParser::DecreasedBy), true);
+
+    operands = Operands::fromInterval(10, 30);
+    TS_ASSERT_EQUALS(memCompareDelta(&newValue, &oldValue, Int16, operands, ScanParser::ChangedByPercent), true);
+    newValue = 80;
+    TS_ASSERT_EQUALS(memCompareDelta(&newValue, &oldValue, Int16, operands, ScanParser::ChangedByPercent), true);
+    newValue = 50;
+    TS_ASSERT_EQUALS(memCompareDelta(&newValue, &oldValue, Int16, operands, ScanParser::ChangedByPercent), false);
+
+    double oldFloat = 1.5;
+    double newFloat = 1.0;
+    operands = Operands::fromInterval(0.5, 0.5);
+    TS_ASSERT_EQUALS(memCompareDelta(&newFloat, &oldFloat, Float64, operands, ScanParser::DecreasedBy), true);
+  }
+
+  void testMemCompareDeltaSigned() {
+    int32_t oldValue = -5;
+    int32_t newValue = 20;
+    Operands operands = Operands::fromInterval(25, 25);
+    TS_ASSERT_EQUALS(memCompareDelta(&newValue, &oldValue, Int32, operands, ScanParser::IncreasedBy), true);
+    TS_ASSERT_EQUALS(memCompareDelta(&oldValue, &newValue, Int32, operands, ScanParser::DecreasedBy), true);
+
+    int8_t oldByte = 3;
+    int8_t newByte = -2;
+    operands = Operands::fromInterval(5, 5);
+    TS_ASSERT_EQUALS(memCompareDelta(&newByte, &oldByte, Int8, operands, ScanParser::DecreasedBy), true);
+
+    // Percent of the magnitude of the old value
+    oldValue = -20;
+    newValue = -18;
+    operands = Operands::fromInterval(10, 10);
+    TS_ASSERT_EQUALS(memCompareDelta(&newValue, &oldValue, Int32, operands, ScanParser::ChangedByPercent), true);
+
+    int64_t oldLong = INT64_MIN;
+    int64_t newLong = INT64_MIN + 7;
+    operands = Operands::fromInterval(7, 7);
+    TS_ASSERT_EQUALS(memCompareDelta(&newLong, &oldLong, Ptr64, operands, ScanParser::IncreasedBy), true);
+  }
+
   void testAddressRoundDown() {
     Address addr = 0x11112222;
     Address rounded = addressRoundDown(addr);
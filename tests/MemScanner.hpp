@@ -1,9 +1,17 @@
+#include <algorithm>
 #include <string>
 #include <cstdio>
 #include <iostream>
+#include <cstdlib>
+#include <csignal>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
 #include <cxxtest/TestSuite.h>
 
 #include "mem/MemScanner.hpp"
+#include "mem/PageMap.hpp"
+#include "mem/Pem.hpp"
 #include "med/Operands.hpp"
 
 using namespace std;
@@ -94,6 +102,327 @@ public:
     TS_ASSERT_EQUALS(list[0]->getAddress(), (Address)(&memory[2]));
   }
 
+  void testScanApprox() {
+    MemScanner scanner;
+    float memory[] = {100.49999f, 200.0f, 100.5f};
+
+    Operands operands = ScanParser::valueToOperands("~ 100.5", "float32", ScanParser::Approx);
+    size_t size = ScanParser::getValueSize(operands, "float32", ScanParser::Approx);
+
+    auto list = scanner.scanInner(operands, size, (Address)memory, 4 * 3, "float32", ScanParser::Approx);
+
+    TS_ASSERT_EQUALS(list.size(), 2);
+    TS_ASSERT_EQUALS(list[1]->getAddress(), (Address)&memory[2]);
+  }
+
+  void testFilterDelta() {
+    MemScanner scanner;
+    int memory[] = {100, 200, 100};
+
+    auto buffer = ScanParser::valueToBytes("100", "int32");
+    size_t size = buffer.getSize();
+    Operands operands(std::vector<SizedBytes>{ buffer });
+
+    auto list = scanner.scanInner(operands, size, (Address)memory, 4 * 3, "int32", ScanParser::OpType::Eq);
+
+    memory[0] = 125;
+    memory[2] = 110;
+    Operands delta = ScanParser::valueToOperands("+= 25", "int32", ScanParser::IncreasedBy);
+    auto filtered = scanner.filterUnknownInner(list, delta, "int32", ScanParser::IncreasedBy);
+    TS_ASSERT_EQUALS(filtered.size(), 1);
+    TS_ASSERT_EQUALS(filtered[0]->getAddress(), (Address)memory);
+
+    delta = ScanParser::valueToOperands("%= 5 10", "int32", ScanParser::ChangedByPercent);
+    filtered = scanner.filterUnknown(list, delta, "int32", ScanParser::ChangedByPercent);
+    TS_ASSERT_EQUALS(filtered.size(), 1);
+    TS_ASSERT_EQUALS(filtered[0]->getAddress(), (Address)&memory[2]);
+  }
+
+  void testScanScope() {
+    alignas(4096) static int memory[2048];
+    memory[10] = 0x5ca1ab1e;
+    memory[1500] = 0x5ca1ab1e;
+
+    MemScanner scanner;
+    scanner.setScopeStart((Address)&memory[8]);
+    scanner.setScopeEnd((Address)&memory[2000]);
+    auto buffer = ScanParser::valueToBytes(to_string(0x5ca1ab1e), "int32");
+    Operands operands(std::vector<SizedBytes>{ buffer });
+
+    auto list = scanner.scan(operands, 4, "int32", ScanParser::OpType::Eq, true);
+    TS_ASSERT_EQUALS(list.size(), 2);
+    TS_ASSERT_EQUALS(list[0]->getAddress(), (Address)&memory[10]);
+    TS_ASSERT_EQUALS(list[1]->getAddress(), (Address)&memory[1500]);
+  }
+
+  void testScanPipeline() {
+    // More blocks than the buffers of the pipeline, so that the readers wait for the workers
+    const size_t count = 2 * 1024 * 1024;
+    alignas(4096) static int memory[count];
+    vector<size_t> indexes = { 0, 1023, 1024, 300000, count / 2, count - 1 };
+    for (auto i : indexes) {
+      memory[i] = 0x9195;
+    }
+
+    MemScanner scanner;
+    scanner.setScopeStart((Address)&memory[0]);
+    scanner.setScopeEnd((Address)&memory[count]);
+    auto buffer = ScanParser::valueToBytes(to_string(0x9195), "int32");
+    Operands operands(std::vector<SizedBytes>{ buffer });
+
+    auto list = scanner.scan(operands, 4, "int32", ScanParser::OpType::Eq, true);
+    TS_ASSERT_EQUALS(list.size(), indexes.size());
+    for (size_t i = 0; i < list.size() && i < indexes.size(); i++) {
+      TS_ASSERT_EQUALS(list[i]->getAddress(), (Address)&memory[indexes[i]]);
+    }
+    TS_ASSERT_EQUALS(scanner.getProgress().getBytesScanned(), sizeof(memory));
+  }
+
+  void testScanSet() {
+    MemScanner scanner;
+    int memory[] = {100, 200, 300, 400};
+
+    Operands operands = ScanParser::valueToOperands("in {300, 100, 500}", "int32", ScanParser::OpType::In);
+    auto list = scanner.scanInner(operands, 4, (Address)memory, 4 * 4, "int32", ScanParser::OpType::In);
+    TS_ASSERT_EQUALS(list.size(), 2);
+
+    memory[2] = 500;
+    memory[0] = 50;
+    list = scanner.filter(list, operands, 4, "int32", ScanParser::OpType::In);
+    TS_ASSERT_EQUALS(list.size(), 1);
+    TS_ASSERT_EQUALS(list[0]->getAddress(), (Address)&memory[2]);
+  }
+
+  void testScanGroup() {
+    alignas(4096) static int memory[1024];
+    memory[100] = 0x7e57;
+    memory[103] = 0x1e7e1;
+    memory[500] = 0x7e57;
+
+    MemScanner scanner;
+    scanner.setScopeStart((Address)&memory[0]);
+    scanner.setScopeEnd((Address)&memory[1024]);
+    GroupScan group(to_string(0x7e57) + ", " + to_string(0x1e7e1) + ", span:32");
+    auto matches = scanner.scanGroup(group);
+
+    TS_ASSERT_EQUALS(matches.size(), 1);
+    TS_ASSERT_EQUALS(matches[0].anchor, (Address)&memory[100]);
+    TS_ASSERT_EQUALS(matches[0].offsets[1], 12);
+  }
+
+  void testScanGroupUnreadablePage() {
+    // The map of the child is 3 pages over a file of 1 page, the pages after the end cannot be read
+    size_t pageSize = getpagesize();
+    char filename[] = "/tmp/med-group-XXXXXX";
+    int fd = mkstemp(filename);
+    TS_ASSERT_EQUALS(ftruncate(fd, pageSize), 0);
+    int* memory = (int*)mmap(NULL, pageSize * 3, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    unlink(filename);
+    memory[100] = 0x7e57;
+    memory[103] = 0x1e7e1;
+    pid_t child = fork();
+    if (child == 0) {
+      pause();
+      _exit(0);
+    }
+
+    MemScanner scanner(child);
+    scanner.setScopeStart((Address)memory);
+    scanner.setScopeEnd((Address)memory + pageSize * 3);
+    GroupScan group(to_string(0x7e57) + ", " + to_string(0x1e7e1) + ", span:32");
+    auto matches = scanner.scanGroup(group);
+    kill(child, SIGKILL);
+    waitpid(child, NULL, 0);
+    munmap(memory, pageSize * 3);
+
+    TS_ASSERT_EQUALS(matches.size(), 1);
+    TS_ASSERT_EQUALS(matches[0].anchor, (Address)&memory[100]);
+    TS_ASSERT_EQUALS(scanner.getProgress().getPagesSkipped(), 2);
+  }
+
+  void testDetectStride() {
+    alignas(4096) static int memory[1024];
+    for (int i = 0; i < 20; i++) {
+      memory[i * 6] = 0x600d;       // Type id
+      memory[i * 6 + 1] = 100 + i;  // HP
+      memory[i * 6 + 2] = 0x7e57;
+    }
+
+    MemScanner scanner;
+    StrideDetector detector("int32", 64);
+    auto match = scanner.detectStride(detector, (Address)&memory[6 * 5 + 1]);
+    TS_ASSERT_EQUALS(match.stride, 24);
+    TS_ASSERT_EQUALS(match.addresses.size(), 20);
+    TS_ASSERT_EQUALS(match.addresses[0], (Address)&memory[1]);
+  }
+
+  void testSignature() {
+    alignas(4096) static Byte memory[4096];
+    for (int i = 0; i < 4096; i++) {
+      memory[i] = (Byte)(i % 16); // Repeating bytes, so that the signature must grow
+    }
+    memory[2100] = 0xee;
+    int32_t hp = 500;
+    memcpy(memory + 2052, &hp, sizeof(hp));
+
+    MemScanner scanner;
+    scanner.setScopeStart((Address)&memory[0]);
+    scanner.setScopeEnd((Address)&memory[4096]);
+    Address addr = (Address)&memory[2052];
+    Signature signature = scanner.makeSignature(addr, sizeof(hp));
+    // The value is the wildcard, and the pattern grows until the unique byte
+    TS_ASSERT_DIFFERS(signature.getPattern().find("w:4"), string::npos);
+    TS_ASSERT_DIFFERS(signature.getPattern().find("ee"), string::npos);
+    TS_ASSERT_EQUALS(signature.getOffset() % 8, 4);
+    TS_ASSERT(scanner.resolveSignature(signature) == vector<Address>({ addr }));
+
+    // Value changes, and the data moves
+    memmove(memory + 16, memory + 32, 4000);
+    hp = 1;
+    memcpy(memory + 2036, &hp, sizeof(hp));
+    TS_ASSERT(scanner.resolveSignature(signature) == vector<Address>({ addr - 16 }));
+  }
+
+  void testScanPointers() {
+    alignas(4096) static Address memory[512];
+    memory[3] = (Address)&memory[100];
+    memory[100] = (Address)&memory[200] + 4;
+    memory[7] = 0x10; // Not mapped
+
+    MemScanner scanner;
+    scanner.setScopeStart((Address)&memory[0]);
+    scanner.setScopeEnd((Address)&memory[512]);
+    PointerMap pointerMap;
+    scanner.scanPointers(pointerMap, (Address)&memory[300]);
+
+    TS_ASSERT_EQUALS(pointerMap.size(), 2);
+    TS_ASSERT_EQUALS(pointerMap.getTarget(), (Address)&memory[300]);
+    Address value;
+    TS_ASSERT(pointerMap.readPointer((Address)&memory[3], value));
+    TS_ASSERT_EQUALS(value, (Address)&memory[100]);
+    TS_ASSERT(!pointerMap.readPointer((Address)&memory[7], value));
+  }
+
+  void testFilterBuckets() {
+    size_t page = getpagesize();
+    vector<Address> addresses = { 0x10000, 0x10010, 0x10000 + page, 0x10000 + page * 3, 0x10000 + page * 100 };
+    auto buckets = MemScanner::makeFilterBuckets(addresses, 4);
+
+    TS_ASSERT_EQUALS(buckets.size(), 3);
+    TS_ASSERT_EQUALS(buckets[0].begin, 0);
+    TS_ASSERT_EQUALS(buckets[0].end, 3);
+    TS_ASSERT_EQUALS(buckets[0].start, 0x10000);
+    TS_ASSERT_EQUALS(buckets[0].size, page + 4);
+    TS_ASSERT_EQUALS(buckets[1].begin, 3);
+    TS_ASSERT_EQUALS(buckets[2].size, 4);
+  }
+
+  void testFilterUnsorted() {
+    MemScanner scanner;
+    int memory[] = {100, 200, 100, 100};
+
+    auto buffer = ScanParser::valueToBytes("100", "int32");
+    Operands operands(std::vector<SizedBytes>{ buffer });
+    auto list = scanner.scanInner(operands, 4, (Address)memory, 4 * 4, "int32", ScanParser::OpType::Eq);
+    std::reverse(list.begin(), list.end());
+
+    memory[2] = 120;
+    list = scanner.filter(list, operands, 4, "int32", ScanParser::OpType::Eq);
+    TS_ASSERT_EQUALS(list.size(), 2);
+    TS_ASSERT_EQUALS(list[0]->getAddress(), (Address)&memory[0]);
+    TS_ASSERT_EQUALS(list[1]->getAddress(), (Address)&memory[3]);
+  }
+
+  void testFilterKeepsList() {
+    MemScanner scanner;
+    int memory[] = {100, 200, 100};
+
+    auto buffer = ScanParser::valueToBytes("100", "int32");
+    Operands operands(std::vector<SizedBytes>{ buffer });
+    auto list = scanner.scanInner(operands, 4, (Address)memory, 4 * 3, "int32", ScanParser::OpType::Eq);
+
+    // The filtered elements remember the new value, the ones of the list still remember the old value
+    memory[0] = 120;
+    buffer = ScanParser::valueToBytes("120", "int32");
+    operands = Operands(std::vector<SizedBytes>{ buffer });
+    auto filtered = scanner.filter(list, operands, 4, "int32", ScanParser::OpType::Eq);
+    TS_ASSERT_EQUALS(filtered.size(), 1);
+    TS_ASSERT_DIFFERS(filtered[0].get(), list[0].get());
+    TS_ASSERT_EQUALS(static_pointer_cast<Pem>(filtered[0])->recallValue("int32"), "120");
+    TS_ASSERT_EQUALS(static_pointer_cast<Pem>(list[0])->recallValue("int32"), "100");
+  }
+
+  void testFilterProgress() {
+    MemScanner scanner;
+    int memory[] = {100, 200, 100};
+    auto list = scanner.scanUnknownInner((Address)memory, 4 * 3, "int32");
+
+    auto buffer = ScanParser::valueToBytes("100", "int32");
+    Operands operands(std::vector<SizedBytes>{ buffer });
+    auto filtered = scanner.filter(list, operands, 4, "int32", ScanParser::OpType::Eq);
+    TS_ASSERT_EQUALS(filtered.size(), 2);
+    TS_ASSERT_EQUALS(scanner.getProgress().getHits(), 2);
+    TS_ASSERT_EQUALS(scanner.getProgress().getBytesScanned(), list.size() * 4);
+
+    // Cancelled filter keeps the candidates which are not checked
+    scanner.getProgress().cancel();
+    filtered = scanner.filter(list, operands, 4, "int32", ScanParser::OpType::Eq);
+    TS_ASSERT_EQUALS(filtered.size(), list.size());
+  }
+
+  void testFilterSnapshot() {
+    MemScanner scanner;
+    size_t pageSize = getpagesize();
+    int* memory = (int*)aligned_alloc(pageSize, pageSize * 4);
+    memset(memory, 0, pageSize * 4);
+    scanner.setScopeStart((Address)memory);
+    scanner.setScopeEnd((Address)memory + pageSize * 4);
+
+    vector<MemPtr> empty;
+    scanner.saveSnapshot(empty);
+    memory[pageSize / sizeof(int) * 2] = 5;
+    auto list = scanner.filterUnknown(empty, "int32", ScanParser::OpType::Gt, true);
+    TS_ASSERT_EQUALS(list.size(), 1);
+    TS_ASSERT_EQUALS(list[0]->getAddress(), (Address)&memory[pageSize / sizeof(int) * 2]);
+    if (PageMap::isSoftDirtySupported()) {
+      TS_ASSERT_EQUALS(scanner.getProgress().getPagesSkipped(), 3);
+    }
+
+    scanner.saveSnapshot(empty);
+    memory[0] = 1;
+    list = scanner.filterUnknown(empty, "int32", ScanParser::OpType::Eq, true);
+    TS_ASSERT_EQUALS(list.size(), pageSize - 1);
+
+    // The pages not written keep their values, the operator decides whether they match
+    scanner.saveSnapshot(empty);
+    memory[1] = 3;
+    list = scanner.filterUnknown(empty, "int32", ScanParser::OpType::Ge, true);
+    TS_ASSERT_EQUALS(list.size(), pageSize);
+    scanner.saveSnapshot(empty);
+    memory[1] = 4;
+    list = scanner.filterUnknown(empty, "int32", ScanParser::OpType::Neq, true);
+    TS_ASSERT_EQUALS(list.size(), 1);
+
+    // The percent change depends on the old value, the pages not written are still compared
+    for (size_t i = 0; i < pageSize; i++) {
+      memory[i] = 7;
+    }
+    scanner.saveSnapshot(empty);
+    memory[0] = 100;
+    Operands percent = ScanParser::valueToOperands("%= 0 5", "int32", ScanParser::ChangedByPercent);
+    list = scanner.filterUnknown(empty, percent, "int32", ScanParser::ChangedByPercent, true);
+    TS_ASSERT_EQUALS(list.size(), pageSize - 1);
+
+    // Cancelled filter keeps the pages which are not checked
+    scanner.saveSnapshot(empty);
+    memory[0] = 2;
+    scanner.getProgress().cancel();
+    list = scanner.filterUnknown(empty, "int32", ScanParser::OpType::Gt, true);
+    TS_ASSERT_EQUALS(list.size(), pageSize);
+    free(memory);
+  }
+
   void testScanUnknown() {
     MemScanner scanner;
     int memory[] = {100, 200, 100};
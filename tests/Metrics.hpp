@@ -0,0 +1,48 @@
+#include <cxxtest/TestSuite.h>
+
+#include "med/Metrics.hpp"
+#include "mem/MemScanner.hpp"
+
+using namespace std;
+
+class TestMetrics : public CxxTest::TestSuite {
+public:
+  void testCountersAndPhases() {
+    Metrics& metrics = Metrics::getInstance();
+    metrics.reset();
+    metrics.setTracing(true);
+
+    metrics.add(Counter::Hits, 3);
+    {
+      MetricsTimer timer("phase");
+    }
+    TS_ASSERT_EQUALS(metrics.get(Counter::Hits), 3);
+    TS_ASSERT_EQUALS(metrics.getPhases()["phase"].count, 1);
+
+    Json::Value trace = metrics.getTrace();
+    TS_ASSERT_EQUALS(trace["traceEvents"].size(), 1);
+    TS_ASSERT_EQUALS(trace["traceEvents"][0]["name"].asString(), "phase");
+    TS_ASSERT_EQUALS(trace["otherData"]["hits"].asUInt64(), 3);
+
+    metrics.setTracing(false);
+    metrics.reset();
+    TS_ASSERT_EQUALS(metrics.get(Counter::Hits), 0);
+    TS_ASSERT_EQUALS(metrics.getPhases().size(), 0);
+  }
+
+  void testFilterCounters() {
+    MemScanner scanner;
+    int memory[] = {100, 200, 100};
+    auto list = scanner.scanUnknownInner((Address)memory, 4 * 3, "int32");
+
+    Metrics& metrics = Metrics::getInstance();
+    metrics.reset();
+    auto buffer = ScanParser::valueToBytes("100", "int32");
+    Operands operands(std::vector<SizedBytes>{ buffer });
+    scanner.filter(list, operands, 4, "int32", ScanParser::OpType::Eq);
+
+    TS_ASSERT_EQUALS(metrics.get(Counter::Comparisons), list.size());
+    TS_ASSERT_EQUALS(metrics.get(Counter::Hits), 2);
+    TS_ASSERT_EQUALS(metrics.getPhases()["filter"].count, 1);
+  }
+};
@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <cstdio>
+#include <unistd.h>
+#include <cxxtest/TestSuite.h>
+
+#include "mem/PointerMap.hpp"
+#include "med/MedException.hpp"
+
+using namespace std;
+
+class TestPointerMap : public CxxTest::TestSuite {
+public:
+  // Module is moved, and the heap objects are allocated elsewhere in each run
+  void makeRun(PointerMap& pointerMap, Address module, Address heap, Address target, Address other) {
+    Maps maps;
+    maps.push(AddressPair(module, module + 0x1000), "/usr/lib/libgame.so");
+    maps.push(AddressPair(heap, heap + 0x100000), "[heap]");
+    Address object = target - 0x500;
+    vector<PointerEntry> entries = {
+      { module + 0x10, object },         // [[libgame.so+0x10]+0x8]+0x10
+      { module + 0x20, other },          // [libgame.so+0x20]+0x8, only valid when "other" is near the target
+      { object + 0x8, target - 0x10 }
+    };
+    sort(entries.begin(), entries.end(), [](const PointerEntry& a, const PointerEntry& b) {
+        return a.source < b.source;
+      });
+    pointerMap.set(maps, entries, target);
+  }
+
+  void testFindPaths() {
+    PointerMap pointerMap;
+    makeRun(pointerMap, 0x400000, 0x1000000, 0x1001000, 0x1000ff8);
+    TS_ASSERT_EQUALS(pointerMap.size(), 3);
+
+    Address value;
+    TS_ASSERT(pointerMap.readPointer(0x400010, value));
+    TS_ASSERT_EQUALS(value, 0x1000b00);
+    TS_ASSERT(!pointerMap.readPointer(0x400018, value));
+    TS_ASSERT_EQUALS(pointerMap.findPointersTo(0x1000a00, 0x1000c00).size(), 1);
+
+    auto paths = pointerMap.findPaths(3, 0x100);
+    TS_ASSERT_EQUALS(paths.size(), 2);
+    TS_ASSERT_EQUALS(paths[0].toString(), "[libgame.so+0x20]+0x8");
+    TS_ASSERT_EQUALS(paths[1].toString(), "[[libgame.so+0x10]+0x8]+0x10");
+
+    Address addr;
+    TS_ASSERT(pointerMap.resolve(paths[1], addr));
+    TS_ASSERT_EQUALS(addr, 0x1001000);
+
+    // Depth limits the dereferences
+    TS_ASSERT_EQUALS(pointerMap.findPaths(1, 0x100).size(), 1);
+  }
+
+  void testSaveAndIntersect() {
+    string filename = "/tmp/med-test-pointers-" + to_string(getpid());
+    {
+      PointerMap first;
+      makeRun(first, 0x400000, 0x1000000, 0x1001000, 0x1000ff8);
+      first.save(filename);
+    }
+    PointerMap loaded;
+    loaded.load(filename);
+    TS_ASSERT_EQUALS(loaded.size(), 3);
+    TS_ASSERT_EQUALS(loaded.getTarget(), 0x1001000);
+    TS_ASSERT_EQUALS(loaded.getMaps().getName(0), "/usr/lib/libgame.so");
+
+    PointerMap second;
+    makeRun(second, 0x500000, 0x2000000, 0x2001300, 0x2000000);
+    auto paths = PointerMap::intersect({ &loaded, &second }, 3, 0x100);
+    TS_ASSERT_EQUALS(paths.size(), 1);
+    TS_ASSERT_EQUALS(paths[0].toString(), "[[libgame.so+0x10]+0x8]+0x10");
+    remove(filename.c_str());
+
+    TS_ASSERT_THROWS(loaded.load(filename), MedException);
+  }
+};
@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <cxxtest/TestSuite.h>
+
+#include "mem/NamedScans.hpp"
+#include "mem/Pem.hpp"
+#include "mem/ScanHistory.hpp"
+
+using namespace std;
+
+class TestScanHistory : public CxxTest::TestSuite {
+public:
+  vector<MemPtr> makeList(Address start, size_t count, size_t step) {
+    vector<MemPtr> list;
+    for (size_t i = 0; i < count; i++) {
+      list.push_back(PemPtr(new Pem(start + i * step, 4, NULL)));
+    }
+    return list;
+  }
+
+  void testUndoRedo() {
+    ScanHistory history;
+    MemList scanned(makeList(0x1000, 1000, 4));
+    history.push(scanned, "int32");
+
+    // Filter results are new elements at some of the addresses
+    MemList filtered(makeList(0x1000, 100, 8));
+    history.push(filtered, "int32");
+    MemList narrowed(makeList(0x1000, 10, 16));
+    history.push(narrowed, "int32");
+    TS_ASSERT_EQUALS(history.size(), 3);
+    TS_ASSERT_LESS_THAN(history.getMemoryUsage(), 1000 / 8 * 2 + 16);
+
+    MemList list;
+    string scanType;
+    TS_ASSERT(history.undo(list, scanType));
+    TS_ASSERT_EQUALS(list.size(), 100);
+    TS_ASSERT_EQUALS(list.getAddress(99), 0x1000 + 99 * 8);
+    TS_ASSERT_EQUALS(scanType, "int32");
+    TS_ASSERT(history.undo(list, scanType));
+    TS_ASSERT_EQUALS(list.size(), 1000);
+    TS_ASSERT_EQUALS(&list.getList(), &scanned.getList());
+    TS_ASSERT(!history.undo(list, scanType));
+
+    TS_ASSERT(history.redo(list, scanType));
+    TS_ASSERT_EQUALS(list.size(), 100);
+
+    // A new result drops the ones which are undone
+    MemList other(makeList(0x9000, 5, 4));
+    history.push(other, "int16");
+    TS_ASSERT(!history.canRedo());
+    TS_ASSERT(history.undo(list, scanType));
+    TS_ASSERT_EQUALS(list.size(), 100);
+  }
+
+  void testUnsortedBase() {
+    ScanHistory history;
+    // A scan result of many addresses is not sorted, the filter results are
+    vector<MemPtr> mems = makeList(0x1000, 1000, 4);
+    reverse(mems.begin(), mems.end());
+    MemList scanned(mems);
+    history.push(scanned, "int32");
+    MemList filtered(makeList(0x1000, 100, 8));
+    history.push(filtered, "int32");
+    MemList narrowed(makeList(0x1000, 10, 16));
+    history.push(narrowed, "int32");
+    TS_ASSERT_LESS_THAN(history.getMemoryUsage(), 1000 * sizeof(size_t) + 1000 / 8 * 3 + 24);
+
+    MemList list;
+    string scanType;
+    TS_ASSERT(history.undo(list, scanType));
+    TS_ASSERT_DIFFERS(&list.getList(), &filtered.getList());
+    TS_ASSERT_EQUALS(list.size(), 100);
+    TS_ASSERT_EQUALS(list.getAddress(0), 0x1000);
+    TS_ASSERT_EQUALS(list.getAddress(99), 0x1000 + 99 * 8);
+    TS_ASSERT(history.undo(list, scanType));
+    TS_ASSERT_EQUALS(&list.getList(), &scanned.getList());
+    TS_ASSERT(history.redo(list, scanType));
+    TS_ASSERT(history.redo(list, scanType));
+    TS_ASSERT_EQUALS(list.size(), 10);
+    TS_ASSERT_EQUALS(list.getAddress(9), 0x1000 + 9 * 16);
+  }
+
+  void testCapped() {
+    ScanHistory history;
+    MemList scanned(makeList(0x1000, 100, 4));
+    history.push(scanned, "int32", true);
+    MemList filtered(makeList(0x1000, 10, 8));
+    history.push(filtered, "int32");
+
+    // The scanner had more results than the capped list, they are not restored
+    TS_ASSERT(history.isCapped(true));
+    TS_ASSERT(!history.isCapped(false));
+    MemList list;
+    string scanType;
+    TS_ASSERT(history.undo(list, scanType));
+    TS_ASSERT(!history.isCapped(true));
+    TS_ASSERT(!history.isCapped(false));
+  }
+
+  vector<MemPtr> makePems(Address start, size_t count, size_t step, int value) {
+    vector<MemPtr> list;
+    for (size_t i = 0; i < count; i++) {
+      PemPtr pem = PemPtr(new Pem(start + i * step, sizeof(value), NULL));
+      pem->setScanType("int32");
+      pem->rememberValue((Byte*)&value, sizeof(value));
+      list.push_back(pem);
+    }
+    return list;
+  }
+
+  void testRestoreRememberedValues() {
+    ScanHistory history;
+    MemList scanned(makePems(0x1000, 10, 4, 1));
+    history.push(scanned, "int32");
+    MemList filtered(makePems(0x1000, 5, 8, 2));
+    history.push(filtered, "int32");
+    MemList narrowed(makePems(0x1000, 2, 16, 3));
+    history.push(narrowed, "int32");
+
+    // The next change filter compares with the values of the restored result, not of the scan
+    MemList list;
+    string scanType;
+    TS_ASSERT(history.undo(list, scanType));
+    TS_ASSERT_EQUALS(list.size(), 5);
+    TS_ASSERT_EQUALS(list.getAddress(4), 0x1000 + 4 * 8);
+    TS_ASSERT_EQUALS(static_pointer_cast<Pem>(list.getMemPtr(4))->recallValue("int32"), "2");
+    TS_ASSERT(history.undo(list, scanType));
+    TS_ASSERT_EQUALS(static_pointer_cast<Pem>(list.getMemPtr(0))->recallValue("int32"), "1");
+    TS_ASSERT(history.redo(list, scanType));
+    TS_ASSERT(history.redo(list, scanType));
+    TS_ASSERT_EQUALS(static_pointer_cast<Pem>(list.getMemPtr(1))->recallValue("int32"), "3");
+  }
+
+  void testNamedScans() {
+    NamedScans namedScans;
+    namedScans.setMemPtrs(makeList(0x1000, 4, 4), "int32");
+    namedScans.setMemPtrs(makeList(0x1000, 2, 8), "int32");
+    namedScans.setMemPtrs(makeList(0x2000, 2, 2), "int16");
+
+    TS_ASSERT(namedScans.undo());
+    TS_ASSERT_EQUALS(namedScans.getMemList()->size(), 2);
+    TS_ASSERT_EQUALS(namedScans.getScanType(), "int32");
+    TS_ASSERT(namedScans.undo());
+    TS_ASSERT_EQUALS(namedScans.getMemList()->size(), 4);
+    TS_ASSERT(namedScans.redo());
+    TS_ASSERT(namedScans.redo());
+    TS_ASSERT_EQUALS(namedScans.getMemList()->getAddress(0), 0x2000);
+    TS_ASSERT_EQUALS(namedScans.getScanType(), "int16");
+    TS_ASSERT(!namedScans.redo());
+  }
+};
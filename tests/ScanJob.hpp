@@ -0,0 +1,112 @@
+#include <chrono>
+#include <thread>
+#include <cxxtest/TestSuite.h>
+
+#include "mem/ScanJob.hpp"
+#include "med/MedException.hpp"
+
+using namespace std;
+
+class TestScanJob : public CxxTest::TestSuite {
+public:
+  void testComplete() {
+    ScanProgress progress;
+    ScanJob job(progress, []() {
+      vector<MemPtr> list;
+      for (int i = 0; i < 5; i++) {
+        list.push_back(MemPtr(new Mem(4)));
+      }
+      return list;
+    });
+    job.start();
+    job.wait();
+
+    TS_ASSERT(job.isDone());
+    TS_ASSERT(job.getStatus() == ScanJobStatus::Done);
+    TS_ASSERT_EQUALS(job.getResults().size(), 5);
+
+    // Callbacks set after the job finished are called immediately
+    vector<size_t> batches;
+    job.setOnBatch([&batches](const vector<MemPtr>& batch) {
+      batches.push_back(batch.size());
+    }, 2);
+    TS_ASSERT_EQUALS(batches.size(), 3);
+    TS_ASSERT_EQUALS(batches[2], 1);
+
+    bool completed = false;
+    job.setOnComplete([&completed](ScanJob&) { completed = true; });
+    TS_ASSERT(completed);
+  }
+
+  void testFailedAndCancelled() {
+    ScanProgress progress;
+    ScanJob failed(progress, []() -> vector<MemPtr> {
+      throw MedException("Invalid scan string");
+    });
+    failed.start();
+    failed.wait();
+    TS_ASSERT(failed.getStatus() == ScanJobStatus::Failed);
+    TS_ASSERT_EQUALS(failed.getError(), "Invalid scan string");
+
+    ScanJob cancelled(progress, []() { return vector<MemPtr>(); });
+    cancelled.cancel();
+    cancelled.start();
+    cancelled.wait();
+    TS_ASSERT(cancelled.getStatus() == ScanJobStatus::Cancelled);
+  }
+
+  void testBatchesWhileRunning() {
+    ScanProgress progress;
+    vector<size_t> batches;
+    size_t batchesDuringTask = 0;
+    ScanJob job(progress, [&progress, &batches, &batchesDuringTask]() {
+      vector<MemPtr> list;
+      for (int i = 0; i < 5; i++) {
+        list.push_back(MemPtr(new Mem(4)));
+      }
+      progress.addFound(vector<MemPtr>(list.begin(), list.begin() + 3));
+      progress.addFound(vector<MemPtr>(list.begin() + 3, list.end()));
+      batchesDuringTask = batches.size();
+      return list;
+    });
+    job.setOnBatch([&batches](const vector<MemPtr>& batch) {
+      batches.push_back(batch.size());
+    }, 2);
+    job.start();
+    // Every batch is delivered once the job is seen done
+    while (!job.isDone()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    TS_ASSERT_EQUALS(batches.size(), 3);
+    job.wait();
+
+    TS_ASSERT_EQUALS(batchesDuringTask, 2);
+    TS_ASSERT_EQUALS(batches.size(), 3);
+    TS_ASSERT_EQUALS(batches[2], 1);
+    TS_ASSERT(job.takeFound().empty());
+  }
+
+  void testTakeFound() {
+    ScanProgress progress;
+    ScanJob job(progress, [&progress]() {
+      vector<MemPtr> list;
+      for (int i = 0; i < 3; i++) {
+        list.push_back(MemPtr(new Mem(4)));
+      }
+      progress.addFound(list);
+      return list;
+    });
+    job.start();
+    job.wait();
+    TS_ASSERT_EQUALS(job.takeFound().size(), 3);
+    TS_ASSERT(job.takeFound().empty());
+
+    // The results of a task which does not pass them are taken at the end
+    ScanJob filter(progress, []() {
+      return vector<MemPtr>(2, MemPtr(new Mem(4)));
+    });
+    filter.start();
+    filter.wait();
+    TS_ASSERT_EQUALS(filter.takeFound().size(), 2);
+  }
+};
@@ -3,6 +3,7 @@
 
 #include "med/ScanParser.hpp"
 #include "med/ScanCommand.hpp"
+#include "med/MedException.hpp"
 #include "mem/StringUtil.hpp"
 
 using namespace std;
@@ -164,6 +165,72 @@ public:
     TS_ASSERT_EQUALS(bytes[3], 0);
   }
 
+  void test_approxOperators() {
+    TS_ASSERT_EQUALS(ScanParser::getOp("~ 100.5"), "~");
+    TS_ASSERT_EQUALS(ScanParser::getOp("~~100.5"), "~~");
+    TS_ASSERT_EQUALS(ScanParser::getOpType("~ 100.5"), ScanParser::Approx);
+    TS_ASSERT_EQUALS(ScanParser::getOpType("~~ 100.5"), ScanParser::Truncated);
+    TS_ASSERT_EQUALS(ScanParser::getValue("~~ 100.5"), "100.5");
+    TS_ASSERT_EQUALS(ScanParser::isValid("~"), false);
+    TS_ASSERT_EQUALS(ScanParser::isValid("~ 1.5"), true);
+    TS_ASSERT_EQUALS(ScanParser::getDecimalPlaces("100.25"), 2);
+    TS_ASSERT_EQUALS(ScanParser::getDecimalPlaces("100"), 0);
+  }
+
+  void test_getApproxOperands() {
+    Operands result = ScanParser::valueToOperands("~ 100.5", SCAN_TYPE_FLOAT_32, ScanParser::Approx);
+    TS_ASSERT_DELTA(result.getLowerBound(), 100.45, 1e-9);
+    TS_ASSERT_DELTA(result.getUpperBound(), 100.55, 1e-9);
+    TS_ASSERT(result.getUpperBound() < 100.55);
+    TS_ASSERT_EQUALS(ScanParser::getValueSize(result, SCAN_TYPE_FLOAT_32, ScanParser::Approx), 4);
+
+    result = ScanParser::valueToOperands("~~ 100.5", SCAN_TYPE_FLOAT_64, ScanParser::Truncated);
+    TS_ASSERT_EQUALS(result.getLowerBound(), 100.5);
+    TS_ASSERT(result.getUpperBound() < 100.6);
+
+    result = ScanParser::valueToOperands("~ 200 0.5", SCAN_TYPE_FLOAT_64, ScanParser::Approx);
+    TS_ASSERT_EQUALS(result.getLowerBound(), 199.5);
+    TS_ASSERT_EQUALS(result.getUpperBound(), 200.5);
+
+    result = ScanParser::valueToOperands("~ 200 1%", SCAN_TYPE_FLOAT_64, ScanParser::Approx);
+    TS_ASSERT_EQUALS(result.getLowerBound(), 198);
+    TS_ASSERT_EQUALS(result.getUpperBound(), 202);
+
+    TS_ASSERT_THROWS(ScanParser::valueToOperands("~ 200", SCAN_TYPE_INT_32, ScanParser::Approx), MedException);
+  }
+
+  void test_deltaOperators() {
+    TS_ASSERT_EQUALS(ScanParser::getOpType("+= 25"), ScanParser::IncreasedBy);
+    TS_ASSERT_EQUALS(ScanParser::getOpType("-=25"), ScanParser::DecreasedBy);
+    TS_ASSERT_EQUALS(ScanParser::getOpType("%= 10 20"), ScanParser::ChangedByPercent);
+    TS_ASSERT_EQUALS(ScanParser::getOpType("-25"), ScanParser::Eq);
+    TS_ASSERT_EQUALS(ScanParser::getValue("-= 25"), "25");
+    TS_ASSERT_EQUALS(ScanParser::isValid("+="), false);
+
+    Operands result = ScanParser::valueToOperands("+= 25", SCAN_TYPE_INT_32, ScanParser::IncreasedBy);
+    TS_ASSERT_EQUALS(result.getLowerBound(), 25);
+    TS_ASSERT_EQUALS(result.getUpperBound(), 25);
+
+    result = ScanParser::valueToOperands("%= 20 10", SCAN_TYPE_INT_32, ScanParser::ChangedByPercent);
+    TS_ASSERT_EQUALS(result.getLowerBound(), 10);
+    TS_ASSERT_EQUALS(result.getUpperBound(), 20);
+  }
+
+  void test_setOperator() {
+    TS_ASSERT_EQUALS(ScanParser::getOpType("in {1, 2, 3}"), ScanParser::In);
+    TS_ASSERT_EQUALS(ScanParser::getOpType("in{7}"), ScanParser::In);
+    TS_ASSERT_EQUALS(ScanParser::getValue("in {1, 2, 3}"), "{1, 2, 3}");
+    TS_ASSERT_EQUALS(ScanParser::isValid("in {}"), false);
+
+    Operands result = ScanParser::valueToOperands("in {1, 2 3}", SCAN_TYPE_INT_16, ScanParser::In);
+    TS_ASSERT_EQUALS(result.count(), 3);
+    TS_ASSERT_EQUALS(result.getValueSet()->count(), 3);
+    TS_ASSERT_EQUALS(ScanParser::getValueSize(result, SCAN_TYPE_INT_16, ScanParser::In), 2);
+
+    TS_ASSERT_THROWS(ScanParser::valueToOperands("in 1, 2", SCAN_TYPE_INT_32, ScanParser::In), MedException);
+    TS_ASSERT_THROWS(ScanParser::valueToOperands("in {a}", SCAN_TYPE_STRING, ScanParser::In), MedException);
+  }
+
   void test_getScanCommand() {
     string s = "1";
     ScanCommand cmd = ScanParser::getScanCommand(s);
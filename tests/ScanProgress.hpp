@@ -0,0 +1,54 @@
+#include <cxxtest/TestSuite.h>
+
+#include "mem/ScanProgress.hpp"
+
+using namespace std;
+
+class TestScanProgress : public CxxTest::TestSuite {
+public:
+  void testCounters() {
+    ScanProgress progress;
+    progress.start(400);
+    TS_ASSERT(progress.isRunning());
+    TS_ASSERT_LESS_THAN(progress.getEtaSeconds(), 0);
+
+    progress.addBytesScanned(100);
+    progress.addPagesSkipped();
+    progress.addHits(3);
+    TS_ASSERT_EQUALS(progress.getBytesScanned(), 100);
+    TS_ASSERT_EQUALS(progress.getPagesSkipped(), 1);
+    TS_ASSERT_EQUALS(progress.getHits(), 3);
+    TS_ASSERT_DELTA(progress.getFraction(), 0.25, 0.0001);
+    TS_ASSERT(progress.getEtaSeconds() >= 0);
+
+    progress.finish();
+    TS_ASSERT(!progress.isRunning());
+  }
+
+  void testTimed() {
+    ScanProgress progress;
+    progress.startTimed(1000);
+    TS_ASSERT(progress.isRunning());
+    TS_ASSERT_LESS_THAN(progress.getFraction(), 0.01);
+    TS_ASSERT_EQUALS(progress.getBytesScanned(), 0);
+
+    progress.finish();
+    TS_ASSERT_EQUALS(progress.getFraction(), 1);
+
+    // A scan afterwards is by the bytes again
+    progress.start(400);
+    progress.addBytesScanned(200);
+    TS_ASSERT_DELTA(progress.getFraction(), 0.5, 0.0001);
+  }
+
+  void testCancel() {
+    ScanProgress progress;
+    progress.cancel();
+    progress.start(100);
+    TS_ASSERT(progress.isCancelled());
+
+    progress.reset();
+    TS_ASSERT(!progress.isCancelled());
+    TS_ASSERT_EQUALS(progress.getBytesTotal(), 0);
+  }
+};
@@ -0,0 +1,47 @@
+#include <cxxtest/TestSuite.h>
+#include <unistd.h>
+
+#include "med/MedException.hpp"
+#include "mem/ScanRanges.hpp"
+
+using namespace std;
+
+class TestScanRanges : public CxxTest::TestSuite {
+public:
+  void testParse() {
+    auto ranges = ScanRanges::parse("0x1000-0x3000, libgame.so [heap]  anon");
+    TS_ASSERT_EQUALS(ranges.getIntervals().size(), 1);
+    TS_ASSERT_EQUALS(std::get<0>(ranges.getIntervals()[0]), 0x1000);
+    TS_ASSERT_EQUALS(std::get<1>(ranges.getIntervals()[0]), 0x3000);
+    TS_ASSERT_EQUALS(ranges.getModules().size(), 3);
+    TS_ASSERT_EQUALS(ranges.getModules()[0], "libgame.so");
+
+    TS_ASSERT(ScanRanges::parse("").isEmpty());
+    TS_ASSERT_THROWS(ScanRanges::parse("3000-1000"), MedException);
+  }
+
+  void testApply() {
+    Address page = getpagesize();
+    Maps maps;
+    maps.push(AddressPair(page * 10, page * 20), "/usr/lib/libgame.so");
+    maps.push(AddressPair(page * 30, page * 40));
+    maps.push(AddressPair(page * 50, page * 60), "/usr/lib/libc.so.6");
+
+    ScanRanges ranges;
+    ranges.addModule("libgame.so");
+    ranges.addInterval(page * 15, page * 35 + 1); // Overlaps libgame.so, extended to whole page
+    ranges.addInterval(page * 70, page * 80);     // Not mapped
+    Maps applied = ranges.apply(maps);
+
+    TS_ASSERT_EQUALS(applied.size(), 2);
+    TS_ASSERT_EQUALS(std::get<0>(applied.getMaps()[0]), page * 10);
+    TS_ASSERT_EQUALS(std::get<1>(applied.getMaps()[0]), page * 20);
+    TS_ASSERT_EQUALS(std::get<0>(applied.getMaps()[1]), page * 30);
+    TS_ASSERT_EQUALS(std::get<1>(applied.getMaps()[1]), page * 36);
+    TS_ASSERT(applied.isAnonymous(1));
+
+    ranges.clear();
+    ranges.addModule("anon");
+    TS_ASSERT_EQUALS(ranges.apply(maps).size(), 1);
+  }
+};
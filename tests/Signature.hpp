@@ -0,0 +1,29 @@
+#include <cxxtest/TestSuite.h>
+
+#include "med/Signature.hpp"
+#include "med/ScanCommand.hpp"
+
+using namespace std;
+
+class TestSignature : public CxxTest::TestSuite {
+public:
+  void testFromBytes() {
+    Byte bytes[] = { 0x48, 0x8b, 0x05, 0x11, 0x22, 0x33, 0x44, 0x48, 0x85, 0xc0, 0x00, 0x00 };
+    vector<bool> wildcards = { false, false, false, true, true, true, true, false, false, false, true, true };
+    Signature signature = Signature::fromBytes(bytes, wildcards, 3);
+
+    // Trailing wildcards are dropped
+    TS_ASSERT_EQUALS(signature.getPattern(), "b:488b05, w:4, b:4885c0");
+    TS_ASSERT_EQUALS(signature.getOffset(), 3);
+    TS_ASSERT(!signature.isEmpty());
+    TS_ASSERT(Signature().isEmpty());
+
+    ScanCommand command(signature.getPattern());
+    TS_ASSERT_EQUALS(command.getSize(), 10);
+    TS_ASSERT(command.match(bytes));
+    bytes[4] = 0x99;
+    TS_ASSERT(command.match(bytes));
+    bytes[8] = 0x99;
+    TS_ASSERT(!command.match(bytes));
+  }
+};
@@ -0,0 +1,63 @@
+#include <cstring>
+#include <cxxtest/TestSuite.h>
+
+#include "med/StrideDetector.hpp"
+#include "med/MedException.hpp"
+
+using namespace std;
+
+struct Entity {
+  void* vtable;
+  int32_t id;
+  int32_t hp;
+  int32_t maxHp;
+  float x;
+  float y;
+  int32_t flags;
+};
+
+class TestStrideDetector : public CxxTest::TestSuite {
+public:
+  void testDetect() {
+    Entity entities[10];
+    memset(entities, 0, sizeof(entities));
+    for (int i = 1; i < 9; i++) {
+      entities[i].vtable = (void*)0x55aa55aa1000;
+      entities[i].id = i;
+      entities[i].hp = 50 + i * 10;
+      entities[i].maxHp = 200;
+      entities[i].x = 1.5f * i;
+      entities[i].y = -3.0f;
+      entities[i].flags = 0x101;
+    }
+
+    const Byte* buf = (const Byte*)entities;
+    Address start = 0x10000;
+    Address anchor = start + sizeof(Entity) * 3 + offsetof(Entity, hp);
+    StrideDetector detector("int32", 256);
+    TS_ASSERT_EQUALS(detector.findStride(buf, sizeof(entities), anchor - start), sizeof(Entity));
+
+    // The zeroed elements at both ends are not part of the array
+    StrideMatch match = detector.detect(buf, sizeof(entities), start, anchor);
+    TS_ASSERT_EQUALS(match.stride, sizeof(Entity));
+    TS_ASSERT_EQUALS(match.addresses.size(), 8);
+    TS_ASSERT_EQUALS(match.addresses[0], start + sizeof(Entity) + offsetof(Entity, hp));
+    TS_ASSERT_EQUALS(match.addresses[7], start + sizeof(Entity) * 8 + offsetof(Entity, hp));
+
+    // Implausible value stops the walk
+    entities[6].hp = 1 << 30;
+    match = detector.detect(buf, sizeof(entities), start, anchor);
+    TS_ASSERT_EQUALS(match.addresses.size(), 5);
+  }
+
+  void testNoStride() {
+    Byte buf[512] = { 0 };
+    StrideDetector detector("int32");
+    StrideMatch match = detector.detect(buf, sizeof(buf), 0x1000, 0x1100);
+    TS_ASSERT_EQUALS(match.stride, 0);
+    TS_ASSERT_EQUALS(match.addresses.size(), 1);
+
+    TS_ASSERT_THROWS(detector.detect(buf, sizeof(buf), 0x1000, 0x2000), MedException);
+    TS_ASSERT_THROWS(StrideDetector("string"), MedException);
+  }
+};
@@ -2,6 +2,7 @@
 #include <cxxtest/TestSuite.h>
 
 #include "med/SubCommand.hpp"
+#include "med/MedException.hpp"
 
 using namespace std;
 
@@ -19,6 +20,10 @@ public:
     s = "w:10";
     cmd = SubCommand::parseCmd(s);
     TS_ASSERT_EQUALS(cmd, SubCommand::Wildcard);
+
+    s = "b:488b05";
+    cmd = SubCommand::parseCmd(s);
+    TS_ASSERT_EQUALS(cmd, SubCommand::Bytes);
   }
 
   void test_getOperands() {
@@ -52,4 +57,18 @@ public:
     auto steps = subCmd.getWildcardSteps();
     TS_ASSERT_EQUALS(steps, 20);
   }
+
+  void test_getBytes() {
+    SubCommand subCmd("b:488b05");
+    TS_ASSERT_EQUALS(subCmd.getSize(), 3);
+    auto bytes = subCmd.getOperands().getFirstOperand().getBytes();
+    TS_ASSERT_EQUALS(bytes[0], 0x48);
+    TS_ASSERT_EQUALS(bytes[2], 0x05);
+
+    Byte memory[] = { 0x48, 0x8b, 0x05 };
+    TS_ASSERT(std::get<0>(subCmd.match(memory)));
+
+    TS_ASSERT_THROWS(SubCommand("b:488"), MedException);
+    TS_ASSERT_THROWS(SubCommand("b:zz"), MedException);
+  }
 };
@@ -0,0 +1,112 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+#include <cxxtest/TestSuite.h>
+
+#include "mem/ValueRecorder.hpp"
+#include "med/MedException.hpp"
+
+using namespace std;
+
+class TestValueRecorder : public CxxTest::TestSuite {
+public:
+  void testRecord() {
+    static int counter = 0;
+    static float level = 2.5;
+    // Read through the system, which fails on the null address instead of faulting
+    MemIO memio;
+    memio.setPid(getpid());
+    ValueRecorder recorder(&memio);
+    recorder.setTracks({
+        RecorderTrack{ (Address)&counter, "int32", "counter" },
+        RecorderTrack{ (Address)&level, "float32", "" },
+        RecorderTrack{ 0, "int8", "null" } });
+    recorder.start(500);
+    for (int i = 0; i < 20; i++) {
+      __atomic_add_fetch(&counter, 1, __ATOMIC_RELAXED);
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    recorder.stop();
+
+    auto samples = recorder.getSamples();
+    TS_ASSERT_LESS_THAN(10, samples.size());
+    TS_ASSERT_EQUALS(samples.size(), recorder.getRecorded());
+    TS_ASSERT_LESS_THAN_EQUALS(samples.front().values[0], samples.back().values[0]);
+    TS_ASSERT_EQUALS(samples.back().values[1], 2.5);
+    TS_ASSERT_EQUALS(samples.back().failed, 4);
+    for (size_t i = 1; i < samples.size(); i++) {
+      TS_ASSERT_LESS_THAN(samples[i - 1].timeUs, samples[i].timeUs);
+    }
+    TS_ASSERT_EQUALS(recorder.getSamples(3).size(), 3);
+  }
+
+  void testRingKeepsLatest() {
+    static int value = 1;
+    MemIO memio;
+    ValueRecorder recorder(&memio, 4);
+    recorder.setTracks({ RecorderTrack{ (Address)&value, "int32", "" } });
+    recorder.start(1000);
+    while (recorder.getRecorded() < 10) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    // The oldest slot may be written meanwhile
+    TS_ASSERT_LESS_THAN_EQUALS(recorder.getSamples().size(), 3);
+    recorder.stop();
+    auto samples = recorder.getSamples();
+    TS_ASSERT_EQUALS(samples.size(), 4);
+    TS_ASSERT_EQUALS(samples.back().values[0], 1);
+  }
+
+  void testInvalidTracks() {
+    MemIO memio;
+    ValueRecorder recorder(&memio);
+    TS_ASSERT_THROWS(recorder.start(), MedException);
+    TS_ASSERT_THROWS(recorder.setTracks({ RecorderTrack{ 0, "string", "" } }), MedException);
+    vector<RecorderTrack> tracks(RECORDER_TRACKS_MAX + 1, RecorderTrack{ 0, "int32", "" });
+    TS_ASSERT_THROWS(recorder.setTracks(tracks), MedException);
+    recorder.setTracks({ RecorderTrack{ 0, "int32", "" } });
+    TS_ASSERT_THROWS(recorder.start(RECORDER_RATE_MAX * 2), MedException);
+  }
+
+  void testSave() {
+    static int value = 42;
+    MemIO memio;
+    memio.setPid(getpid());
+    ValueRecorder recorder(&memio);
+    recorder.setTracks({
+        RecorderTrack{ (Address)&value, "int32", "say \"hi\"" },
+        RecorderTrack{ 8, "int16", "" } });
+    recorder.start(1000);
+    while (recorder.getRecorded() < 3) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    TS_ASSERT_THROWS(recorder.saveCsv("/tmp/med-recorder-test.csv"), MedException);
+    recorder.stop();
+    size_t count = recorder.getRecorded();
+
+    recorder.saveCsv("/tmp/med-recorder-test.csv");
+    ifstream csv("/tmp/med-recorder-test.csv");
+    string line;
+    getline(csv, line);
+    TS_ASSERT_EQUALS(line, "time_ms,\"say \"\"hi\"\"\",\"0x8\"");
+    getline(csv, line);
+    TS_ASSERT_EQUALS(line.substr(line.find(',')), ",42,");
+    csv.close();
+    remove("/tmp/med-recorder-test.csv");
+
+    recorder.saveBinary("/tmp/med-recorder-test.bin");
+    ifstream bin("/tmp/med-recorder-test.bin", ios::binary);
+    stringstream contents;
+    contents << bin.rdbuf();
+    string data = contents.str();
+    bin.close();
+    remove("/tmp/med-recorder-test.bin");
+    TS_ASSERT_EQUALS(data.substr(0, 8), string(RECORDER_MAGIC, 8));
+    // Count, 2 tracks of address, type and description, samples count, samples of time, mask and 2 values
+    size_t header = 8 + 8 + (8 + 8 + 5 + 8 + 8) + (8 + 8 + 5 + 8 + 0) + 8;
+    TS_ASSERT_EQUALS(data.size(), header + count * 8 * 4);
+  }
+};
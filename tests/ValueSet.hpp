@@ -0,0 +1,51 @@
+#include <cxxtest/TestSuite.h>
+
+#include "med/MedException.hpp"
+#include "med/ValueSet.hpp"
+
+using namespace std;
+
+class TestValueSet : public CxxTest::TestSuite {
+public:
+  template<typename T>
+  vector<SizedBytes> toBytes(const vector<T>& values) {
+    vector<SizedBytes> list;
+    for (auto value : values) {
+      list.push_back(SizedBytes((Byte*)&value, sizeof(T)));
+    }
+    return list;
+  }
+
+  void testSmallSet() {
+    ValueSet set(toBytes(vector<uint32_t>{ 7, 42, 7, 1000 }), 4);
+    TS_ASSERT_EQUALS(set.count(), 3);
+
+    uint32_t value = 42;
+    TS_ASSERT(set.contains(&value));
+    value = 43;
+    TS_ASSERT(!set.contains(&value));
+  }
+
+  void testLargeSet() {
+    vector<uint64_t> values;
+    for (uint64_t i = 0; i < 500; i++) {
+      values.push_back(i * 7919 + 3);
+    }
+    ValueSet set(toBytes(values), 8);
+    for (auto value : values) {
+      TS_ASSERT(set.contains(&value));
+    }
+    uint64_t value = 4;
+    TS_ASSERT(!set.contains(&value));
+  }
+
+  void testBitset() {
+    ValueSet set(toBytes(vector<uint16_t>{ 1, 65535 }), 2);
+    uint16_t value = 65535;
+    TS_ASSERT(set.contains(&value));
+    value = 2;
+    TS_ASSERT(!set.contains(&value));
+
+    TS_ASSERT_THROWS(ValueSet(toBytes(vector<uint16_t>{ 1 }), 3), MedException);
+  }
+};
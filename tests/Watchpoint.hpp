@@ -0,0 +1,70 @@
+#include <chrono>
+#include <csignal>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cxxtest/TestSuite.h>
+
+#include "mem/Watchpoint.hpp"
+#include "med/MedException.hpp"
+
+using namespace std;
+
+static volatile int watchedValue = 0;
+
+static void writeWatchedValue() {
+  for (;;) {
+    watchedValue = watchedValue + 1;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+class TestWatchpoint : public CxxTest::TestSuite {
+public:
+  void testRanges() {
+    Watchpoint watchpoint(getpid());
+    watchpoint.add(0x1004, 4);
+    TS_ASSERT_EQUALS(watchpoint.getRanges().size(), 1);
+    TS_ASSERT_EQUALS(Watchpoint::makeControl(watchpoint.getRanges()), 0xd0001);
+
+    // Unaligned range is split into the aligned ones
+    Watchpoint split(getpid());
+    split.add(0x1003, 4);
+    TS_ASSERT_EQUALS(split.getRanges().size(), 3);
+    TS_ASSERT_EQUALS(split.getRanges()[1].address, 0x1004);
+    TS_ASSERT_EQUALS(split.getRanges()[1].size, 2);
+    TS_ASSERT_THROWS(split.add(0x2001, 2), MedException);
+    TS_ASSERT_THROWS(split.add(0x2000, 0), MedException);
+  }
+
+  void testWatchWrites() {
+    // The child writes the value from its main thread, then from a thread created while it is watched
+    pid_t child = fork();
+    if (child == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      std::thread writer(writeWatchedValue);
+      writeWatchedValue();
+    }
+    // Another child, which the watch must not reap
+    pid_t other = fork();
+    if (other == 0) {
+      _exit(0);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    Watchpoint watchpoint(child);
+    watchpoint.add((Address)&watchedValue, sizeof(watchedValue));
+    ScanProgress progress;
+    watchpoint.watch(0.3, progress);
+    auto hits = watchpoint.getHits();
+    kill(child, SIGKILL);
+    waitpid(child, NULL, 0);
+    TS_ASSERT_EQUALS(waitpid(other, NULL, 0), other);
+
+    TS_ASSERT_EQUALS(hits.size(), 1);
+    TS_ASSERT_LESS_THAN(150, hits[0].count);
+    TS_ASSERT_EQUALS(progress.getHits(), hits[0].count);
+    TS_ASSERT(hits[0].module.size());
+    TS_ASSERT_EQUALS(hits[0].toString().find(hits[0].module + "+0x"), 0);
+  }
+};